@@ -0,0 +1,154 @@
+/*
+ * 文件：acquisition.cpp
+ * 功能：独立采集线程与测量值无锁发布实现
+ */
+
+#include "acquisition.h"
+#include "scheduler.h"
+#include "trace_replay.h"
+
+// 采集一轮：读取全部台区数据并发布到各自的最新值槽位
+static void Acquisition_SampleAll(AcquisitionThread *acq) {
+    for (size_t i = 0; i < acq->count; i++) {
+        MeasurementChannel *ch = &acq->channels[i];
+        MeasurementSample *sample = &ch->slots[ch->back];
+
+        // 读取实时数据 (需要您实现硬件接口通信，慢速设备只会拖慢本线程)
+        Simulate_RealTimeData(&ch->sim, &sample->status);
+        sample->status.P_soc_charge_limit = 0.0f;
+        sample->status.P_soc_discharge_limit = 0.0f;
+        sample->timestamp_ns = Monotonic_NowNs();
+        sample->seq = ch->next_seq++;
+
+        // 发布：换入中间槽位；换出的旧样本若还未被取走即被覆盖，控制线程停顿后读到的仍是最新样本
+        uint32_t previous = ch->middle.exchange(ch->back | ACQ_SLOT_FRESH, std::memory_order_acq_rel);
+        if (previous & ACQ_SLOT_FRESH) {
+            ch->superseded.fetch_add(1, std::memory_order_relaxed);
+        }
+        ch->back = previous & ~ACQ_SLOT_FRESH;
+    }
+}
+
+static void Acquisition_ThreadMain(AcquisitionThread *acq) {
+    PeriodicScheduler scheduler;
+    if (Scheduler_Init(&scheduler, acq->period_ms) != 0) {
+        return;
+    }
+
+    while (acq->running.load(std::memory_order_acquire)) {
+        Acquisition_SampleAll(acq);
+        if (Scheduler_WaitNextPeriod(&scheduler)) {
+            acq->overruns.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+int Acquisition_Start(AcquisitionThread *acq, size_t count, int period_ms, int stale_threshold_ms,
+                      uint64_t seed, const TraceFile *trace) {
+    if (count == 0 || period_ms < SCHEDULER_MIN_PERIOD_MS) {
+        fprintf(stderr, "错误: 采集线程参数非法 (台区数=%zu, 周期=%dms)\n", count, period_ms);
+        return -1;
+    }
+
+    acq->channels = new MeasurementChannel[count];
+    acq->count = count;
+    acq->period_ms = period_ms;
+    acq->stale_threshold_ns = (int64_t)stale_threshold_ms * 1000000LL;
+    acq->overruns.store(0, std::memory_order_relaxed);
+
+    for (size_t i = 0; i < count; i++) {
+        MeasurementChannel *ch = &acq->channels[i];
+        Simulation_Init(&ch->sim, seed, (uint64_t)i);
+        if (trace && TraceReplay_Attach(&ch->sim, trace, (uint32_t)i) != 0) {
+            delete[] acq->channels;
+            acq->channels = NULL;
+            return -1;
+        }
+        ch->back = 0;
+        ch->middle.store(1, std::memory_order_relaxed);
+        ch->front = 2;
+        ch->superseded.store(0, std::memory_order_relaxed);
+        ch->next_seq = 1;
+        ch->has_sample = 0;
+        ch->consumed = 0;
+        ch->stale_cycles = 0;
+        ch->empty_cycles = 0;
+        ch->last_age_ns = 0;
+        ch->max_age_ns = 0;
+    }
+
+    acq->running.store(1, std::memory_order_release);
+    acq->thread = std::thread(Acquisition_ThreadMain, acq);
+    return 0;
+}
+
+void Acquisition_Stop(AcquisitionThread *acq) {
+    acq->running.store(0, std::memory_order_release);
+    if (acq->thread.joinable()) {
+        acq->thread.join();
+    }
+    delete[] acq->channels;
+    acq->channels = NULL;
+    acq->count = 0;
+}
+
+int Acquisition_ReadLatest(AcquisitionThread *acq, size_t index, SystemStatus_RealTime *status) {
+    MeasurementChannel *ch = &acq->channels[index];
+
+    // 1. 有新发布的样本时把它换到front，否则沿用front中的上一个样本
+    if (ch->middle.load(std::memory_order_relaxed) & ACQ_SLOT_FRESH) {
+        ch->front = ch->middle.exchange(ch->front, std::memory_order_acq_rel) & ~ACQ_SLOT_FRESH;
+        ch->has_sample = 1;
+        ch->consumed++;
+    }
+
+    if (!ch->has_sample) {
+        ch->empty_cycles++;
+        return -1;
+    }
+
+    const MeasurementSample *latest = &ch->slots[ch->front];
+
+    // 2. 计算样本年龄，超过阈值记为过期
+    int64_t age = Monotonic_NowNs() - latest->timestamp_ns;
+    ch->last_age_ns = age;
+    if (age > ch->max_age_ns) {
+        ch->max_age_ns = age;
+    }
+
+    status->V_meas = latest->status.V_meas;
+    status->SOC = latest->status.SOC;
+    status->P_meas = latest->status.P_meas;
+
+    if (age > acq->stale_threshold_ns) {
+        ch->stale_cycles++;
+        return 1;
+    }
+    return 0;
+}
+
+void Acquisition_PrintStats(const AcquisitionThread *acq, FILE *fp) {
+    uint64_t consumed = 0;
+    uint64_t superseded = 0;
+    uint64_t stale = 0;
+    uint64_t empty = 0;
+    int64_t max_age = 0;
+
+    for (size_t i = 0; i < acq->count; i++) {
+        const MeasurementChannel *ch = &acq->channels[i];
+        consumed += ch->consumed;
+        superseded += ch->superseded.load(std::memory_order_relaxed);
+        stale += ch->stale_cycles;
+        empty += ch->empty_cycles;
+        if (ch->max_age_ns > max_age) {
+            max_age = ch->max_age_ns;
+        }
+    }
+
+    fprintf(fp, "采集统计: 台区数=%zu, 采样周期=%dms, 已取样本=%llu, 被覆盖=%llu, "
+                "过期保持指令周期=%llu, 无样本周期=%llu, 最大样本年龄=%.3fms, 采集超时=%llu\n",
+            acq->count, acq->period_ms,
+            (unsigned long long)consumed, (unsigned long long)superseded,
+            (unsigned long long)stale, (unsigned long long)empty, (double)max_age / 1e6,
+            (unsigned long long)acq->overruns.load(std::memory_order_relaxed));
+}
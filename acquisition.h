@@ -0,0 +1,102 @@
+/*
+ * 文件：acquisition.h
+ * 功能：独立采集线程与测量值无锁发布
+ *
+ * 功能描述：
+ * 1. 采集线程按固定周期读取各台区的电表/BMS/PCS数据(当前为模拟数据源)，
+ *    打上单调时钟时间戳后发布到每个台区各自的最新值槽位(三缓冲)
+ * 2. 发布总是覆盖尚未被取走的旧样本，控制线程每个周期取到的都是最新样本，双方都不阻塞
+ * 3. 统计被新样本覆盖、样本过期等计数，采集I/O耗时不会影响控制周期的截止时刻
+ */
+
+#ifndef VOLTAGE_CONTROL_ACQUISITION_H
+#define VOLTAGE_CONTROL_ACQUISITION_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include "voltage_control.h"
+
+#define ACQ_SLOT_FRESH 4u       // 中间缓冲下标中的标志位：已发布、尚未被控制线程取走
+
+/* ---------- 带时间戳的测量样本 ---------- */
+typedef struct {
+    uint64_t seq;                   // 采样序号，从1开始
+    int64_t timestamp_ns;           // 采样时刻 (单调时钟, ns)
+    SystemStatus_RealTime status;   // 测量值 (V_meas、SOC、P_meas)
+} MeasurementSample;
+
+/* ---------- 单个台区的测量通道 ---------- */
+// 三缓冲：采集线程写back槽后与middle交换，控制线程发现middle带ACQ_SLOT_FRESH时与front交换，
+// 三个槽位任一时刻只被一方访问，交换用acq_rel保证样本内容对另一方可见
+struct MeasurementChannel {
+    MeasurementSample slots[3];         // 三个样本槽位
+    std::atomic<uint32_t> middle;       // 中间槽位下标 | ACQ_SLOT_FRESH
+    std::atomic<uint64_t> superseded;   // 未被取走就被更新样本覆盖的样本数 (采集线程写)
+
+    // 以下字段仅由采集线程访问
+    SimulationState sim;                // 本台区数据源状态
+    uint64_t next_seq;                  // 下一个样本序号
+    uint32_t back;                      // 采集线程正在写的槽位
+
+    // 以下字段仅由控制线程访问
+    uint32_t front;                     // 控制线程持有的最新样本槽位
+    int has_sample;                     // 是否已取到过样本
+    uint64_t consumed;                  // 取出的样本总数
+    uint64_t stale_cycles;              // 样本过期、保持上一周期指令的控制周期数
+    uint64_t empty_cycles;              // 控制周期没有任何可用样本的次数
+    int64_t last_age_ns;                // 最近一次使用样本时的样本年龄
+    int64_t max_age_ns;                 // 使用样本时的最大样本年龄
+};
+
+/* ---------- 采集线程 ---------- */
+struct AcquisitionThread {
+    MeasurementChannel *channels;       // 各台区测量通道
+    size_t count;                       // 台区数量
+    int period_ms;                      // 采样周期 (ms)
+    int64_t stale_threshold_ns;         // 样本年龄超过该值即视为过期
+    std::atomic<int> running;           // 采集线程运行标志
+    std::atomic<uint64_t> overruns;     // 采集一轮超过采样周期的次数
+    std::thread thread;
+};
+
+/**
+ * @brief 为count个台区创建测量通道并启动采集线程
+ * @param acq 采集线程
+ * @param count 台区数量
+ * @param period_ms 采样周期 (ms)
+ * @param stale_threshold_ms 样本过期阈值 (ms)
+ * @param seed 模拟数据源随机种子，第i个台区使用流编号i
+ * @param trace 回放的录波轨迹，第i个台区回放第i个通道；为NULL时使用模拟数据
+ * @return int 成功返回0，失败返回-1
+ */
+int Acquisition_Start(AcquisitionThread *acq, size_t count, int period_ms, int stale_threshold_ms,
+                      uint64_t seed, const TraceFile *trace);
+
+/**
+ * @brief 停止采集线程并释放测量通道
+ * @param acq 采集线程
+ */
+void Acquisition_Stop(AcquisitionThread *acq);
+
+/**
+ * @brief 控制线程读取第index个台区的最新测量值(非阻塞)
+ *
+ * 有新发布的样本时取走它，否则沿用上一次的样本。
+ * 返回1时调用者不应以该样本更新PI积分与指令，而是保持上一周期的指令，此类周期计入stale_cycles。
+ * @param acq 采集线程
+ * @param index 台区下标
+ * @param status [输出] 最新测量值 (只写V_meas、SOC、P_meas)
+ * @return int 样本新鲜返回0，样本已过期返回1，尚无任何样本返回-1
+ */
+int Acquisition_ReadLatest(AcquisitionThread *acq, size_t index, SystemStatus_RealTime *status);
+
+/**
+ * @brief 输出采集统计信息(汇总全部台区)
+ * @param acq 采集线程
+ * @param fp 输出流
+ */
+void Acquisition_PrintStats(const AcquisitionThread *acq, FILE *fp);
+
+#endif // VOLTAGE_CONTROL_ACQUISITION_H
@@ -0,0 +1,98 @@
+/*
+ * 文件：battery_model.cpp
+ * 功能：储能电池与PCS物理模型实现
+ */
+
+#include "battery_model.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#define BATTERY_ALIGN 64                                // 数组起始地址对齐(字节)
+#define BATTERY_LANES (BATTERY_ALIGN / sizeof(float))   // 每个数组长度向上取整到的倍数
+#define BATTERY_ARRAY_COUNT 5                           // 每个台区占用的float数组个数(另有一个double的SOC数组)
+
+void BatteryParams_Default(BatteryParams *params) {
+    params->capacity_kwh = BATTERY_DEFAULT_CAPACITY_KWH;
+    params->charge_efficiency = BATTERY_DEFAULT_EFFICIENCY;
+    params->discharge_efficiency = BATTERY_DEFAULT_EFFICIENCY;
+    params->ramp_kw_per_s = BATTERY_DEFAULT_RAMP_KW_PER_S;
+    params->self_discharge_per_day = BATTERY_DEFAULT_SELF_DISCHARGE_PER_DAY;
+}
+
+int BatteryModel_Init(BatteryModel *model, const BatteryParams *params) {
+    if (!(params->capacity_kwh > 0.0f)
+        || !(params->charge_efficiency > 0.0f && params->charge_efficiency <= 1.0f)
+        || !(params->discharge_efficiency > 0.0f && params->discharge_efficiency <= 1.0f)
+        || !(params->ramp_kw_per_s > 0.0f)
+        || !(params->self_discharge_per_day >= 0.0f && params->self_discharge_per_day < 1.0f)) {
+        fprintf(stderr, "错误: 电池参数非法 (容量=%gkWh, 效率=%g/%g, 爬坡率=%gkW/s, 自放电率=%g/天)\n",
+                params->capacity_kwh, params->charge_efficiency, params->discharge_efficiency,
+                params->ramp_kw_per_s, params->self_discharge_per_day);
+        return -1;
+    }
+    model->charge_gain = params->charge_efficiency / (3600.0f * params->capacity_kwh);
+    model->discharge_gain = 1.0f / (params->discharge_efficiency * 3600.0f * params->capacity_kwh);
+    model->ramp_kw_per_s = params->ramp_kw_per_s;
+    model->self_discharge_per_s = params->self_discharge_per_day / 86400.0f;
+    return 0;
+}
+
+int BatteryBank_Init(BatteryBank *bank, size_t count) {
+    memset(bank, 0, sizeof(*bank));
+    if (count == 0) {
+        fprintf(stderr, "错误: 台区数量必须大于0\n");
+        return -1;
+    }
+
+    size_t stride = (count + BATTERY_LANES - 1) / BATTERY_LANES * BATTERY_LANES;
+    void *block = calloc(1, stride * (sizeof(double) + sizeof(float) * BATTERY_ARRAY_COUNT) + BATTERY_ALIGN);
+    if (!block) {
+        fprintf(stderr, "错误: 内存分配失败\n");
+        return -1;
+    }
+
+    uintptr_t base = ((uintptr_t)block + BATTERY_ALIGN - 1) & ~(uintptr_t)(BATTERY_ALIGN - 1);
+    bank->soc = (double *)base;         // stride为16的倍数，其后的float数组仍按BATTERY_ALIGN对齐
+    float *p = (float *)(bank->soc + stride);
+    bank->P_actual = p;                 p += stride;
+    bank->charge_gain = p;              p += stride;
+    bank->discharge_gain = p;           p += stride;
+    bank->ramp_kw_per_s = p;            p += stride;
+    bank->self_discharge_per_s = p;
+    bank->count = count;
+    bank->block = block;
+    return 0;
+}
+
+void BatteryBank_Free(BatteryBank *bank) {
+    free(bank->block);
+    memset(bank, 0, sizeof(*bank));
+}
+
+void BatteryBank_Set(BatteryBank *bank, size_t index, const BatteryModel *model, double soc, float P_actual) {
+    bank->soc[index] = soc;
+    bank->P_actual[index] = P_actual;
+    bank->charge_gain[index] = model->charge_gain;
+    bank->discharge_gain[index] = model->discharge_gain;
+    bank->ramp_kw_per_s[index] = model->ramp_kw_per_s;
+    bank->self_discharge_per_s[index] = model->self_discharge_per_s;
+}
+
+// 批量内核：Battery_Step全部写成三目选择，内联后整个循环可向量化
+static void BatteryBank_Kernel(size_t n, float dt_s, const float *__restrict P_cmd,
+                               double *__restrict soc, float *__restrict P_actual,
+                               const float *__restrict charge_gain, const float *__restrict discharge_gain,
+                               const float *__restrict ramp, const float *__restrict self_discharge) {
+    for (size_t i = 0; i < n; i++) {
+        Battery_Step(charge_gain[i], discharge_gain[i], ramp[i], self_discharge[i], P_cmd[i], dt_s,
+                     &soc[i], &P_actual[i]);
+    }
+}
+
+void BatteryBank_Step(BatteryBank *bank, const float *P_cmd, float dt_s) {
+    BatteryBank_Kernel(bank->count, dt_s, P_cmd, bank->soc, bank->P_actual, bank->charge_gain,
+                       bank->discharge_gain, bank->ramp_kw_per_s, bank->self_discharge_per_s);
+}
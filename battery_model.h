@@ -0,0 +1,147 @@
+/*
+ * 文件：battery_model.h
+ * 功能：储能电池与PCS的物理模型，用于仿真中闭合SOC回路
+ *
+ * 功能描述：
+ * 1. PCS实际功率按爬坡率上限跟踪有功功率指令
+ * 2. SOC按实际功率积分：充电乘充电效率，放电除以放电效率，并扣除按SOC比例的自放电；
+ *    SOC状态与积分用双精度，1s步长下每步的自放电量(约1e-8)远小于单精度SOC的分辨率，用float会被舍入掉
+ * 3. SOC到达0或1时实际功率被截断为剩余可充/可放的功率，SOC不会越界
+ * 4. 提供单台区版本与结构数组(SoA)批量版本，两者运算完全相同，批量版本便于编译器向量化
+ */
+
+#ifndef VOLTAGE_CONTROL_BATTERY_MODEL_H
+#define VOLTAGE_CONTROL_BATTERY_MODEL_H
+
+#include <cstddef>
+
+#define BATTERY_DEFAULT_CAPACITY_KWH 200.0f         // 默认可用容量 (kWh)
+#define BATTERY_DEFAULT_EFFICIENCY 0.95f            // 默认充电/放电效率
+#define BATTERY_DEFAULT_RAMP_KW_PER_S 25.0f         // 默认PCS爬坡率上限 (kW/s)
+#define BATTERY_DEFAULT_SELF_DISCHARGE_PER_DAY 0.001f // 默认自放电率 (每天损失当前SOC的比例)
+
+/* ---------- 电池与PCS参数 ---------- */
+typedef struct {
+    float capacity_kwh;             // 可用容量 (kWh)
+    float charge_efficiency;        // 充电效率 (0~1]
+    float discharge_efficiency;     // 放电效率 (0~1]
+    float ramp_kw_per_s;            // PCS功率爬坡率上限 (kW/s)
+    float self_discharge_per_day;   // 自放电率 (每天损失当前SOC的比例)
+} BatteryParams;
+
+/* ---------- 由参数预先换算出的模型系数 ---------- */
+typedef struct {
+    float charge_gain;              // 充电时每kW·s的SOC增量 = 充电效率 / (3600 * 容量)
+    float discharge_gain;           // 放电时每kW·s的SOC减量 = 1 / (放电效率 * 3600 * 容量)
+    float ramp_kw_per_s;            // PCS功率爬坡率上限 (kW/s)
+    float self_discharge_per_s;     // 每秒自放电比例
+} BatteryModel;
+
+/**
+ * @brief 默认电池参数
+ * @param params [输出] 电池参数
+ */
+void BatteryParams_Default(BatteryParams *params);
+
+/**
+ * @brief 检查参数并换算为模型系数
+ * @param model [输出] 模型系数
+ * @param params 电池参数
+ * @return int 成功返回0，参数非法返回-1
+ */
+int BatteryModel_Init(BatteryModel *model, const BatteryParams *params);
+
+/**
+ * @brief 推进一步：实际功率跟踪指令并积分SOC
+ *
+ * 批量版本逐元素执行与本函数完全相同的运算。
+ * @param charge_gain 见BatteryModel
+ * @param discharge_gain 见BatteryModel
+ * @param ramp_kw_per_s 见BatteryModel
+ * @param self_discharge_per_s 见BatteryModel
+ * @param P_cmd 有功功率指令 (kW)，正为充电
+ * @param dt_s 步长 (s)
+ * @param soc [输入/输出] SOC(双精度)
+ * @param P_actual [输入/输出] PCS实际功率 (kW)
+ */
+inline void Battery_Step(float charge_gain, float discharge_gain, float ramp_kw_per_s, float self_discharge_per_s,
+                         float P_cmd, float dt_s, double *soc, float *P_actual) {
+    // 爬坡限制
+    float max_delta = ramp_kw_per_s * dt_s;
+    float delta = P_cmd - *P_actual;
+    delta = delta > max_delta ? max_delta : delta;
+    delta = delta < -max_delta ? -max_delta : delta;
+    float P = *P_actual + delta;
+
+    // 自放电后，按剩余可充/可放电量截断功率
+    double s = *soc - *soc * ((double)self_discharge_per_s * dt_s);
+    float P_charge_room = (float)((1.0 - s) / ((double)charge_gain * dt_s));
+    float P_discharge_room = (float)(s / ((double)discharge_gain * dt_s));
+    P = P > P_charge_room ? P_charge_room : P;
+    P = P < -P_discharge_room ? -P_discharge_room : P;
+
+    s += (double)P * (P > 0.0f ? charge_gain : discharge_gain) * dt_s;
+    s = s > 1.0 ? 1.0 : s;
+    s = s < 0.0 ? 0.0 : s;
+    *soc = s;
+    *P_actual = P;
+}
+
+/**
+ * @brief 以模型系数推进一步(单台区)
+ * @param model 模型系数
+ * @param P_cmd 有功功率指令 (kW)
+ * @param dt_s 步长 (s)
+ * @param soc [输入/输出] SOC(双精度)
+ * @param P_actual [输入/输出] PCS实际功率 (kW)
+ */
+inline void BatteryModel_Step(const BatteryModel *model, float P_cmd, float dt_s, double *soc, float *P_actual) {
+    Battery_Step(model->charge_gain, model->discharge_gain, model->ramp_kw_per_s, model->self_discharge_per_s,
+                 P_cmd, dt_s, soc, P_actual);
+}
+
+/* ---------- 批量电池模型(结构数组) ---------- */
+typedef struct {
+    size_t count;                   // 台区数量
+    double *soc;                    // SOC(双精度，见Battery_Step)
+    float *P_actual;                // PCS实际功率 (kW)
+    float *charge_gain;             // 各台区模型系数，见BatteryModel
+    float *discharge_gain;
+    float *ramp_kw_per_s;
+    float *self_discharge_per_s;
+    void *block;                    // 所有数组共用的一次性内存分配
+} BatteryBank;
+
+/**
+ * @brief 为count个台区分配批量电池模型，SOC与实际功率清零
+ * @param bank 批量电池模型
+ * @param count 台区数量
+ * @return int 成功返回0，失败返回-1
+ */
+int BatteryBank_Init(BatteryBank *bank, size_t count);
+
+/**
+ * @brief 释放批量电池模型
+ * @param bank 批量电池模型
+ */
+void BatteryBank_Free(BatteryBank *bank);
+
+/**
+ * @brief 设置第index个台区的模型系数与初始状态
+ * @param bank 批量电池模型
+ * @param index 台区下标
+ * @param model 模型系数
+ * @param soc 初始SOC
+ * @param P_actual 初始实际功率 (kW)
+ */
+void BatteryBank_Set(BatteryBank *bank, size_t index, const BatteryModel *model, double soc, float P_actual);
+
+/**
+ * @brief 对全部台区推进一步
+ * @param bank 批量电池模型
+ * @param P_cmd 各台区有功功率指令 (kW)
+ * @param dt_s 步长 (s)
+ */
+void BatteryBank_Step(BatteryBank *bank, const float *P_cmd, float dt_s);
+
+#endif // VOLTAGE_CONTROL_BATTERY_MODEL_H
@@ -0,0 +1,488 @@
+/*
+ * 文件：bench.cpp
+ * 功能：控制器核心函数微基准测试 (voltage_control_bench)
+ *
+ * 功能描述：
+ * 1. 测试Determine_CtrlMode、过压/欠压PI计算、SOC功率限值、配置加载、
+ *    单台区完整控制计算、逐台区主控制循环与批量引擎一个周期的耗时
+ * 2. 输入按典型分布预先生成(正常、过压、欠压、SOC接近上下限)，
+ *    使用固定种子，不同版本之间的结果可直接对比
+ * 3. 每项自动标定迭代次数后重复测量多次，结果以JSON输出，人读表格输出到stderr
+ * 4. 启动时先做SOC降额精度自检，SIMD内核或插值表误差超出上限时不计时、直接返回失败
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include "scheduler.h"
+#include "control_loop.h"
+
+#define BENCH_INPUT_COUNT 1024          // 每种分布预生成的输入个数(2的幂)
+#define BENCH_SEED 0x5eed2025ULL        // 输入生成种子
+#define BENCH_MAX_REPETITIONS 64
+
+/* ---------- 输入分布 ---------- */
+typedef enum {
+    BENCH_DIST_NORMAL = 0,          // 电压在死区内，SOC在过渡区之外
+    BENCH_DIST_OVER_VOLTAGE,        // 电压高于上限死区
+    BENCH_DIST_UNDER_VOLTAGE,       // 电压低于下限死区且高于进入门槛
+    BENCH_DIST_SOC_NEAR_LIMITS,     // SOC位于上下限过渡区内，电压三种状态混合
+    BENCH_DIST_COUNT
+} BenchDistribution;
+
+static const char *BENCH_DIST_NAMES[BENCH_DIST_COUNT] = {
+    "normal", "over_voltage", "under_voltage", "soc_near_limits"
+};
+
+/* ---------- 测试上下文 ---------- */
+typedef struct {
+    SystemConfig_Cfg cfg;
+    SOC_DeratingCurve curve;
+    CompiledConfig compiled;        // 由cfg与curve编译，被测函数只读取此形式
+    const char *config_file;
+    SystemStatus_RealTime inputs[BENCH_DIST_COUNT][BENCH_INPUT_COUNT]; // 已含SOC功率限值
+    int dist;                       // 当前测试项使用的分布
+    size_t areas;                   // 当前测试项的台区数量
+    VoltageController *ctrls;       // 逐台区测试用控制器
+    VoltageFleet fleet;             // 批量引擎测试用
+    int fleet_ready;
+    double derating_simd_error;     // 精度自检：SIMD内核相对双精度余弦的最大绝对误差
+    double derating_table_error;    // 精度自检：余弦插值表的最大绝对误差
+} BenchContext;
+
+typedef void (*BenchFn)(BenchContext *ctx, uint64_t iterations);
+
+/* ---------- 测试项 ---------- */
+typedef struct {
+    const char *name;
+    BenchFn fn;
+    int dist;                       // 使用的分布，-1表示不适用
+    size_t areas;                   // 每次操作处理的台区数
+} BenchCase;
+
+/* ---------- 测试结果 ---------- */
+typedef struct {
+    uint64_t iterations;
+    int repetitions;
+    double ns_per_op[BENCH_MAX_REPETITIONS];
+    double median;
+    double min;
+    double max;
+} BenchResult;
+
+// 结果写入该变量，防止编译器把被测计算当作无用代码删除
+static volatile float g_bench_sink;
+
+static uint64_t Bench_NextRandom(uint64_t *state) {
+    // splitmix64
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static float Bench_Uniform(uint64_t *state, float lo, float hi) {
+    float u = (float)(Bench_NextRandom(state) >> 40) / (float)(1ULL << 24);
+    return lo + (hi - lo) * u;
+}
+
+// 按分布生成测量值，并预先算好SOC功率限值
+static void Bench_GenerateInputs(BenchContext *ctx) {
+    const SystemConfig_Cfg *cfg = &ctx->cfg;
+    float upper_edge = cfg->V_ref_upper + cfg->Deadband_upper;
+    float lower_edge = cfg->V_ref_lower - cfg->Deadband_lower;
+    float charge_width = ctx->curve.charge_width;
+    float discharge_width = ctx->curve.discharge_width;
+    uint64_t rng = BENCH_SEED;
+
+    for (int d = 0; d < BENCH_DIST_COUNT; d++) {
+        for (int i = 0; i < BENCH_INPUT_COUNT; i++) {
+            SystemStatus_RealTime *s = &ctx->inputs[d][i];
+            float soc_mid = Bench_Uniform(&rng, cfg->SOC_min + discharge_width, cfg->SOC_max - charge_width);
+
+            switch (d) {
+                case BENCH_DIST_NORMAL:
+                    s->V_meas = Bench_Uniform(&rng, lower_edge, upper_edge);
+                    s->SOC = soc_mid;
+                    break;
+                case BENCH_DIST_OVER_VOLTAGE:
+                    s->V_meas = Bench_Uniform(&rng, upper_edge, upper_edge + 20.0f);
+                    s->SOC = soc_mid;
+                    break;
+                case BENCH_DIST_UNDER_VOLTAGE:
+                    s->V_meas = Bench_Uniform(&rng, cfg->V_enter_lower, lower_edge);
+                    s->SOC = soc_mid;
+                    break;
+                default:
+                    s->V_meas = Bench_Uniform(&rng, cfg->V_enter_lower, upper_edge + 20.0f);
+                    s->SOC = (i & 1) ? Bench_Uniform(&rng, cfg->SOC_max - charge_width, cfg->SOC_max)
+                                     : Bench_Uniform(&rng, cfg->SOC_min, cfg->SOC_min + discharge_width);
+                    break;
+            }
+            s->P_meas = Bench_Uniform(&rng, -cfg->P_discharge_max, cfg->P_charge_max) * 0.5f;
+            Calculate_SOC_Power_Limits(s->SOC, &ctx->compiled, &ctx->curve, &s->P_soc_charge_limit,
+                                       &s->P_soc_discharge_limit);
+        }
+    }
+}
+
+/* ---------- 被测函数 ---------- */
+
+static void Bench_DetermineCtrlMode(BenchContext *ctx, uint64_t iterations) {
+    const SystemStatus_RealTime *in = ctx->inputs[ctx->dist];
+    int acc = 0;
+    for (uint64_t i = 0; i < iterations; i++) {
+        acc += Determine_CtrlMode(in[i & (BENCH_INPUT_COUNT - 1)].V_meas, &ctx->compiled);
+    }
+    g_bench_sink = (float)acc;
+}
+
+static void Bench_OverVoltagePI(BenchContext *ctx, uint64_t iterations) {
+    const SystemStatus_RealTime *in = ctx->inputs[ctx->dist];
+    ControllerState state = {1, 0.0f, 0.0f};
+    float acc = 0.0f;
+    for (uint64_t i = 0; i < iterations; i++) {
+        size_t k = i & (BENCH_INPUT_COUNT - 1);
+        if (k == 0) {
+            state.integral_upper = 0.0f; // 每轮输入重新开始积分，避免积分项无限增长
+        }
+        acc += Calculate_OverVoltage_Control(&ctx->compiled, &in[k], &state);
+    }
+    g_bench_sink = acc;
+}
+
+static void Bench_UnderVoltagePI(BenchContext *ctx, uint64_t iterations) {
+    const SystemStatus_RealTime *in = ctx->inputs[ctx->dist];
+    ControllerState state = {2, 0.0f, 0.0f};
+    float acc = 0.0f;
+    for (uint64_t i = 0; i < iterations; i++) {
+        size_t k = i & (BENCH_INPUT_COUNT - 1);
+        if (k == 0) {
+            state.integral_lower = 0.0f;
+        }
+        acc += Calculate_UnderVoltage_Control(&ctx->compiled, &in[k], &state);
+    }
+    g_bench_sink = acc;
+}
+
+static void Bench_SOCPowerLimits(BenchContext *ctx, uint64_t iterations) {
+    const SystemStatus_RealTime *in = ctx->inputs[ctx->dist];
+    float acc = 0.0f;
+    for (uint64_t i = 0; i < iterations; i++) {
+        float charge_limit;
+        float discharge_limit;
+        Calculate_SOC_Power_Limits(in[i & (BENCH_INPUT_COUNT - 1)].SOC, &ctx->compiled, &ctx->curve,
+                                   &charge_limit, &discharge_limit);
+        acc += charge_limit - discharge_limit;
+    }
+    g_bench_sink = acc;
+}
+
+static void Bench_ControllerCompute(BenchContext *ctx, uint64_t iterations) {
+    const SystemStatus_RealTime *in = ctx->inputs[ctx->dist];
+    VoltageController *ctrl = &ctx->ctrls[0];
+    float acc = 0.0f;
+    for (uint64_t i = 0; i < iterations; i++) {
+        size_t k = i & (BENCH_INPUT_COUNT - 1);
+        if (k == 0) {
+            ctrl->state.integral_upper = 0.0f;
+            ctrl->state.integral_lower = 0.0f;
+        }
+        ctrl->status = in[k];
+        acc += VoltageController_Compute(ctrl);
+    }
+    g_bench_sink = acc;
+}
+
+static void Bench_LoadConfiguration(BenchContext *ctx, uint64_t iterations) {
+    SystemConfig_Cfg cfg;
+    SOC_DeratingCurve curve;
+    float acc = 0.0f;
+    for (uint64_t i = 0; i < iterations; i++) {
+        if (load_configuration(ctx->config_file, &cfg, &curve) == 0) {
+            acc += cfg.V_ref_upper;
+        }
+    }
+    g_bench_sink = acc;
+}
+
+static void Bench_MainLoopStep(BenchContext *ctx, uint64_t iterations) {
+    for (uint64_t i = 0; i < iterations; i++) {
+        Main_VoltageControlLoop(ctx->ctrls, ctx->areas, NULL, NULL, (uint32_t)i, NULL);
+    }
+    g_bench_sink = ctx->ctrls[0].P_cmd;
+}
+
+static void Bench_FleetStep(BenchContext *ctx, uint64_t iterations) {
+    for (uint64_t i = 0; i < iterations; i++) {
+        VoltageFleet_Step(&ctx->fleet);
+    }
+    g_bench_sink = ctx->fleet.P_cmd[0];
+}
+
+static const BenchCase BENCH_CASES[] = {
+    {"determine_ctrl_mode", Bench_DetermineCtrlMode, BENCH_DIST_NORMAL, 1},
+    {"determine_ctrl_mode", Bench_DetermineCtrlMode, BENCH_DIST_OVER_VOLTAGE, 1},
+    {"determine_ctrl_mode", Bench_DetermineCtrlMode, BENCH_DIST_UNDER_VOLTAGE, 1},
+    {"determine_ctrl_mode", Bench_DetermineCtrlMode, BENCH_DIST_SOC_NEAR_LIMITS, 1},
+    {"over_voltage_pi", Bench_OverVoltagePI, BENCH_DIST_OVER_VOLTAGE, 1},
+    {"over_voltage_pi", Bench_OverVoltagePI, BENCH_DIST_SOC_NEAR_LIMITS, 1},
+    {"under_voltage_pi", Bench_UnderVoltagePI, BENCH_DIST_UNDER_VOLTAGE, 1},
+    {"under_voltage_pi", Bench_UnderVoltagePI, BENCH_DIST_SOC_NEAR_LIMITS, 1},
+    {"soc_power_limits", Bench_SOCPowerLimits, BENCH_DIST_NORMAL, 1},
+    {"soc_power_limits", Bench_SOCPowerLimits, BENCH_DIST_SOC_NEAR_LIMITS, 1},
+    {"controller_compute", Bench_ControllerCompute, BENCH_DIST_NORMAL, 1},
+    {"controller_compute", Bench_ControllerCompute, BENCH_DIST_OVER_VOLTAGE, 1},
+    {"controller_compute", Bench_ControllerCompute, BENCH_DIST_UNDER_VOLTAGE, 1},
+    {"controller_compute", Bench_ControllerCompute, BENCH_DIST_SOC_NEAR_LIMITS, 1},
+    {"load_configuration", Bench_LoadConfiguration, -1, 1},
+    {"main_loop_step", Bench_MainLoopStep, -1, 1},
+    {"main_loop_step", Bench_MainLoopStep, -1, 64},
+    {"main_loop_step", Bench_MainLoopStep, -1, 1024},
+    {"fleet_step", Bench_FleetStep, BENCH_DIST_SOC_NEAR_LIMITS, 64},
+    {"fleet_step", Bench_FleetStep, BENCH_DIST_SOC_NEAR_LIMITS, 1024},
+};
+
+#define BENCH_CASE_COUNT (sizeof(BENCH_CASES) / sizeof(BENCH_CASES[0]))
+
+// 为测试项准备控制器或批量引擎
+static int Bench_Prepare(BenchContext *ctx, const BenchCase *bc) {
+    ctx->dist = bc->dist;
+    ctx->areas = bc->areas;
+
+    ctx->ctrls = (VoltageController *)calloc(bc->areas, sizeof(VoltageController));
+    if (!ctx->ctrls) {
+        fprintf(stderr, "错误: 内存分配失败\n");
+        return -1;
+    }
+    for (size_t i = 0; i < bc->areas; i++) {
+        VoltageController_Init(&ctx->ctrls[i], (int)i, &ctx->compiled, &ctx->curve);
+    }
+
+    ctx->fleet_ready = 0;
+    if (bc->fn == Bench_FleetStep) {
+        if (VoltageFleet_Init(&ctx->fleet, bc->areas) != 0) {
+            free(ctx->ctrls);
+            return -1;
+        }
+        VoltageFleet_SetCurve(&ctx->fleet, &ctx->curve);
+        for (size_t i = 0; i < bc->areas; i++) {
+            VoltageFleet_SetConfig(&ctx->fleet, i, &ctx->compiled);
+            VoltageFleet_SetMeasurement(&ctx->fleet, i, &ctx->inputs[bc->dist][i & (BENCH_INPUT_COUNT - 1)]);
+        }
+        ctx->fleet_ready = 1;
+    }
+    return 0;
+}
+
+static void Bench_Release(BenchContext *ctx) {
+    free(ctx->ctrls);
+    ctx->ctrls = NULL;
+    if (ctx->fleet_ready) {
+        VoltageFleet_Free(&ctx->fleet);
+        ctx->fleet_ready = 0;
+    }
+}
+
+static int Compare_Double(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// 标定迭代次数使单次测量不短于min_time_ns，然后重复测量
+static void Bench_Run(BenchContext *ctx, const BenchCase *bc, int repetitions, int64_t min_time_ns,
+                      BenchResult *result) {
+    uint64_t iterations = 1;
+    for (;;) {
+        int64_t t0 = Monotonic_NowNs();
+        bc->fn(ctx, iterations);
+        int64_t elapsed = Monotonic_NowNs() - t0;
+        if (elapsed >= min_time_ns) {
+            break;
+        }
+        double scale = elapsed > 0 ? 1.2 * (double)min_time_ns / (double)elapsed : 10.0;
+        if (scale < 2.0) scale = 2.0;
+        if (scale > 10.0) scale = 10.0;
+        iterations = (uint64_t)((double)iterations * scale);
+    }
+
+    double sorted[BENCH_MAX_REPETITIONS];
+    result->iterations = iterations;
+    result->repetitions = repetitions;
+    for (int r = 0; r < repetitions; r++) {
+        int64_t t0 = Monotonic_NowNs();
+        bc->fn(ctx, iterations);
+        int64_t elapsed = Monotonic_NowNs() - t0;
+        result->ns_per_op[r] = (double)elapsed / (double)iterations;
+        sorted[r] = result->ns_per_op[r];
+    }
+    qsort(sorted, (size_t)repetitions, sizeof(double), Compare_Double);
+    result->min = sorted[0];
+    result->max = sorted[repetitions - 1];
+    result->median = (repetitions & 1) ? sorted[repetitions / 2]
+                                       : 0.5 * (sorted[repetitions / 2 - 1] + sorted[repetitions / 2]);
+}
+
+static void Bench_WriteContextJson(FILE *fp, const BenchContext *ctx, int repetitions, int min_time_ms) {
+    char timestamp[32];
+    time_t now = time(NULL);
+    strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+
+#if defined(__clang__)
+    const char *compiler = "clang " __clang_version__;
+#elif defined(__GNUC__)
+    const char *compiler = "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+    const char *compiler = "msvc";
+#else
+    const char *compiler = "unknown";
+#endif
+#ifdef NDEBUG
+    const char *build = "release";
+#else
+    const char *build = "debug";
+#endif
+
+    fprintf(fp, "  \"context\": {\n");
+    fprintf(fp, "    \"timestamp\": \"%s\",\n", timestamp);
+    fprintf(fp, "    \"compiler\": \"%s\",\n", compiler);
+    fprintf(fp, "    \"build\": \"%s\",\n", build);
+    fprintf(fp, "    \"soc_kernel_isa\": \"%s\",\n", SOC_DeratingFactors_Isa());
+    fprintf(fp, "    \"soc_derating_simd_max_error\": %.3g,\n", ctx->derating_simd_error);
+    fprintf(fp, "    \"soc_derating_table_max_error\": %.3g,\n", ctx->derating_table_error);
+    fprintf(fp, "    \"config_file\": \"%s\",\n", ctx->config_file);
+    fprintf(fp, "    \"input_count\": %d,\n", BENCH_INPUT_COUNT);
+    fprintf(fp, "    \"seed\": %llu,\n", (unsigned long long)BENCH_SEED);
+    fprintf(fp, "    \"repetitions\": %d,\n", repetitions);
+    fprintf(fp, "    \"min_time_ms\": %d\n", min_time_ms);
+    fprintf(fp, "  },\n");
+}
+
+static void Print_Usage(const char *prog) {
+    fprintf(stderr, "用法: %s [-c 配置文件] [-o 结果文件] [-r 重复次数] [-m 单次最短时间ms] [-f 名称过滤]\n", prog);
+    fprintf(stderr, "  -c, --config       配置文件路径，默认config.json\n");
+    fprintf(stderr, "  -o, --output       JSON结果文件，默认输出到stdout\n");
+    fprintf(stderr, "  -r, --repetitions  每项重复测量次数，默认5，最大%d\n", BENCH_MAX_REPETITIONS);
+    fprintf(stderr, "  -m, --min-time-ms  每次测量的最短时间(ms)，默认50\n");
+    fprintf(stderr, "  -f, --filter       只运行名称包含该字符串的测试项\n");
+}
+
+int main(int argc, char *argv[])
+{
+    const char *output_file = NULL;
+    const char *filter = NULL;
+    int repetitions = 5;
+    int min_time_ms = 50;
+    BenchContext *ctx = (BenchContext *)calloc(1, sizeof(BenchContext));
+    if (!ctx) {
+        fprintf(stderr, "错误: 内存分配失败\n");
+        return EXIT_FAILURE;
+    }
+    ctx->config_file = "config.json";
+
+    for (int i = 1; i < argc; i++) {
+        if ((strcmp(argv[i], "-c") == 0 || strcmp(argv[i], "--config") == 0) && i + 1 < argc) {
+            ctx->config_file = argv[++i];
+        } else if ((strcmp(argv[i], "-o") == 0 || strcmp(argv[i], "--output") == 0) && i + 1 < argc) {
+            output_file = argv[++i];
+        } else if ((strcmp(argv[i], "-r") == 0 || strcmp(argv[i], "--repetitions") == 0) && i + 1 < argc) {
+            repetitions = atoi(argv[++i]);
+        } else if ((strcmp(argv[i], "-m") == 0 || strcmp(argv[i], "--min-time-ms") == 0) && i + 1 < argc) {
+            min_time_ms = atoi(argv[++i]);
+        } else if ((strcmp(argv[i], "-f") == 0 || strcmp(argv[i], "--filter") == 0) && i + 1 < argc) {
+            filter = argv[++i];
+        } else {
+            Print_Usage(argv[0]);
+            free(ctx);
+            return EXIT_FAILURE;
+        }
+    }
+    if (repetitions < 1 || repetitions > BENCH_MAX_REPETITIONS || min_time_ms < 1) {
+        fprintf(stderr, "错误: 重复次数须在1~%d之间，最短时间须大于0\n", BENCH_MAX_REPETITIONS);
+        free(ctx);
+        return EXIT_FAILURE;
+    }
+
+    if (load_configuration(ctx->config_file, &ctx->cfg, &ctx->curve) != 0) {
+        fprintf(stderr, "基准测试启动失败：配置文件错误。\n");
+        free(ctx);
+        return EXIT_FAILURE;
+    }
+    CompiledConfig_Build(&ctx->compiled, &ctx->cfg, &ctx->curve);
+
+    // 被测的降额计算先核对精度：误差超限时耗时数据没有意义
+    int accurate = SOC_Derating_SelfCheck(ctx->cfg.SOC_max, ctx->cfg.SOC_min, ctx->curve.charge_width,
+                                          ctx->curve.discharge_width, &ctx->derating_simd_error,
+                                          &ctx->derating_table_error) == 0;
+    fprintf(stderr, "SOC降额精度自检(%s): SIMD内核最大误差=%.3g(上限%.3g), 插值表最大误差=%.3g(上限%.3g)%s\n",
+            SOC_DeratingFactors_Isa(), ctx->derating_simd_error, (double)SOC_DERATING_MAX_ERROR,
+            ctx->derating_table_error, (double)SOC_CURVE_TABLE_MAX_ERROR, accurate ? "" : ", 超出上限");
+    if (!accurate) {
+        fprintf(stderr, "错误: SOC降额计算精度超出上限\n");
+        free(ctx);
+        return EXIT_FAILURE;
+    }
+    Bench_GenerateInputs(ctx);
+
+    FILE *out = stdout;
+    if (output_file) {
+        out = fopen(output_file, "w");
+        if (!out) {
+            fprintf(stderr, "错误: 无法创建结果文件 %s\n", output_file);
+            free(ctx);
+            return EXIT_FAILURE;
+        }
+    }
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"schema_version\": 1,\n");
+    Bench_WriteContextJson(out, ctx, repetitions, min_time_ms);
+    fprintf(out, "  \"benchmarks\": [");
+
+    fprintf(stderr, "%-22s %-16s %6s %12s %12s %12s %12s\n",
+            "测试项", "分布", "台区", "中位ns/op", "最小ns/op", "最大ns/op", "ns/台区");
+    int first = 1;
+    int failed = 0;
+    for (size_t c = 0; c < BENCH_CASE_COUNT; c++) {
+        const BenchCase *bc = &BENCH_CASES[c];
+        const char *dist_name = bc->dist >= 0 ? BENCH_DIST_NAMES[bc->dist]
+                              : (bc->fn == Bench_LoadConfiguration ? "config_file" : "simulated");
+        if (filter && !strstr(bc->name, filter)) {
+            continue;
+        }
+        if (Bench_Prepare(ctx, bc) != 0) {
+            failed = 1;
+            break;
+        }
+
+        BenchResult result;
+        Bench_Run(ctx, bc, repetitions, (int64_t)min_time_ms * 1000000LL, &result);
+        Bench_Release(ctx);
+
+        double per_area = result.median / (double)bc->areas;
+        fprintf(stderr, "%-22s %-16s %6zu %12.2f %12.2f %12.2f %12.2f\n",
+                bc->name, dist_name, bc->areas, result.median, result.min, result.max, per_area);
+
+        fprintf(out, "%s\n    {\"name\": \"%s\", \"distribution\": \"%s\", \"areas\": %zu, "
+                     "\"iterations\": %llu, \"repetitions\": %d, "
+                     "\"ns_per_op_median\": %.3f, \"ns_per_op_min\": %.3f, \"ns_per_op_max\": %.3f, "
+                     "\"ns_per_area_median\": %.3f, \"samples\": [",
+                first ? "" : ",", bc->name, dist_name, bc->areas,
+                (unsigned long long)result.iterations, result.repetitions,
+                result.median, result.min, result.max, per_area);
+        for (int r = 0; r < result.repetitions; r++) {
+            fprintf(out, "%s%.3f", r ? ", " : "", result.ns_per_op[r]);
+        }
+        fprintf(out, "]}");
+        first = 0;
+    }
+    fprintf(out, "\n  ]\n}\n");
+
+    if (out != stdout) {
+        fclose(out);
+    }
+    free(ctx);
+    return failed ? EXIT_FAILURE : 0;
+}
@@ -0,0 +1,499 @@
+/*
+ * 文件：config_binder.cpp
+ * 功能：配置文件JSON单遍绑定实现
+ */
+
+#include "config_binder.h"
+#include "config_schema.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#define CONFIG_KEY_MAX 64               // 键名最大长度，超过的键不可能在字段表中，按未知键跳过
+#define CONFIG_SHAPE_MAX 32             // derating_shape字符串最大长度
+#define CURVE_FIELD_COUNT 4             // 降额曲线字段数
+
+/* ---------- 绑定目标：配置参数与降额曲线参数 ---------- */
+typedef struct {
+    SystemConfig_Cfg cfg;
+    float charge_width;
+    float discharge_width;
+    char shape[CONFIG_SHAPE_MAX];
+    float bp_x[SOC_CURVE_MAX_BREAKPOINTS];
+    float bp_y[SOC_CURVE_MAX_BREAKPOINTS];
+    int bp_count;
+    int bp_given;                       // derating_breakpoints是否为数组
+    int bp_error;                       // 第一个格式错误的折点序号(从1开始)，0为无错误
+    int bp_overflow;                    // 折点数超过SOC_CURVE_MAX_BREAKPOINTS
+    unsigned char seen[CONFIG_SCHEMA_FIELD_COUNT];  // 已绑定的配置参数(按CONFIG_SCHEMA下标)
+    unsigned char curve_seen[CURVE_FIELD_COUNT];    // 已绑定的曲线字段
+} ConfigBinding;
+
+/* ---------- 降额曲线字段(power_limits节，均为可选) ---------- */
+typedef enum {
+    CURVE_FIELD_FLOAT = 0,              // 数值，写入float
+    CURVE_FIELD_STRING = 1,             // 字符串，写入char[CONFIG_SHAPE_MAX]
+    CURVE_FIELD_BREAKPOINTS = 2         // [[d, factor], ...]
+} CurveFieldKind;
+
+typedef struct {
+    const char *name;
+    int kind;                           // CurveFieldKind
+    size_t offset;                      // 在ConfigBinding中的偏移
+} CurveField;
+
+static const CurveField CURVE_FIELDS[CURVE_FIELD_COUNT] = {
+    {"SOC_transition_width_charge", CURVE_FIELD_FLOAT, offsetof(ConfigBinding, charge_width)},
+    {"SOC_transition_width_discharge", CURVE_FIELD_FLOAT, offsetof(ConfigBinding, discharge_width)},
+    {"derating_shape", CURVE_FIELD_STRING, offsetof(ConfigBinding, shape)},
+    {"derating_breakpoints", CURVE_FIELD_BREAKPOINTS, 0},
+};
+/* ---------- 扫描位置 ---------- */
+typedef struct {
+    const char *p;
+    const char *begin;
+    const char *source;
+} ConfigCursor;
+
+// 报告语法错误(含行号)
+static int Config_SyntaxError(const ConfigCursor *cur, const char *what) {
+    int line = 1;
+    for (const char *q = cur->begin; q < cur->p; q++) {
+        line += *q == '\n';
+    }
+    fprintf(stderr, "错误: 配置文件%s第%d行JSON语法错误: %s\n", cur->source, line, what);
+    return -1;
+}
+
+static void Config_SkipSpace(ConfigCursor *cur) {
+    while (*cur->p == ' ' || *cur->p == '\t' || *cur->p == '\n' || *cur->p == '\r') {
+        cur->p++;
+    }
+}
+
+// 跳过当前字符c(及其后的空白)，不是c时返回-1
+static int Config_Expect(ConfigCursor *cur, char c, const char *what) {
+    Config_SkipSpace(cur);
+    if (*cur->p != c) {
+        return Config_SyntaxError(cur, what);
+    }
+    cur->p++;
+    Config_SkipSpace(cur);
+    return 0;
+}
+
+// 解析字符串(cur->p指向左引号)，最多把cap-1个字节写入buf；超长时*len为cap
+// buf为NULL时只跳过
+static int Config_ParseString(ConfigCursor *cur, char *buf, size_t cap, size_t *len) {
+    size_t n = 0;
+    cur->p++;
+    for (;;) {
+        char c = *cur->p;
+        if (c == '\0' || (unsigned char)c < 0x20) {
+            return Config_SyntaxError(cur, "字符串未结束");
+        }
+        cur->p++;
+        if (c == '"') {
+            break;
+        }
+        if (c == '\\') {
+            char e = *cur->p++;
+            switch (e) {
+                case '"': case '\\': case '/': c = e; break;
+                case 'b': c = '\b'; break;
+                case 'f': c = '\f'; break;
+                case 'n': c = '\n'; break;
+                case 'r': c = '\r'; break;
+                case 't': c = '\t'; break;
+                case 'u':
+                    // 字段名与形状名都是ASCII，\u转义只需保证不会误匹配
+                    for (int i = 0; i < 4; i++) {
+                        char h = *cur->p;
+                        if (!((h >= '0' && h <= '9') || (h >= 'a' && h <= 'f') || (h >= 'A' && h <= 'F'))) {
+                            return Config_SyntaxError(cur, "\\u转义格式错误");
+                        }
+                        cur->p++;
+                    }
+                    c = '\x01';
+                    break;
+                default:
+                    cur->p--;
+                    return Config_SyntaxError(cur, "无效的转义字符");
+            }
+        }
+        if (buf && n + 1 < cap) {
+            buf[n] = c;
+        }
+        n++;
+    }
+    if (buf) {
+        buf[n + 1 < cap ? n : cap - 1] = '\0';
+        *len = n < cap ? n : cap;
+    }
+    return 0;
+}
+
+// 按JSON数值语法检查后用strtod转换(文本以'\0'结尾，strtod不会越过数值末尾)
+static int Config_ParseNumber(ConfigCursor *cur, double *value) {
+    const char *q = cur->p;
+    if (*q == '-') q++;
+    if (*q == '0') {
+        q++;
+    } else if (*q >= '1' && *q <= '9') {
+        while (*q >= '0' && *q <= '9') q++;
+    } else {
+        return -1;
+    }
+    if (*q == '.') {
+        q++;
+        if (!(*q >= '0' && *q <= '9')) return -1;
+        while (*q >= '0' && *q <= '9') q++;
+    }
+    if (*q == 'e' || *q == 'E') {
+        q++;
+        if (*q == '+' || *q == '-') q++;
+        if (!(*q >= '0' && *q <= '9')) return -1;
+        while (*q >= '0' && *q <= '9') q++;
+    }
+    *value = strtod(cur->p, NULL);
+    cur->p = q;
+    return 0;
+}
+
+// 跳过一个任意JSON值(对象、数组可嵌套)
+static int Config_SkipValue(ConfigCursor *cur) {
+    char stack[CONFIG_BINDER_MAX_DEPTH];   // 各层的右括号
+    int depth = 0;
+    for (;;) {
+        Config_SkipSpace(cur);
+        char c = *cur->p;
+        if (c == '{' || c == '[') {
+            if (depth == CONFIG_BINDER_MAX_DEPTH) {
+                return Config_SyntaxError(cur, "嵌套过深");
+            }
+            stack[depth++] = c == '{' ? '}' : ']';
+            cur->p++;
+            Config_SkipSpace(cur);
+            if (*cur->p == stack[depth - 1]) {
+                cur->p++;
+                depth--;
+            } else if (c == '{') {
+                // 对象的第一个键
+                if (*cur->p != '"') {
+                    return Config_SyntaxError(cur, "应为键名");
+                }
+                if (Config_ParseString(cur, NULL, 0, NULL) != 0 || Config_Expect(cur, ':', "键后应为冒号") != 0) {
+                    return -1;
+                }
+                continue;
+            } else {
+                continue;
+            }
+        } else if (c == '"') {
+            if (Config_ParseString(cur, NULL, 0, NULL) != 0) {
+                return -1;
+            }
+        } else if (strncmp(cur->p, "true", 4) == 0) {
+            cur->p += 4;
+        } else if (strncmp(cur->p, "false", 5) == 0) {
+            cur->p += 5;
+        } else if (strncmp(cur->p, "null", 4) == 0) {
+            cur->p += 4;
+        } else {
+            double ignored;
+            if (Config_ParseNumber(cur, &ignored) != 0) {
+                return Config_SyntaxError(cur, "无效的值");
+            }
+        }
+
+        // 一个值结束：关闭已完成的容器，或继续下一个元素
+        for (;;) {
+            Config_SkipSpace(cur);
+            if (depth == 0) {
+                return 0;
+            }
+            if (*cur->p == stack[depth - 1]) {
+                cur->p++;
+                depth--;
+                continue;
+            }
+            if (*cur->p != ',') {
+                return Config_SyntaxError(cur, "应为逗号或右括号");
+            }
+            cur->p++;
+            Config_SkipSpace(cur);
+            if (stack[depth - 1] == '}') {
+                if (*cur->p != '"') {
+                    return Config_SyntaxError(cur, "应为键名");
+                }
+                if (Config_ParseString(cur, NULL, 0, NULL) != 0 || Config_Expect(cur, ':', "键后应为冒号") != 0) {
+                    return -1;
+                }
+            }
+            break;
+        }
+    }
+}
+
+// 解析一个折点[d, factor]，格式不符返回-1(不输出错误)
+static int Config_ParsePoint(ConfigCursor *cur, double *x, double *y) {
+    if (*cur->p != '[') {
+        return -1;
+    }
+    cur->p++;
+    Config_SkipSpace(cur);
+    if (Config_ParseNumber(cur, x) != 0) {
+        return -1;
+    }
+    Config_SkipSpace(cur);
+    if (*cur->p != ',') {
+        return -1;
+    }
+    cur->p++;
+    Config_SkipSpace(cur);
+    if (Config_ParseNumber(cur, y) != 0) {
+        return -1;
+    }
+    Config_SkipSpace(cur);
+    if (*cur->p != ']') {
+        return -1;
+    }
+    cur->p++;
+    return 0;
+}
+
+// 解析 [[d, factor], ...]；格式错误只记录，derating_shape为breakpoints时才报告(与原加载逻辑一致)
+static int Config_ParseBreakpoints(ConfigCursor *cur, ConfigBinding *binding) {
+    if (*cur->p != '[') {
+        return Config_SkipValue(cur);
+    }
+    binding->bp_given = 1;
+    cur->p++;
+    Config_SkipSpace(cur);
+    if (*cur->p == ']') {
+        cur->p++;
+        return 0;
+    }
+    for (int index = 1;; index++) {
+        const char *start = cur->p;
+        double x, y;
+        if (Config_ParsePoint(cur, &x, &y) != 0) {
+            // 整个元素按任意值跳过
+            cur->p = start;
+            if (binding->bp_error == 0) {
+                binding->bp_error = index;
+            }
+            if (Config_SkipValue(cur) != 0) {
+                return -1;
+            }
+        } else if (binding->bp_count >= SOC_CURVE_MAX_BREAKPOINTS) {
+            binding->bp_overflow = 1;
+        } else {
+            binding->bp_x[binding->bp_count] = (float)x;
+            binding->bp_y[binding->bp_count] = (float)y;
+            binding->bp_count++;
+        }
+        Config_SkipSpace(cur);
+        if (*cur->p == ']') {
+            cur->p++;
+            return 0;
+        }
+        if (Config_Expect(cur, ',', "折点数组中应为逗号或右方括号") != 0) {
+            return -1;
+        }
+    }
+}
+
+// 解析一个配置参数并按字段表检查范围后写入
+static int Config_BindSchemaField(ConfigCursor *cur, const ConfigSchemaField *field, ConfigBinding *binding) {
+    double value;
+    if (Config_ParseNumber(cur, &value) != 0) {
+        fprintf(stderr, "错误: 配置文件%s中%s.%s应为数值\n", cur->source,
+                CONFIG_SECTION_NAMES[field->section], field->name);
+        return -1;
+    }
+    return ConfigSchema_Set(&binding->cfg, field, value, cur->source);
+}
+
+// 解析一个降额曲线字段
+static int Config_BindCurveField(ConfigCursor *cur, const CurveField *field, ConfigBinding *binding) {
+    char *target = (char *)binding + field->offset;
+    switch (field->kind) {
+        case CURVE_FIELD_FLOAT: {
+            double value;
+            if (Config_ParseNumber(cur, &value) != 0) {
+                fprintf(stderr, "错误: 配置文件%s中power_limits.%s应为数值\n", cur->source, field->name);
+                return -1;
+            }
+            *(float *)target = (float)value;
+            return 0;
+        }
+        case CURVE_FIELD_STRING: {
+            size_t len;
+            if (*cur->p != '"') {
+                fprintf(stderr, "错误: 配置文件%s中power_limits.%s应为字符串\n", cur->source, field->name);
+                return -1;
+            }
+            return Config_ParseString(cur, target, CONFIG_SHAPE_MAX, &len);
+        }
+        default:
+            return Config_ParseBreakpoints(cur, binding);
+    }
+}
+
+// 按键名绑定一个值；字段表之外的键与不属于本节的键整体跳过，重复的键报错
+static int Config_BindKey(ConfigCursor *cur, int section, const char *key, size_t len, ConfigBinding *binding) {
+    const ConfigSchemaField *field = ConfigSchema_Find(key, len);
+    if (field) {
+        int index = (int)(field - CONFIG_SCHEMA);
+        if (field->section != section) {
+            return Config_SkipValue(cur);
+        }
+        if (binding->seen[index]) {
+            fprintf(stderr, "错误: 配置文件%s中%s.%s重复\n", cur->source, CONFIG_SECTION_NAMES[section], key);
+            return -1;
+        }
+        binding->seen[index] = 1;
+        return Config_BindSchemaField(cur, field, binding);
+    }
+    if (section == CONFIG_SECTION_POWER) {
+        for (int i = 0; i < CURVE_FIELD_COUNT; i++) {
+            if (strcmp(CURVE_FIELDS[i].name, key) == 0) {
+                if (binding->curve_seen[i]) {
+                    fprintf(stderr, "错误: 配置文件%s中%s.%s重复\n", cur->source, CONFIG_SECTION_NAMES[section], key);
+                    return -1;
+                }
+                binding->curve_seen[i] = 1;
+                return Config_BindCurveField(cur, &CURVE_FIELDS[i], binding);
+            }
+        }
+    }
+    return Config_SkipValue(cur);
+}
+
+// 解析一节(cur->p指向左花括号)
+static int Config_ParseSection(ConfigCursor *cur, int section, ConfigBinding *binding) {
+    if (Config_Expect(cur, '{', "应为左花括号") != 0) {
+        return -1;
+    }
+    if (*cur->p == '}') {
+        cur->p++;
+        return 0;
+    }
+    for (;;) {
+        char key[CONFIG_KEY_MAX];
+        size_t len;
+        if (*cur->p != '"') {
+            return Config_SyntaxError(cur, "应为键名");
+        }
+        if (Config_ParseString(cur, key, sizeof(key), &len) != 0 || Config_Expect(cur, ':', "键后应为冒号") != 0) {
+            return -1;
+        }
+        // 超长的键不可能在字段表中
+        if (len < sizeof(key) ? Config_BindKey(cur, section, key, len, binding) != 0 : Config_SkipValue(cur) != 0) {
+            return -1;
+        }
+        Config_SkipSpace(cur);
+        if (*cur->p == '}') {
+            cur->p++;
+            return 0;
+        }
+        if (Config_Expect(cur, ',', "应为逗号或右花括号") != 0) {
+            return -1;
+        }
+    }
+}
+
+// 按收集到的曲线参数编译降额曲线
+static int Config_BuildCurve(const ConfigBinding *binding, SOC_DeratingCurve *curve) {
+    int shape = SOC_CURVE_COSINE;
+    if (binding->shape[0] != '\0') {
+        shape = SOC_DeratingCurve_ParseShape(binding->shape);
+        if (shape < 0) {
+            fprintf(stderr, "错误: 未知的降额曲线形状 %s\n", binding->shape);
+            return -1;
+        }
+    }
+    if (shape == SOC_CURVE_BREAKPOINTS) {
+        if (!binding->bp_given) {
+            fprintf(stderr, "错误: derating_shape为breakpoints时必须提供derating_breakpoints数组\n");
+            return -1;
+        }
+        if (binding->bp_error > 0) {
+            fprintf(stderr, "错误: 降额曲线第%d个折点格式应为[d, factor]\n", binding->bp_error);
+            return -1;
+        }
+        if (binding->bp_overflow) {
+            fprintf(stderr, "错误: 降额曲线折点数超过%d\n", SOC_CURVE_MAX_BREAKPOINTS);
+            return -1;
+        }
+    }
+    return SOC_DeratingCurve_Build(curve, shape, binding->charge_width, binding->discharge_width,
+                                   binding->bp_x, binding->bp_y, binding->bp_count);
+}
+
+int ConfigBinder_Parse(const char *text, const char *source, SystemConfig_Cfg *cfg, SOC_DeratingCurve *curve) {
+    ConfigBinding binding;
+    memset(&binding, 0, sizeof(binding));
+    binding.charge_width = SOC_CURVE_DEFAULT_WIDTH;
+    binding.discharge_width = SOC_CURVE_DEFAULT_WIDTH;
+    int section_seen[CONFIG_SECTION_COUNT] = {0};
+
+    ConfigCursor cur = {text, text, source};
+    if (Config_Expect(&cur, '{', "根节点应为对象") != 0) {
+        return -1;
+    }
+    if (*cur.p != '}') {
+        for (;;) {
+            char key[CONFIG_KEY_MAX];
+            size_t len;
+            if (*cur.p != '"') {
+                return Config_SyntaxError(&cur, "应为键名");
+            }
+            if (Config_ParseString(&cur, key, sizeof(key), &len) != 0 || Config_Expect(&cur, ':', "键后应为冒号") != 0) {
+                return -1;
+            }
+            int section = -1;
+            for (int s = 0; s < CONFIG_SECTION_COUNT && len < sizeof(key); s++) {
+                if (strcmp(CONFIG_SECTION_NAMES[s], key) == 0) {
+                    section = s;
+                }
+            }
+            if (section >= 0 && section_seen[section]) {
+                fprintf(stderr, "错误: 配置文件%s中节%s重复\n", source, key);
+                return -1;
+            }
+            if (section >= 0 && *cur.p == '{') {
+                section_seen[section] = 1;
+                if (Config_ParseSection(&cur, section, &binding) != 0) {
+                    return -1;
+                }
+            } else if (Config_SkipValue(&cur) != 0) {
+                return -1;
+            }
+            Config_SkipSpace(&cur);
+            if (*cur.p == '}') {
+                break;
+            }
+            if (Config_Expect(&cur, ',', "应为逗号或右花括号") != 0) {
+                return -1;
+            }
+        }
+    }
+    cur.p++;
+    Config_SkipSpace(&cur);
+    if (*cur.p != '\0') {
+        return Config_SyntaxError(&cur, "根对象之后还有多余内容");
+    }
+
+    if (ConfigSchema_CheckComplete(binding.seen, source) != 0 || ConfigSchema_Validate(&binding.cfg, source) != 0) {
+        return -1;
+    }
+    if (curve && Config_BuildCurve(&binding, curve) != 0) {
+        return -1;
+    }
+    *cfg = binding.cfg;
+    return 0;
+}
@@ -0,0 +1,33 @@
+/*
+ * 文件：config_binder.h
+ * 功能：配置文件JSON单遍绑定
+ *
+ * 功能描述：
+ * 1. 按字段表(见config_schema.h)从头到尾扫描一遍JSON文本，数值直接写入SystemConfig_Cfg
+ *    与降额曲线参数，不建立cJSON对象树，不分配内存
+ * 2. 缺少字段、字段类型错误或超出范围时按"节名.字段名"报告；JSON语法错误报告行号
+ * 3. 字段表之外的键(含其他节)整体跳过；同一节或同一键出现多次时返回失败
+ */
+
+#ifndef VOLTAGE_CONTROL_CONFIG_BINDER_H
+#define VOLTAGE_CONTROL_CONFIG_BINDER_H
+
+#include "voltage_control.h"
+
+#define CONFIG_BINDER_MAX_DEPTH 64      // 跳过未知值时允许的最大嵌套深度
+
+/**
+ * @brief 把JSON配置文本绑定到配置参数与SOC降额曲线
+ *
+ * 必需字段：voltage_settings、pi_controller、power_limits三节中的14个数值参数；
+ * 可选字段：power_limits中的SOC_transition_width_charge/SOC_transition_width_discharge、
+ * derating_shape与derating_breakpoints，含义见load_configuration
+ * @param text 以'\0'结尾的JSON文本
+ * @param source 来源名称(文件名)，仅用于错误信息
+ * @param cfg [输出] 配置参数
+ * @param curve [输出] SOC降额曲线，可传NULL(仍检查曲线字段的语法)
+ * @return int 成功返回0，失败返回-1(已输出错误信息)
+ */
+int ConfigBinder_Parse(const char *text, const char *source, SystemConfig_Cfg *cfg, SOC_DeratingCurve *curve);
+
+#endif // VOLTAGE_CONTROL_CONFIG_BINDER_H
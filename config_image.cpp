@@ -0,0 +1,198 @@
+/*
+ * 文件：config_image.cpp
+ * 功能：预编译的二进制配置镜像实现
+ */
+
+#include "config_image.h"
+#include "config_schema.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#define IMAGE_ALIGN 8                   // 各区的对齐字节数
+
+/* ---------- CRC32(IEEE 802.3，反射多项式0xEDB88320) ---------- */
+
+typedef struct {
+    uint32_t entries[256];
+} Crc32Table;
+
+static constexpr Crc32Table Crc32_BuildTable() {
+    Crc32Table table = {{}};
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) {
+            c = (c & 1u) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        }
+        table.entries[i] = c;
+    }
+    return table;
+}
+
+static constexpr Crc32Table CRC32_TABLE = Crc32_BuildTable();
+
+static uint32_t Crc32(const void *data, size_t size) {
+    const unsigned char *p = (const unsigned char *)data;
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; i++) {
+        crc = CRC32_TABLE.entries[(crc ^ p[i]) & 0xFFu] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+/* ---------- 结构布局哈希 ---------- */
+
+static uint32_t Layout_Mix(uint32_t h, const void *data, size_t size) {
+    const unsigned char *p = (const unsigned char *)data;
+    for (size_t i = 0; i < size; i++) {
+        h = (h ^ p[i]) * 16777619u;
+    }
+    return h;
+}
+
+// 字段表中的名称与偏移、各结构长度、原始参数在编译后配置中的位置、曲线表段数与字节序
+// 共同决定镜像能否直接使用
+static uint32_t Layout_Hash(void) {
+    uint32_t h = 2166136261u;
+    for (int i = 0; i < CONFIG_SCHEMA_FIELD_COUNT; i++) {
+        uint32_t offset = (uint32_t)CONFIG_SCHEMA[i].offset;
+        h = Layout_Mix(h, CONFIG_SCHEMA[i].name, strlen(CONFIG_SCHEMA[i].name) + 1);
+        h = Layout_Mix(h, &offset, sizeof(offset));
+    }
+    uint32_t sizes[6] = {(uint32_t)sizeof(SystemConfig_Cfg), (uint32_t)sizeof(CompiledConfig),
+                         (uint32_t)offsetof(CompiledConfig, params), (uint32_t)sizeof(SOC_DeratingCurve),
+                         (uint32_t)SOC_CURVE_TABLE_SEGMENTS, 0x01020304u};
+    return Layout_Mix(h, sizes, sizeof(sizes));
+}
+
+static uint64_t Image_Align(uint64_t offset) {
+    return (offset + IMAGE_ALIGN - 1) / IMAGE_ALIGN * IMAGE_ALIGN;
+}
+
+// 按站点数计算各区偏移，返回文件总长度
+static uint64_t Image_Layout(uint64_t count, ConfigImageHeader *header) {
+    header->curve_offset = sizeof(ConfigImageHeader);
+    header->site_id_offset = Image_Align(header->curve_offset + sizeof(SOC_DeratingCurve));
+    header->cfg_offset = Image_Align(header->site_id_offset + count * sizeof(int32_t));
+    return header->cfg_offset + count * sizeof(CompiledConfig);
+}
+
+int ConfigImage_Write(const char *filename, const CompiledConfig *cfgs, const int *site_ids, size_t count,
+                      const SOC_DeratingCurve *curve) {
+    if (count == 0 || count > UINT32_MAX || (!site_ids && count != 1)) {
+        fprintf(stderr, "错误: 配置镜像站点数%zu非法\n", count);
+        return -1;
+    }
+
+    // 1. 在内存中组装整个镜像(未用到的填充字节为0，CRC32与重复生成的结果都是确定的)
+    ConfigImageHeader header;
+    memset(&header, 0, sizeof(header));
+    uint64_t size = Image_Layout(count, &header);
+    char *buffer = (char *)calloc(1, (size_t)size);
+    if (!buffer) {
+        fprintf(stderr, "错误: 内存分配失败\n");
+        return -1;
+    }
+    memcpy(header.magic, CONFIG_IMAGE_MAGIC, sizeof(header.magic));
+    header.version = CONFIG_IMAGE_VERSION;
+    header.layout_hash = Layout_Hash();
+    header.site_count = (uint32_t)count;
+    header.file_size = size;
+    memcpy(buffer + header.curve_offset, curve, sizeof(SOC_DeratingCurve));
+    int32_t *ids = (int32_t *)(buffer + header.site_id_offset);
+    for (size_t i = 0; i < count; i++) {
+        ids[i] = site_ids ? (int32_t)site_ids[i] : CONFIG_IMAGE_SHARED_SITE;
+    }
+    memcpy(buffer + header.cfg_offset, cfgs, count * sizeof(CompiledConfig));
+    header.checksum = Crc32(buffer + sizeof(header), (size_t)(size - sizeof(header)));
+    memcpy(buffer, &header, sizeof(header));
+
+    // 2. 先写临时文件，完整写出后再改名替换
+    size_t name_len = strlen(filename);
+    char *temp_name = (char *)malloc(name_len + 5);
+    if (!temp_name) {
+        fprintf(stderr, "错误: 内存分配失败\n");
+        free(buffer);
+        return -1;
+    }
+    memcpy(temp_name, filename, name_len);
+    memcpy(temp_name + name_len, ".tmp", 5);
+    FILE *fp = fopen(temp_name, "wb");
+    if (!fp) {
+        fprintf(stderr, "错误: 无法创建配置镜像 %s\n", temp_name);
+        free(temp_name);
+        free(buffer);
+        return -1;
+    }
+    int ok = fwrite(buffer, 1, (size_t)size, fp) == (size_t)size;
+    ok = fclose(fp) == 0 && ok;
+    free(buffer);
+#ifdef _WIN32
+    if (ok) {
+        remove(filename); // Windows下rename不覆盖已有文件
+    }
+#endif
+    if (!ok || rename(temp_name, filename) != 0) {
+        fprintf(stderr, "错误: 无法写出配置镜像 %s\n", filename);
+        remove(temp_name);
+        free(temp_name);
+        return -1;
+    }
+    free(temp_name);
+    return 0;
+}
+
+int ConfigImage_Open(ConfigImage *image, const char *filename) {
+    memset(image, 0, sizeof(*image));
+    if (MappedFile_Open(&image->file, filename) != 0) {
+        return -1;
+    }
+
+    const ConfigImageHeader *header = (const ConfigImageHeader *)image->file.data;
+    const char *problem = NULL;
+    ConfigImageHeader expected;
+    if (image->file.size < sizeof(ConfigImageHeader)) {
+        problem = "长度不足";
+    } else if (memcmp(header->magic, CONFIG_IMAGE_MAGIC, sizeof(header->magic)) != 0) {
+        problem = "不是配置镜像";
+    } else if (header->version != CONFIG_IMAGE_VERSION) {
+        problem = "版本不符，请用当前程序重新生成";
+    } else if (header->layout_hash != Layout_Hash()) {
+        problem = "结构布局与当前程序不符，请用当前程序重新生成";
+    } else if (header->site_count == 0 || header->file_size != image->file.size
+               || Image_Layout(header->site_count, &expected) != header->file_size
+               || expected.curve_offset != header->curve_offset || expected.site_id_offset != header->site_id_offset
+               || expected.cfg_offset != header->cfg_offset) {
+        problem = "长度或偏移与文件头不符，可能被截断";
+    } else if (Crc32(image->file.data + sizeof(ConfigImageHeader), image->file.size - sizeof(ConfigImageHeader))
+               != header->checksum) {
+        problem = "CRC32校验失败，文件已损坏";
+    }
+    if (problem) {
+        fprintf(stderr, "错误: 配置镜像 %s %s\n", filename, problem);
+        ConfigImage_Close(image);
+        return -1;
+    }
+
+    image->header = header;
+    image->curve = (const SOC_DeratingCurve *)(image->file.data + header->curve_offset);
+    image->site_ids = (const int32_t *)(image->file.data + header->site_id_offset);
+    image->cfgs = (const CompiledConfig *)(image->file.data + header->cfg_offset);
+    image->count = header->site_count;
+    return 0;
+}
+
+int ConfigImage_IsShared(const ConfigImage *image) {
+    return image->count == 1 && image->site_ids[0] == CONFIG_IMAGE_SHARED_SITE;
+}
+
+void ConfigImage_Close(ConfigImage *image) {
+    MappedFile_Close(&image->file);
+    image->header = NULL;
+    image->curve = NULL;
+    image->site_ids = NULL;
+    image->cfgs = NULL;
+    image->count = 0;
+}
@@ -0,0 +1,87 @@
+/*
+ * 文件：config_image.h
+ * 功能：预编译的二进制配置镜像
+ *
+ * 功能描述：
+ * 1. 把校验过的配置(config.json、config.csv或多站点.fleet)编译成控制热路径使用的形式(CompiledConfig，
+ *    死区边界、SOC平台区拐点已算好)，连同由参数编译出的SOC降额曲线表写成一个二进制镜像；启动时只需映射文件并校验文件头与CRC32，不做任何文本解析，
+ *    数千站点的配置也只是一次mmap，各台区直接读取映射区中的配置
+ * 2. 文件头记录版本号与结构布局哈希(字段表中的名称、偏移及各结构长度)，
+ *    程序升级后结构布局变化时旧镜像被拒绝，需要重新生成
+ * 3. 布局(小端序，各区按8字节对齐)：64字节文件头 | SOC_DeratingCurve | 站点编号int32[n] |
+ *    CompiledConfig[n]；由单个config.json/config.csv生成时n为1、站点编号为-1，表示全部台区共用
+ * 4. 写出时先写临时文件再改名，看门狗复位后重启的进程不会读到写了一半的镜像
+ */
+
+#ifndef VOLTAGE_CONTROL_CONFIG_IMAGE_H
+#define VOLTAGE_CONTROL_CONFIG_IMAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include "voltage_control.h"
+#include "mapped_file.h"
+
+#define CONFIG_IMAGE_MAGIC "VCCFGIMG"   // 文件头魔数，不含结尾'\0'
+#define CONFIG_IMAGE_VERSION 2         // 2: 配置区改存CompiledConfig
+#define CONFIG_IMAGE_SHARED_SITE -1     // 全部台区共用一份配置时的站点编号
+
+/* ---------- 镜像文件头(64字节) ---------- */
+typedef struct {
+    char magic[8];                  // CONFIG_IMAGE_MAGIC
+    uint32_t version;               // CONFIG_IMAGE_VERSION
+    uint32_t layout_hash;           // 结构布局哈希
+    uint32_t site_count;            // 站点数
+    uint32_t checksum;              // 文件头之后全部内容的CRC32
+    uint64_t file_size;             // 文件总长度 (字节)
+    uint64_t curve_offset;          // SOC_DeratingCurve的偏移
+    uint64_t site_id_offset;        // 站点编号数组的偏移
+    uint64_t cfg_offset;            // CompiledConfig数组的偏移
+    uint8_t reserved[8];            // 保留，写0
+} ConfigImageHeader;
+
+static_assert(sizeof(ConfigImageHeader) == 64, "ConfigImageHeader必须为64字节");
+
+/* ---------- 已映射的配置镜像 ---------- */
+typedef struct {
+    MappedFile file;
+    const ConfigImageHeader *header;
+    const SOC_DeratingCurve *curve;     // 降额曲线
+    const int32_t *site_ids;            // 各站点编号
+    const CompiledConfig *cfgs;         // 各站点编译后的配置
+    size_t count;                       // 站点数
+} ConfigImage;
+
+/**
+ * @brief 写出配置镜像
+ * @param filename 镜像文件名
+ * @param cfgs 各站点编译后的配置，须由curve编译得到
+ * @param site_ids 各站点编号，NULL表示单份共用配置(count须为1)
+ * @param count 站点数
+ * @param curve SOC降额曲线
+ * @return int 成功返回0，失败返回-1(已输出错误信息)
+ */
+int ConfigImage_Write(const char *filename, const CompiledConfig *cfgs, const int *site_ids, size_t count,
+                      const SOC_DeratingCurve *curve);
+
+/**
+ * @brief 映射配置镜像并校验文件头、结构布局、长度与CRC32
+ * @param image [输出] 配置镜像，用完后以ConfigImage_Close解除映射
+ * @param filename 镜像文件名
+ * @return int 成功返回0，失败返回-1(已输出错误信息)
+ */
+int ConfigImage_Open(ConfigImage *image, const char *filename);
+
+/**
+ * @brief 镜像是否为全部台区共用的单份配置
+ * @param image 配置镜像
+ * @return int 是返回1，否则返回0
+ */
+int ConfigImage_IsShared(const ConfigImage *image);
+
+/**
+ * @brief 解除映射，对全零的结构调用也是安全的
+ * @param image 配置镜像
+ */
+void ConfigImage_Close(ConfigImage *image);
+
+#endif // VOLTAGE_CONTROL_CONFIG_IMAGE_H
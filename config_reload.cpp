@@ -0,0 +1,229 @@
+/*
+ * 文件：config_reload.cpp
+ * 功能：配置文件热加载实现
+ */
+
+#include "config_reload.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <sys/stat.h>
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+// 释放版本号小于reader_version的旧快照，控制线程已不再访问它们
+static void Reloader_Reclaim(ConfigReloader *reloader) {
+    uint64_t in_use = reloader->reader_version.load(std::memory_order_acquire);
+    ConfigSnapshot **link = &reloader->retired;
+    while (*link) {
+        ConfigSnapshot *snapshot = *link;
+        if (snapshot->version < in_use) {
+            *link = snapshot->retired_next;
+            free(snapshot);
+        } else {
+            link = &snapshot->retired_next;
+        }
+    }
+}
+
+// 重新加载配置文件，校验通过且与当前配置不同时发布新快照
+static void Reloader_Load(ConfigReloader *reloader) {
+    ConfigSnapshot *current = reloader->current.load(std::memory_order_relaxed);
+    // calloc保证填充字节为0，下面可以直接比较整个结构
+    ConfigSnapshot *snapshot = (ConfigSnapshot *)calloc(1, sizeof(ConfigSnapshot));
+    if (!snapshot) {
+        fprintf(stderr, "错误: 内存分配失败\n");
+        return;
+    }
+    SystemConfig_Cfg cfg;
+    if (load_configuration(reloader->path, &cfg, &snapshot->curve) != 0) {
+        fprintf(stderr, "警告: 配置文件%s未通过校验，继续使用版本%llu\n", reloader->path,
+                (unsigned long long)current->version);
+        reloader->rejected.fetch_add(1, std::memory_order_relaxed);
+        free(snapshot);
+        return;
+    }
+    CompiledConfig_Build(&snapshot->cfg, &cfg, &snapshot->curve);
+    if (memcmp(&snapshot->cfg, &current->cfg, sizeof(snapshot->cfg)) == 0
+        && memcmp(&snapshot->curve, &current->curve, sizeof(snapshot->curve)) == 0) {
+        free(snapshot);     // 内容未变(如只更新了时间戳)
+        return;
+    }
+
+    snapshot->version = current->version + 1;
+    reloader->current.store(snapshot, std::memory_order_release);
+    current->retired_next = reloader->retired;
+    reloader->retired = current;
+    reloader->reloads.fetch_add(1, std::memory_order_relaxed);
+    fprintf(stderr, "配置文件%s已重新加载，版本%llu\n", reloader->path, (unsigned long long)snapshot->version);
+}
+
+#if defined(__linux__)
+// 读出全部inotify事件，返回是否有事件涉及配置文件
+static int Reloader_DrainEvents(ConfigReloader *reloader) {
+    alignas(struct inotify_event) char buf[4096];
+    int matched = 0;
+    for (;;) {
+        ssize_t n = read(reloader->watch_fd, buf, sizeof(buf));
+        if (n <= 0) {
+            return matched;
+        }
+        for (char *p = buf; p < buf + n;) {
+            const struct inotify_event *event = (const struct inotify_event *)p;
+            if (event->len > 0 && strcmp(event->name, reloader->name) == 0) {
+                matched = 1;
+            }
+            p += sizeof(struct inotify_event) + event->len;
+        }
+    }
+}
+#endif
+
+// 读取文件修改时间与大小，用于轮询
+static int Reloader_Stat(const char *path, long long *mtime, long long *size) {
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        return -1;
+    }
+    *mtime = (long long)st.st_mtime;
+    *size = (long long)st.st_size;
+    return 0;
+}
+
+static void Reloader_ThreadMain(ConfigReloader *reloader) {
+    long long last_mtime = 0;
+    long long last_size = 0;
+    if (reloader->watch_fd < 0) {
+        Reloader_Stat(reloader->path, &last_mtime, &last_size);
+    }
+
+    while (reloader->running.load(std::memory_order_acquire)) {
+        int changed = 0;
+#if defined(__linux__)
+        if (reloader->watch_fd >= 0) {
+            struct pollfd pfd = {reloader->watch_fd, POLLIN, 0};
+            if (poll(&pfd, 1, CONFIG_RELOAD_WAKE_MS) > 0 && Reloader_DrainEvents(reloader)) {
+                // 等待写入完成，期间的后续事件合并为一次加载
+                std::this_thread::sleep_for(std::chrono::milliseconds(CONFIG_RELOAD_SETTLE_MS));
+                Reloader_DrainEvents(reloader);
+                changed = 1;
+            }
+        }
+#endif
+        if (reloader->watch_fd < 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(CONFIG_RELOAD_POLL_MS));
+            long long mtime, size;
+            if (Reloader_Stat(reloader->path, &mtime, &size) == 0 && (mtime != last_mtime || size != last_size)) {
+                last_mtime = mtime;
+                last_size = size;
+                changed = 1;
+            }
+        }
+
+        if (changed) {
+            Reloader_Load(reloader);
+        }
+        Reloader_Reclaim(reloader);
+    }
+}
+
+int ConfigReloader_Start(ConfigReloader *reloader, const char *filename, const SystemConfig_Cfg *cfg,
+                         const SOC_DeratingCurve *curve) {
+    ConfigSnapshot *initial = (ConfigSnapshot *)calloc(1, sizeof(ConfigSnapshot));
+    size_t len = strlen(filename);
+    reloader->path = (char *)malloc(len + 1);
+    reloader->dir = (char *)malloc(len + 2);
+    if (!initial || !reloader->path || !reloader->dir) {
+        fprintf(stderr, "错误: 内存分配失败\n");
+        free(initial);
+        free(reloader->path);
+        free(reloader->dir);
+        return -1;
+    }
+    memcpy(reloader->path, filename, len + 1);
+    const char *slash = strrchr(reloader->path, '/');
+    if (slash) {
+        size_t dir_len = slash == reloader->path ? 1 : (size_t)(slash - reloader->path);
+        memcpy(reloader->dir, reloader->path, dir_len);
+        reloader->dir[dir_len] = '\0';
+        reloader->name = slash + 1;
+    } else {
+        strcpy(reloader->dir, ".");
+        reloader->name = reloader->path;
+    }
+
+    CompiledConfig_Build(&initial->cfg, cfg, curve);
+    initial->curve = *curve;
+    initial->version = 1;
+    reloader->current.store(initial, std::memory_order_relaxed);
+    reloader->reader_version.store(1, std::memory_order_relaxed);
+    reloader->reloads.store(0, std::memory_order_relaxed);
+    reloader->rejected.store(0, std::memory_order_relaxed);
+    reloader->retired = NULL;
+
+    // 监视所在目录：编辑器常以新文件替换原文件，只监视文件本身会丢失后续变化
+    reloader->watch_fd = -1;
+#if defined(__linux__)
+    reloader->watch_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (reloader->watch_fd >= 0
+        && inotify_add_watch(reloader->watch_fd, reloader->dir, IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        close(reloader->watch_fd);
+        reloader->watch_fd = -1;
+    }
+    if (reloader->watch_fd < 0) {
+        fprintf(stderr, "警告: 无法监视目录%s，改为每%dms检查一次配置文件修改时间\n", reloader->dir,
+                CONFIG_RELOAD_POLL_MS);
+    }
+#endif
+
+    reloader->running.store(1, std::memory_order_release);
+    reloader->thread = std::thread(Reloader_ThreadMain, reloader);
+    return 0;
+}
+
+void ConfigReloader_Stop(ConfigReloader *reloader) {
+    reloader->running.store(0, std::memory_order_release);
+    if (reloader->thread.joinable()) {
+        reloader->thread.join();
+    }
+#if defined(__linux__)
+    if (reloader->watch_fd >= 0) {
+        close(reloader->watch_fd);
+    }
+#endif
+    reloader->watch_fd = -1;
+    while (reloader->retired) {
+        ConfigSnapshot *next = reloader->retired->retired_next;
+        free(reloader->retired);
+        reloader->retired = next;
+    }
+    free(reloader->current.exchange(NULL, std::memory_order_relaxed));
+    free(reloader->path);
+    free(reloader->dir);
+    reloader->path = NULL;
+    reloader->dir = NULL;
+}
+
+const ConfigSnapshot *ConfigReloader_Poll(ConfigReloader *reloader, uint64_t *version) {
+    const ConfigSnapshot *snapshot = reloader->current.load(std::memory_order_acquire);
+    if (snapshot->version == *version) {
+        return NULL;
+    }
+    *version = snapshot->version;
+    return snapshot;
+}
+
+void ConfigReloader_Release(ConfigReloader *reloader, const ConfigSnapshot *snapshot) {
+    reloader->reader_version.store(snapshot->version, std::memory_order_release);
+}
+
+void ConfigReloader_PrintStats(const ConfigReloader *reloader, FILE *fp) {
+    fprintf(fp, "配置热加载: 成功=%llu, 拒绝=%llu, 当前版本=%llu\n",
+            (unsigned long long)reloader->reloads.load(std::memory_order_relaxed),
+            (unsigned long long)reloader->rejected.load(std::memory_order_relaxed),
+            (unsigned long long)reloader->current.load(std::memory_order_acquire)->version);
+}
@@ -0,0 +1,92 @@
+/*
+ * 文件：config_reload.h
+ * 功能：配置文件热加载
+ *
+ * 功能描述：
+ * 1. 后台线程监视配置文件(Linux下用inotify监视所在目录，兼容编辑器"写临时文件再改名"的保存方式；
+ *    其他平台按修改时间轮询)，文件变化后在后台线程中解析、校验
+ * 2. 校验通过的配置在后台线程中编译(CompiledConfig)并做成新的只读快照，以原子指针交换发布；
+ *    控制线程每个周期只做一次原子读，不加锁、不做文件I/O，发现新版本后把编译好的配置复制进各台区上下文
+ * 3. 旧快照按RCU方式回收：控制线程复制完新快照后登记已使用的版本号，
+ *    后台线程只释放版本号小于该值的旧快照
+ * 4. 解析或校验失败的配置被丢弃，运行中的配置保持不变
+ */
+
+#ifndef VOLTAGE_CONTROL_CONFIG_RELOAD_H
+#define VOLTAGE_CONTROL_CONFIG_RELOAD_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include "voltage_control.h"
+
+#define CONFIG_RELOAD_WAKE_MS 200       // 后台线程检查停止标志的间隔 (ms)
+#define CONFIG_RELOAD_SETTLE_MS 50      // 文件变化后等待写入完成的时间，期间的多次变化合并为一次加载 (ms)
+#define CONFIG_RELOAD_POLL_MS 500       // 无inotify时轮询修改时间的间隔 (ms)
+
+/* ---------- 配置快照(发布后只读) ---------- */
+typedef struct ConfigSnapshot {
+    CompiledConfig cfg;                 // 编译后的配置
+    SOC_DeratingCurve curve;            // SOC降额曲线
+    uint64_t version;                   // 版本号，启动时的配置为1
+    struct ConfigSnapshot *retired_next;    // 待回收链表(仅后台线程访问)
+} ConfigSnapshot;
+
+/* ---------- 热加载线程 ---------- */
+struct ConfigReloader {
+    char *path;                         // 配置文件路径
+    char *dir;                          // 所在目录
+    const char *name;                   // 文件名(指向path内部)
+    std::atomic<ConfigSnapshot *> current;  // 当前发布的快照
+    std::atomic<uint64_t> reader_version;   // 控制线程已复制完成的版本号
+    std::atomic<uint64_t> reloads;      // 成功加载次数
+    std::atomic<uint64_t> rejected;     // 被拒绝的配置次数
+    std::atomic<int> running;           // 后台线程运行标志
+    ConfigSnapshot *retired;            // 已被替换、等待回收的快照(仅后台线程访问)
+    int watch_fd;                       // inotify描述符，-1表示轮询修改时间
+    std::thread thread;
+};
+
+/**
+ * @brief 以启动时加载的配置作为版本1，启动热加载线程
+ * @param reloader 热加载线程
+ * @param filename 配置文件路径(与启动时加载的文件相同)
+ * @param cfg 启动时的配置参数
+ * @param curve 启动时的SOC降额曲线
+ * @return int 成功返回0，失败返回-1
+ */
+int ConfigReloader_Start(ConfigReloader *reloader, const char *filename, const SystemConfig_Cfg *cfg,
+                         const SOC_DeratingCurve *curve);
+
+/**
+ * @brief 停止热加载线程并释放全部快照
+ * @param reloader 热加载线程
+ */
+void ConfigReloader_Stop(ConfigReloader *reloader);
+
+/**
+ * @brief 控制线程检查是否有新版本的配置(非阻塞，一次原子读)
+ *
+ * 返回的快照在调用ConfigReloader_Release之前保持有效
+ * @param reloader 热加载线程
+ * @param version 控制线程当前使用的版本号，有新版本时更新
+ * @return const ConfigSnapshot* 有新版本时返回新快照，否则返回NULL
+ */
+const ConfigSnapshot *ConfigReloader_Poll(ConfigReloader *reloader, uint64_t *version);
+
+/**
+ * @brief 控制线程复制完快照后登记，之后不再访问该快照及更早的快照
+ * @param reloader 热加载线程
+ * @param snapshot ConfigReloader_Poll返回的快照
+ */
+void ConfigReloader_Release(ConfigReloader *reloader, const ConfigSnapshot *snapshot);
+
+/**
+ * @brief 输出热加载统计信息
+ * @param reloader 热加载线程
+ * @param fp 输出流
+ */
+void ConfigReloader_PrintStats(const ConfigReloader *reloader, FILE *fp);
+
+#endif // VOLTAGE_CONTROL_CONFIG_RELOAD_H
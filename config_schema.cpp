@@ -0,0 +1,152 @@
+/*
+ * 文件：config_schema.cpp
+ * 功能：配置参数字段表与完美哈希查找实现
+ */
+
+#include "config_schema.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#define SCHEMA_SLOT_COUNT 32            // 哈希槽位数(2的幂)，约为字段数的两倍，种子容易找到
+
+const char *const CONFIG_SECTION_NAMES[CONFIG_SECTION_COUNT] = {"voltage_settings", "pi_controller", "power_limits"};
+
+#define SCHEMA_FLOAT(section, name, min, max) \
+    {#name, section, offsetof(SystemConfig_Cfg, name), CONFIG_TYPE_FLOAT, min, max}
+constexpr ConfigSchemaField CONFIG_SCHEMA[CONFIG_SCHEMA_FIELD_COUNT] = {
+    SCHEMA_FLOAT(CONFIG_SECTION_VOLTAGE, V_ref_upper, 0.0f, 1000.0f),
+    SCHEMA_FLOAT(CONFIG_SECTION_VOLTAGE, V_ref_lower, 0.0f, 1000.0f),
+    SCHEMA_FLOAT(CONFIG_SECTION_VOLTAGE, Deadband_upper, 0.0f, 100.0f),
+    SCHEMA_FLOAT(CONFIG_SECTION_VOLTAGE, Deadband_lower, 0.0f, 100.0f),
+    SCHEMA_FLOAT(CONFIG_SECTION_VOLTAGE, V_enter_lower, 0.0f, 1000.0f),
+    SCHEMA_FLOAT(CONFIG_SECTION_PI, Kp_upper, 0.0f, 10000.0f),
+    SCHEMA_FLOAT(CONFIG_SECTION_PI, Ki_upper, 0.0f, 10000.0f),
+    SCHEMA_FLOAT(CONFIG_SECTION_PI, Kp_lower, 0.0f, 10000.0f),
+    SCHEMA_FLOAT(CONFIG_SECTION_PI, Ki_lower, 0.0f, 10000.0f),
+    SCHEMA_FLOAT(CONFIG_SECTION_POWER, P_step_max, 0.0f, 10000.0f),
+    SCHEMA_FLOAT(CONFIG_SECTION_POWER, P_charge_max, 0.0f, 10000.0f),
+    SCHEMA_FLOAT(CONFIG_SECTION_POWER, P_discharge_max, 0.0f, 10000.0f),
+    SCHEMA_FLOAT(CONFIG_SECTION_POWER, SOC_max, 0.0f, 1.0f),
+    SCHEMA_FLOAT(CONFIG_SECTION_POWER, SOC_min, 0.0f, 1.0f),
+};
+#undef SCHEMA_FLOAT
+
+static_assert(sizeof(SystemConfig_Cfg) == CONFIG_SCHEMA_FIELD_COUNT * sizeof(float),
+              "SystemConfig_Cfg增加了成员，请同时在CONFIG_SCHEMA中增加对应字段");
+
+/* ---------- 编译期完美哈希 ---------- */
+
+// 带种子的FNV-1a
+static constexpr uint32_t Schema_Hash(const char *name, size_t len, uint32_t seed) {
+    uint32_t h = 2166136261u ^ seed;
+    for (size_t i = 0; i < len; i++) {
+        h = (h ^ (unsigned char)name[i]) * 16777619u;
+    }
+    return h ^ (h >> 15);
+}
+
+static constexpr size_t Schema_Length(const char *name) {
+    size_t len = 0;
+    while (name[len] != '\0') {
+        len++;
+    }
+    return len;
+}
+
+typedef struct {
+    uint32_t seed;                      // 使各名称落在不同槽位的种子，0表示未找到
+    signed char slots[SCHEMA_SLOT_COUNT];   // 槽位对应的CONFIG_SCHEMA下标，-1为空
+} SchemaHashTable;
+
+// 从1开始逐个尝试种子，直到全部名称互不冲突
+static constexpr SchemaHashTable Schema_BuildTable() {
+    SchemaHashTable table = {0, {}};
+    for (uint32_t seed = 1; seed < 100000; seed++) {
+        for (int s = 0; s < SCHEMA_SLOT_COUNT; s++) {
+            table.slots[s] = -1;
+        }
+        bool ok = true;
+        for (int i = 0; ok && i < CONFIG_SCHEMA_FIELD_COUNT; i++) {
+            const char *name = CONFIG_SCHEMA[i].name;
+            uint32_t slot = Schema_Hash(name, Schema_Length(name), seed) & (SCHEMA_SLOT_COUNT - 1);
+            if (table.slots[slot] >= 0) {
+                ok = false;
+            } else {
+                table.slots[slot] = (signed char)i;
+            }
+        }
+        if (ok) {
+            table.seed = seed;
+            return table;
+        }
+    }
+    return table;
+}
+
+static constexpr SchemaHashTable SCHEMA_HASH = Schema_BuildTable();
+static_assert(SCHEMA_HASH.seed != 0, "未找到无冲突的哈希种子，请增大SCHEMA_SLOT_COUNT");
+
+const ConfigSchemaField *ConfigSchema_Find(const char *name, size_t len) {
+    int index = SCHEMA_HASH.slots[Schema_Hash(name, len, SCHEMA_HASH.seed) & (SCHEMA_SLOT_COUNT - 1)];
+    if (index < 0) {
+        return NULL;
+    }
+    const ConfigSchemaField *field = &CONFIG_SCHEMA[index];
+    if (strncmp(field->name, name, len) != 0 || field->name[len] != '\0') {
+        return NULL;
+    }
+    return field;
+}
+
+int ConfigSchema_Store(SystemConfig_Cfg *cfg, const ConfigSchemaField *field, double value) {
+    if (!std::isfinite(value) || value < field->min || value > field->max) {
+        return -1;
+    }
+    *(float *)((char *)cfg + field->offset) = (float)value;
+    return 0;
+}
+
+int ConfigSchema_Set(SystemConfig_Cfg *cfg, const ConfigSchemaField *field, double value, const char *source) {
+    if (ConfigSchema_Store(cfg, field, value) != 0) {
+        fprintf(stderr, "错误: 配置文件%s中%s.%s=%g超出范围[%g, %g]\n", source,
+                CONFIG_SECTION_NAMES[field->section], field->name, value, field->min, field->max);
+        return -1;
+    }
+    return 0;
+}
+
+int ConfigSchema_CheckComplete(const unsigned char *seen, const char *source) {
+    int ret = 0;
+    for (int i = 0; i < CONFIG_SCHEMA_FIELD_COUNT; i++) {
+        if (!seen[i]) {
+            fprintf(stderr, "错误: 配置文件%s缺少%s.%s\n", source,
+                    CONFIG_SECTION_NAMES[CONFIG_SCHEMA[i].section], CONFIG_SCHEMA[i].name);
+            ret = -1;
+        }
+    }
+    return ret;
+}
+
+const char *ConfigSchema_CheckRelations(const SystemConfig_Cfg *cfg) {
+    if (!(cfg->V_ref_lower < cfg->V_ref_upper)) {
+        return "V_ref_lower必须小于V_ref_upper";
+    }
+    if (!(cfg->V_enter_lower < cfg->V_ref_lower)) {
+        return "V_enter_lower必须小于V_ref_lower";
+    }
+    if (!(cfg->SOC_min < cfg->SOC_max)) {
+        return "SOC_min必须小于SOC_max";
+    }
+    return NULL;
+}
+
+int ConfigSchema_Validate(const SystemConfig_Cfg *cfg, const char *source) {
+    const char *problem = ConfigSchema_CheckRelations(cfg);
+    if (problem) {
+        fprintf(stderr, "错误: 配置文件%s中%s\n", source, problem);
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,97 @@
+/*
+ * 文件：config_schema.h
+ * 功能：配置参数字段表
+ *
+ * 功能描述：
+ * 1. SystemConfig_Cfg的每个参数在表中占一项：名称、所在节、偏移、类型、取值范围；
+ *    JSON与CSV两种配置加载器都由此表驱动，增加一个参数只需在表中增加一项
+ * 2. 按键名查找字段使用编译期生成的完美哈希表：哈希种子在编译期搜索得到，
+ *    表中各名称落在不同的槽位，查找为一次哈希加一次字符串比较
+ * 3. 写入参数时检查取值范围，超出范围按"节名.字段名"报告；全部读入后再检查参数之间的关系
+ */
+
+#ifndef VOLTAGE_CONTROL_CONFIG_SCHEMA_H
+#define VOLTAGE_CONTROL_CONFIG_SCHEMA_H
+
+#include <cstddef>
+#include "voltage_control.h"
+
+/* ---------- 配置文件中的节 ---------- */
+typedef enum {
+    CONFIG_SECTION_VOLTAGE = 0,         // voltage_settings
+    CONFIG_SECTION_PI = 1,              // pi_controller
+    CONFIG_SECTION_POWER = 2,           // power_limits
+    CONFIG_SECTION_COUNT = 3
+} ConfigSection;
+
+/* ---------- 字段类型 ---------- */
+typedef enum {
+    CONFIG_TYPE_FLOAT = 0               // float参数
+} ConfigValueType;
+
+/* ---------- 字段描述 ---------- */
+typedef struct {
+    const char *name;                   // 键名，与SystemConfig_Cfg成员同名
+    int section;                        // ConfigSection
+    size_t offset;                      // 在SystemConfig_Cfg中的偏移
+    int type;                           // ConfigValueType
+    float min;                          // 取值下限(含)
+    float max;                          // 取值上限(含)
+} ConfigSchemaField;
+
+#define CONFIG_SCHEMA_FIELD_COUNT 14    // SystemConfig_Cfg参数个数
+
+extern const char *const CONFIG_SECTION_NAMES[CONFIG_SECTION_COUNT];
+extern const ConfigSchemaField CONFIG_SCHEMA[CONFIG_SCHEMA_FIELD_COUNT];
+
+/**
+ * @brief 按键名查找字段
+ * @param name 键名(不要求以'\0'结尾)
+ * @param len 键名长度
+ * @return const ConfigSchemaField* 找到返回字段描述，否则返回NULL
+ */
+const ConfigSchemaField *ConfigSchema_Find(const char *name, size_t len);
+
+/**
+ * @brief 检查取值范围后写入参数，不输出错误信息
+ * @param cfg 配置参数
+ * @param field 字段描述
+ * @param value 参数值
+ * @return int 成功返回0，超出范围或不是有限值返回-1
+ */
+int ConfigSchema_Store(SystemConfig_Cfg *cfg, const ConfigSchemaField *field, double value);
+
+/**
+ * @brief 检查取值范围后写入参数
+ * @param cfg 配置参数
+ * @param field 字段描述
+ * @param value 参数值
+ * @param source 来源名称(文件名)，仅用于错误信息
+ * @return int 成功返回0，超出范围或不是有限值返回-1(已输出错误信息)
+ */
+int ConfigSchema_Set(SystemConfig_Cfg *cfg, const ConfigSchemaField *field, double value, const char *source);
+
+/**
+ * @brief 检查全部字段都已给出，缺少的按"节名.字段名"逐一报告
+ * @param seen 按CONFIG_SCHEMA下标记录各字段是否已给出
+ * @param source 来源名称(文件名)，仅用于错误信息
+ * @return int 全部给出返回0，否则返回-1
+ */
+int ConfigSchema_CheckComplete(const unsigned char *seen, const char *source);
+
+/**
+ * @brief 检查参数之间的关系：V_enter_lower < V_ref_lower < V_ref_upper，SOC_min < SOC_max
+ * @param cfg 配置参数
+ * @return const char* 合法返回NULL，否则返回问题描述
+ */
+const char *ConfigSchema_CheckRelations(const SystemConfig_Cfg *cfg);
+
+/**
+ * @brief 检查参数之间的关系，不合法时输出错误信息
+ * @param cfg 配置参数
+ * @param source 来源名称(文件名)，仅用于错误信息
+ * @return int 合法返回0，否则返回-1(已输出错误信息)
+ */
+int ConfigSchema_Validate(const SystemConfig_Cfg *cfg, const char *source);
+
+#endif // VOLTAGE_CONTROL_CONFIG_SCHEMA_H
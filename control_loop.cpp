@@ -0,0 +1,148 @@
+/*
+ * 文件：control_loop.cpp
+ * 功能：主控制循环实现
+ */
+
+#include "control_loop.h"
+#include "scheduler.h"
+
+// 主控制循环：对本进程驱动的所有台区执行一个控制周期
+// acq非空时从采集线程发布的最新样本取数，不在控制线程内做任何I/O
+// 各阶段对全部台区批量执行，每个阶段边界只读一次时钟，分阶段耗时记入probes
+void Main_VoltageControlLoop(VoltageController *ctrls, size_t count, AcquisitionThread *acq,
+                             TelemetryLogger *logger, uint32_t cycle, LatencyProbes *probes) {
+    int64_t t_begin = Monotonic_NowNs();
+
+    // 1. 读取实时数据
+    for (size_t i = 0; i < count; i++) {
+        if (!acq) {
+            // 读取实时数据 (需要您实现硬件接口通信)
+            Simulate_RealTimeData(&ctrls[i].sim, &ctrls[i].status);
+            ctrls[i].has_measurement = 1;
+        } else {
+            // 样本过期(返回1)时不更新限值、模式与PI积分，保持上一周期的指令，计入采集统计的过期周期
+            int fresh = Acquisition_ReadLatest(acq, i, &ctrls[i].status);
+            ctrls[i].has_measurement = fresh == 0;
+            if (fresh < 0) {
+                ctrls[i].P_cmd = 0.0f; // 尚未采到任何数据，保持不动作
+            }
+        }
+    }
+    int64_t t_acquired = Monotonic_NowNs();
+
+    // 2. SOC功率限值
+    for (size_t i = 0; i < count; i++) {
+        if (ctrls[i].has_measurement) {
+            VoltageController_UpdateLimits(&ctrls[i]);
+        }
+    }
+    int64_t t_limited = Monotonic_NowNs();
+
+    // 3. 模式判断
+    for (size_t i = 0; i < count; i++) {
+        if (ctrls[i].has_measurement) {
+            VoltageController_UpdateMode(&ctrls[i]);
+        }
+    }
+    int64_t t_moded = Monotonic_NowNs();
+
+    // 4. PI计算
+    for (size_t i = 0; i < count; i++) {
+        if (ctrls[i].has_measurement) {
+            VoltageController_UpdateCommand(&ctrls[i]);
+        }
+    }
+    int64_t t_computed = Monotonic_NowNs();
+
+    // 电池模型闭环(仅控制线程自行读取数据时；采集线程的数据源在另一线程，不闭环)
+    if (!acq) {
+        for (size_t i = 0; i < count; i++) {
+            Simulation_ApplyCommand(&ctrls[i].sim, ctrls[i].P_cmd);
+        }
+    }
+
+    // 5. 发送指令给PCS，运行记录交给日志线程异步输出
+    if (logger) {
+        TelemetryRecord record;
+        for (size_t i = 0; i < count; i++) {
+            TelemetryRecord_FromController(&record, &ctrls[i], cycle, t_computed);
+            TelemetryLogger_Log(logger, &record);
+        }
+    }
+    int64_t t_end = Monotonic_NowNs();
+
+    if (!probes) {
+        return;
+    }
+    LatencyProbes_Record(probes, LATENCY_STAGE_ACQUISITION, t_acquired - t_begin);
+    LatencyProbes_Record(probes, LATENCY_STAGE_SOC_LIMITS, t_limited - t_acquired);
+    LatencyProbes_Record(probes, LATENCY_STAGE_MODE, t_moded - t_limited);
+    LatencyProbes_Record(probes, LATENCY_STAGE_PI, t_computed - t_moded);
+    LatencyProbes_Record(probes, LATENCY_STAGE_OUTPUT, t_end - t_computed);
+    LatencyProbes_Record(probes, LATENCY_STAGE_CYCLE, t_end - t_begin);
+}
+
+// 批量模式主控制循环：模拟数据写入结构数组后整批计算，汇总只在内存中累计，周期内不写控制台
+void Fleet_VoltageControlLoop(VoltageFleet *fleet, SimulationState *sims, AcquisitionThread *acq,
+                              TelemetryLogger *logger, uint32_t cycle, FleetLoopStats *stats) {
+    SystemStatus_RealTime status = {};
+
+    // 1. 读取各台区实时数据；没有新鲜样本的台区本周期冻结(尚无样本时指令保持初始零值)，与逐台区路径一致
+    for (size_t i = 0; i < fleet->count; i++) {
+        if (!acq) {
+            Simulate_RealTimeData(&sims[i], &status);
+        } else {
+            int fresh = Acquisition_ReadLatest(acq, i, &status);
+            VoltageFleet_SetValid(fleet, i, fresh == 0);
+            if (fresh < 0) {
+                continue;
+            }
+        }
+        VoltageFleet_SetMeasurement(fleet, i, &status);
+    }
+
+    // 2. 整批计算
+    int64_t t_start = Monotonic_NowNs();
+    VoltageFleet_Step(fleet);
+    int64_t t_end = Monotonic_NowNs();
+    if (!acq) {
+        for (size_t i = 0; i < fleet->count; i++) {
+            Simulation_ApplyCommand(&sims[i], fleet->P_cmd[i]);
+        }
+    }
+
+    // 3. 累计汇总
+    if (stats) {
+        double P_cmd_total = 0.0;
+        for (size_t i = 0; i < fleet->count; i++) {
+            stats->mode_count[fleet->Ctrl_Mode[i]]++;
+            P_cmd_total += fleet->P_cmd[i];
+        }
+        stats->cycles++;
+        stats->P_cmd_total_last = P_cmd_total;
+        stats->compute_ns_total += t_end - t_start;
+        if (t_end - t_start > stats->compute_ns_max) {
+            stats->compute_ns_max = t_end - t_start;
+        }
+    }
+
+    // 4. 指定了日志文件时记录全部台区
+    if (logger) {
+        TelemetryRecord record;
+        for (size_t i = 0; i < fleet->count; i++) {
+            TelemetryRecord_FromFleet(&record, fleet, i, cycle, t_end);
+            TelemetryLogger_Log(logger, &record);
+        }
+    }
+}
+
+void FleetLoopStats_Print(const FleetLoopStats *stats, size_t count, FILE *fp) {
+    double area_cycles = (double)stats->cycles * (double)count;
+    double scale = area_cycles > 0.0 ? 100.0 / area_cycles : 0.0;
+    fprintf(fp, "批量模式: 台区数=%zu, 周期数=%llu, 正常/过压/欠压=%.2f%%/%.2f%%/%.2f%%, 最后周期总功率指令=%.2fkW, "
+                "计算耗时 平均=%.3fms 最大=%.3fms\n",
+            count, (unsigned long long)stats->cycles, (double)stats->mode_count[0] * scale,
+            (double)stats->mode_count[1] * scale, (double)stats->mode_count[2] * scale, stats->P_cmd_total_last,
+            stats->cycles ? (double)stats->compute_ns_total / (double)stats->cycles / 1e6 : 0.0,
+            (double)stats->compute_ns_max / 1e6);
+}
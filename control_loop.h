@@ -0,0 +1,63 @@
+/*
+ * 文件：control_loop.h
+ * 功能：主控制循环(一个控制周期)
+ *
+ * 功能描述：
+ * 1. 逐台区模式：对控制器上下文数组分阶段执行读取、限值、模式判断、PI计算和指令输出
+ * 2. 批量模式：对结构数组批量引擎执行同样的一个周期，汇总信息只累计，退出时输出一次
+ * 3. 两种循环都只负责一个周期，周期调度、信号处理等由调用者负责
+ */
+
+#ifndef VOLTAGE_CONTROL_CONTROL_LOOP_H
+#define VOLTAGE_CONTROL_CONTROL_LOOP_H
+
+#include <cstddef>
+#include <cstdint>
+#include "voltage_control.h"
+#include "fleet.h"
+#include "acquisition.h"
+#include "telemetry_log.h"
+#include "latency_stats.h"
+
+/**
+ * @brief 逐台区模式主控制循环：对本进程驱动的所有台区执行一个控制周期
+ * @param ctrls 控制器上下文数组
+ * @param count 台区数量
+ * @param acq 采集线程，非空时从其发布的最新样本取数，为NULL时就地读取模拟数据
+ * @param logger 日志器，为NULL时不记录
+ * @param cycle 控制周期序号(写入日志记录)
+ * @param probes 分阶段耗时探针，为NULL时不计时
+ */
+void Main_VoltageControlLoop(VoltageController *ctrls, size_t count, AcquisitionThread *acq,
+                             TelemetryLogger *logger, uint32_t cycle, LatencyProbes *probes);
+
+/* ---------- 批量模式运行汇总(控制线程累计，退出时输出) ---------- */
+typedef struct {
+    uint64_t cycles;                // 已执行的控制周期数
+    uint64_t mode_count[3];         // 各控制模式累计的台区周期数: 正常/过压/欠压
+    double P_cmd_total_last;        // 最近一个周期全部台区的总功率指令 (kW)
+    int64_t compute_ns_total;       // 整批计算累计耗时 (ns)
+    int64_t compute_ns_max;         // 单周期整批计算最大耗时 (ns)
+} FleetLoopStats;
+
+/**
+ * @brief 批量模式主控制循环：模拟数据写入结构数组后整批计算，不做任何控制台输出
+ * @param fleet 批量引擎
+ * @param sims 各台区模拟数据源状态(acq为NULL时使用)
+ * @param acq 采集线程，可为NULL
+ * @param logger 日志器，为NULL时不记录
+ * @param cycle 控制周期序号(写入日志记录)
+ * @param stats [输出] 运行汇总，累计本周期的模式分布与计算耗时，可为NULL
+ */
+void Fleet_VoltageControlLoop(VoltageFleet *fleet, SimulationState *sims, AcquisitionThread *acq,
+                              TelemetryLogger *logger, uint32_t cycle, FleetLoopStats *stats);
+
+/**
+ * @brief 输出批量模式运行汇总
+ * @param stats 运行汇总
+ * @param count 台区数量
+ * @param fp 输出流
+ */
+void FleetLoopStats_Print(const FleetLoopStats *stats, size_t count, FILE *fp);
+
+#endif // VOLTAGE_CONTROL_CONTROL_LOOP_H
@@ -0,0 +1,221 @@
+/*
+ * 文件：fleet.cpp
+ * 功能：结构数组(SoA)布局的多台区批量控制引擎实现
+ *
+ * 说明：
+ * 批量内核写成带__restrict参数的独立函数，条件全部写成三目选择或32位掩码运算，
+ * 在-O3(或-O2 -ftree-vectorize)下编译器可将整个循环展开为SIMD比较+混合指令。
+ */
+
+#include "fleet.h"
+#include "soc_limits.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#define FLEET_ALIGN 64                          // 数组起始地址对齐(字节)
+#define FLEET_LANES (FLEET_ALIGN / sizeof(float)) // 每个数组长度向上取整到的倍数
+
+// 每个台区占用的float/int32数组个数
+#define FLEET_ARRAY_COUNT 26
+
+static inline float Min_f(float a, float b) { return a < b ? a : b; }
+static inline float Max_f(float a, float b) { return a > b ? a : b; }
+
+int VoltageFleet_Init(VoltageFleet *fleet, size_t count) {
+    memset(fleet, 0, sizeof(*fleet));
+    if (count == 0) {
+        fprintf(stderr, "错误: 台区数量必须大于0\n");
+        return -1;
+    }
+
+    size_t stride = (count + FLEET_LANES - 1) / FLEET_LANES * FLEET_LANES;
+    size_t bytes = stride * sizeof(float) * FLEET_ARRAY_COUNT + FLEET_ALIGN;
+    void *block = calloc(1, bytes);
+    if (!block) {
+        fprintf(stderr, "错误: 内存分配失败\n");
+        return -1;
+    }
+
+    // 按FLEET_ALIGN对齐后依次切分出各数组
+    uintptr_t base = ((uintptr_t)block + FLEET_ALIGN - 1) & ~(uintptr_t)(FLEET_ALIGN - 1);
+    float *p = (float *)base;
+    fleet->V_meas = p;                  p += stride;
+    fleet->SOC = p;                     p += stride;
+    fleet->P_meas = p;                  p += stride;
+    fleet->P_soc_charge_limit = p;      p += stride;
+    fleet->P_soc_discharge_limit = p;   p += stride;
+    fleet->valid = (int32_t *)p;        p += stride;
+    fleet->Ctrl_Mode = (int32_t *)p;    p += stride;
+    fleet->integral_upper = p;          p += stride;
+    fleet->integral_lower = p;          p += stride;
+    fleet->P_cmd = p;                   p += stride;
+    fleet->V_upper_edge = p;            p += stride;
+    fleet->V_lower_edge = p;            p += stride;
+    fleet->V_enter_lower = p;           p += stride;
+    fleet->V_ref_upper = p;             p += stride;
+    fleet->V_ref_lower = p;             p += stride;
+    fleet->Kp_upper = p;                p += stride;
+    fleet->Ki_upper = p;                p += stride;
+    fleet->Kp_lower = p;                p += stride;
+    fleet->Ki_lower = p;                p += stride;
+    fleet->P_step_max = p;              p += stride;
+    fleet->P_charge_max = p;            p += stride;
+    fleet->P_discharge_max = p;         p += stride;
+    fleet->SOC_max = p;                 p += stride;
+    fleet->SOC_min = p;                 p += stride;
+    fleet->SOC_charge_knee = p;         p += stride;
+    fleet->SOC_discharge_knee = p;      p += stride;
+
+    for (size_t i = 0; i < stride; i++) {
+        fleet->valid[i] = 1;
+    }
+    SOC_DeratingCurve_Default(&fleet->curve);
+    fleet->count = count;
+    fleet->stride = stride;
+    fleet->block = block;
+    return 0;
+}
+
+void VoltageFleet_Free(VoltageFleet *fleet) {
+    free(fleet->block);
+    memset(fleet, 0, sizeof(*fleet));
+}
+
+void VoltageFleet_SetConfig(VoltageFleet *fleet, size_t index, const CompiledConfig *cfg) {
+    fleet->V_upper_edge[index] = cfg->V_upper_edge;
+    fleet->V_lower_edge[index] = cfg->V_lower_edge;
+    fleet->V_enter_lower[index] = cfg->V_enter_lower;
+    fleet->V_ref_upper[index] = cfg->params.V_ref_upper;
+    fleet->V_ref_lower[index] = cfg->params.V_ref_lower;
+    fleet->Kp_upper[index] = cfg->Kp_upper;
+    fleet->Ki_upper[index] = cfg->Ki_upper;
+    fleet->Kp_lower[index] = cfg->Kp_lower;
+    fleet->Ki_lower[index] = cfg->Ki_lower;
+    fleet->P_step_max[index] = cfg->P_step_max;
+    fleet->P_charge_max[index] = cfg->P_charge_max;
+    fleet->P_discharge_max[index] = cfg->P_discharge_max;
+    fleet->SOC_max[index] = cfg->SOC_max;
+    fleet->SOC_min[index] = cfg->SOC_min;
+    fleet->SOC_charge_knee[index] = cfg->SOC_charge_knee;
+    fleet->SOC_discharge_knee[index] = cfg->SOC_discharge_knee;
+}
+
+void VoltageFleet_SetCurve(VoltageFleet *fleet, const SOC_DeratingCurve *curve) {
+    fleet->curve = *curve;
+}
+
+void VoltageFleet_SetMeasurement(VoltageFleet *fleet, size_t index, const SystemStatus_RealTime *status) {
+    fleet->V_meas[index] = status->V_meas;
+    fleet->SOC[index] = status->SOC;
+    fleet->P_meas[index] = status->P_meas;
+}
+
+void VoltageFleet_SetValid(VoltageFleet *fleet, size_t index, int valid) {
+    fleet->valid[index] = valid ? 1 : 0;
+}
+
+// SOC功率限制缩放内核：降额系数乘以PCS额定功率，并与额定功率取小得到合成限值
+static void SOCLimits_Scale_Kernel(size_t n,
+                                   const float *__restrict p_charge_max,
+                                   const float *__restrict p_discharge_max,
+                                   float *__restrict charge_limit,
+                                   float *__restrict discharge_limit) {
+    for (size_t i = 0; i < n; i++) {
+        charge_limit[i] = Min_f(Max_f(p_charge_max[i] * charge_limit[i], 0.0f), p_charge_max[i]);
+        discharge_limit[i] = Min_f(Max_f(p_discharge_max[i] * discharge_limit[i], 0.0f), p_discharge_max[i]);
+    }
+}
+
+// 模式判断与双向PI批量内核：两个分支都计算，最后按模式选择，循环体内没有分支
+static void Control_Kernel(size_t n,
+                           const float *__restrict v_meas,
+                           const float *__restrict p_meas,
+                           const float *__restrict soc_charge_limit,
+                           const float *__restrict soc_discharge_limit,
+                           const float *__restrict v_upper_edge,
+                           const float *__restrict v_lower_edge,
+                           const float *__restrict v_enter_lower,
+                           const float *__restrict kp_upper,
+                           const float *__restrict ki_upper,
+                           const float *__restrict kp_lower,
+                           const float *__restrict ki_lower,
+                           const float *__restrict p_step_max,
+                           const int32_t *__restrict valid,
+                           int32_t *__restrict ctrl_mode,
+                           float *__restrict integral_upper,
+                           float *__restrict integral_lower,
+                           float *__restrict p_cmd) {
+    for (size_t i = 0; i < n; i++) {
+        // 先无条件读入本台区数据，避免条件读内存阻止向量化
+        float v = v_meas[i];
+        float p = p_meas[i];
+        float upper_edge = v_upper_edge[i];
+        float lower_edge = v_lower_edge[i];
+        float iu = integral_upper[i];
+        float il = integral_lower[i];
+        int32_t mode = ctrl_mode[i];
+        float held_cmd = p_cmd[i];
+        int32_t update = valid[i];
+
+        // 1. 模式判断(对应Determine_CtrlMode)，用32位掩码按位运算代替短路求值
+        int32_t over = v > upper_edge;
+        int32_t in_lower = (v < lower_edge) & (v > v_enter_lower[i]);
+        int32_t under = (over ^ 1) & in_lower;
+        int32_t active = over | under;
+
+        // 2. 过压分支(对应Calculate_OverVoltage_Control)
+        float err_up = Max_f(v - upper_edge, 0.0f);
+        float int_up = iu + err_up * ki_upper[i];
+        float calc_up = Min_f(err_up * kp_upper[i] + int_up, p_step_max[i]);
+        float cmd_up = calc_up + p;
+        cmd_up = Min_f(cmd_up, soc_charge_limit[i]);     // 合成限值，已含P_charge_max
+        cmd_up = Max_f(cmd_up, 0.0f);
+
+        // 3. 欠压分支(对应Calculate_UnderVoltage_Control)
+        float err_lo = Max_f(lower_edge - v, 0.0f);
+        float int_lo = il + err_lo * ki_lower[i];
+        float calc_lo = Min_f(err_lo * kp_lower[i] + int_lo, p_step_max[i]);
+        float cmd_lo = p - calc_lo;
+        float capacity = soc_discharge_limit[i];         // 合成限值，已含P_discharge_max
+        cmd_lo = cmd_lo > 0.0f ? 0.0f : (cmd_lo < -capacity ? -capacity : cmd_lo);
+
+        // 4. 按模式选择输出；正常模式清零两个积分器，控制模式只更新本侧积分器；
+        //    测量值不可用(update为0)的台区冻结，模式、积分器与指令保持上一周期
+        int32_t hold = update ^ 1;
+        int32_t apply = active & update;
+        float new_iu = over ? int_up : iu;
+        float new_il = under ? int_lo : il;
+        float cmd = over ? cmd_up : cmd_lo;
+        float idle_iu = hold ? iu : 0.0f;
+        float idle_il = hold ? il : 0.0f;
+        float idle_cmd = hold ? held_cmd : 0.0f;
+        integral_upper[i] = apply ? new_iu : idle_iu;
+        integral_lower[i] = apply ? new_il : idle_il;
+        p_cmd[i] = apply ? cmd : idle_cmd;
+        ctrl_mode[i] = mode + update * (over + 2 * under - mode);
+    }
+}
+
+void VoltageFleet_ComputeSOCLimits(VoltageFleet *fleet) {
+    // 先把降额系数写入限值数组(余弦曲线走SIMD内核)，再原地乘以额定功率
+    SOC_DeratingCurve_EvalBatch(&fleet->curve, fleet->count, fleet->SOC, fleet->SOC_max, fleet->SOC_min,
+                                fleet->SOC_charge_knee, fleet->SOC_discharge_knee,
+                                fleet->P_soc_charge_limit, fleet->P_soc_discharge_limit);
+    SOCLimits_Scale_Kernel(fleet->count, fleet->P_charge_max, fleet->P_discharge_max,
+                           fleet->P_soc_charge_limit, fleet->P_soc_discharge_limit);
+}
+
+void VoltageFleet_ComputeControl(VoltageFleet *fleet) {
+    Control_Kernel(fleet->count, fleet->V_meas, fleet->P_meas,
+                   fleet->P_soc_charge_limit, fleet->P_soc_discharge_limit,
+                   fleet->V_upper_edge, fleet->V_lower_edge, fleet->V_enter_lower,
+                   fleet->Kp_upper, fleet->Ki_upper, fleet->Kp_lower, fleet->Ki_lower,
+                   fleet->P_step_max, fleet->valid,
+                   fleet->Ctrl_Mode, fleet->integral_upper, fleet->integral_lower, fleet->P_cmd);
+}
+
+void VoltageFleet_Step(VoltageFleet *fleet) {
+    VoltageFleet_ComputeSOCLimits(fleet);
+    VoltageFleet_ComputeControl(fleet);
+}
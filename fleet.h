@@ -0,0 +1,126 @@
+/*
+ * 文件：fleet.h
+ * 功能：结构数组(SoA)布局的多台区批量控制引擎
+ *
+ * 功能描述：
+ * 1. 将N个台区的测量值、控制器状态与配置参数按字段存放为连续数组
+ * 2. 模式判断、过压/欠压PI计算在整批数据上以无分支方式执行，便于编译器向量化
+ * 3. 模式与PI计算结果与逐台区调用VoltageController_Compute完全一致；
+ *    SOC功率限值由降额曲线批量计算(余弦曲线走SIMD内核)，误差界见soc_limits.h
+ */
+
+#ifndef VOLTAGE_CONTROL_FLEET_H
+#define VOLTAGE_CONTROL_FLEET_H
+
+#include <cstddef>
+#include <cstdint>
+#include "voltage_control.h"
+
+/* ---------- 批量控制引擎(结构数组) ---------- */
+typedef struct {
+    size_t count;                   // 台区数量
+    size_t stride;                  // 每个数组的分配长度(按向量宽度对齐)
+
+    // 实时测量与SOC限值
+    float *V_meas;                  // 实时电压测量值
+    float *SOC;                     // 当前SOC
+    float *P_meas;                  // PCS当前功率，正为充电，负为放电
+    float *P_soc_charge_limit;      // 基于SOC的最大允许充电功率(已与PCS额定功率取小)
+    float *P_soc_discharge_limit;   // 基于SOC的最大允许放电功率(已与PCS额定功率取小)
+    int32_t *valid;                 // 本周期测量值可用为1(初始化时全为1)；为0的台区冻结模式、积分器与指令
+
+    // 控制器状态与输出
+    int32_t *Ctrl_Mode;             // 控制模式: 0-正常, 1-过压, 2-欠压
+    float *integral_upper;          // 过压PI积分项
+    float *integral_lower;          // 欠压PI积分项
+    float *P_cmd;                   // 有功功率指令
+
+    // 每台区配置参数(取自编译后的配置，死区边界已预先算好)
+    float *V_upper_edge;            // V_ref_upper + Deadband_upper
+    float *V_lower_edge;            // V_ref_lower - Deadband_lower
+    float *V_enter_lower;           // 电压进入门槛
+    float *V_ref_upper;             // 电压上限设定值(不计死区)，仅用于统计
+    float *V_ref_lower;             // 电压下限设定值(不计死区)，仅用于统计
+    float *Kp_upper;
+    float *Ki_upper;
+    float *Kp_lower;
+    float *Ki_lower;
+    float *P_step_max;
+    float *P_charge_max;
+    float *P_discharge_max;
+    float *SOC_max;
+    float *SOC_min;
+    float *SOC_charge_knee;         // SOC_max - 充电过渡宽度
+    float *SOC_discharge_knee;      // SOC_min + 放电过渡宽度
+
+    SOC_DeratingCurve curve;        // 全体台区共用的SOC降额曲线
+
+    void *block;                    // 所有数组共用的一次性内存分配
+} VoltageFleet;
+
+/**
+ * @brief 为count个台区分配批量引擎，状态与测量值清零
+ * @param fleet 批量引擎
+ * @param count 台区数量
+ * @return int 成功返回0，失败返回-1
+ */
+int VoltageFleet_Init(VoltageFleet *fleet, size_t count);
+
+/**
+ * @brief 释放批量引擎
+ * @param fleet 批量引擎
+ */
+void VoltageFleet_Free(VoltageFleet *fleet);
+
+/**
+ * @brief 设置第index个台区的配置参数
+ * @param fleet 批量引擎
+ * @param index 台区下标
+ * @param cfg 编译后的配置
+ */
+void VoltageFleet_SetConfig(VoltageFleet *fleet, size_t index, const CompiledConfig *cfg);
+
+/**
+ * @brief 设置全体台区共用的SOC降额曲线(初始化时为默认余弦曲线)
+ *
+ * 平台区拐点取自VoltageFleet_SetConfig写入的编译后配置，配置应按同一曲线编译
+ * @param fleet 批量引擎
+ * @param curve 降额曲线
+ */
+void VoltageFleet_SetCurve(VoltageFleet *fleet, const SOC_DeratingCurve *curve);
+
+/**
+ * @brief 写入第index个台区本周期的测量值(V_meas、SOC、P_meas)
+ * @param fleet 批量引擎
+ * @param index 台区下标
+ * @param status 测量值
+ */
+void VoltageFleet_SetMeasurement(VoltageFleet *fleet, size_t index, const SystemStatus_RealTime *status);
+
+/**
+ * @brief 标记第index个台区本周期的测量值是否可用，不可用的台区在VoltageFleet_ComputeControl中保持原状态
+ * @param fleet 批量引擎
+ * @param index 台区下标
+ * @param valid 可用为1，否则为0
+ */
+void VoltageFleet_SetValid(VoltageFleet *fleet, size_t index, int valid);
+
+/**
+ * @brief 对整批台区计算基于SOC的充放电功率限制
+ * @param fleet 批量引擎
+ */
+void VoltageFleet_ComputeSOCLimits(VoltageFleet *fleet);
+
+/**
+ * @brief 对整批台区执行模式判断与过压/欠压PI计算(无分支)，valid为0的台区不更新
+ * @param fleet 批量引擎
+ */
+void VoltageFleet_ComputeControl(VoltageFleet *fleet);
+
+/**
+ * @brief 对整批台区执行一个控制周期：SOC限值 + 模式判断 + PI计算
+ * @param fleet 批量引擎
+ */
+void VoltageFleet_Step(VoltageFleet *fleet);
+
+#endif // VOLTAGE_CONTROL_FLEET_H
@@ -0,0 +1,401 @@
+/*
+ * 文件：fleet_config.cpp
+ * 功能：多站点配置文件加载实现
+ */
+
+#include "fleet_config.h"
+#include "config_schema.h"
+#include "mapped_file.h"
+#include "parallel_for.h"
+
+#include <climits>
+#include <cstdarg>
+#include <cstdlib>
+#include <cstring>
+
+#define FLEET_ERROR_LEN 256             // 单条错误信息最大长度
+#define FLEET_DEFAULTS_ID -1            // [defaults]块的编号
+
+/* ---------- 文件中的一个块(标题行之后到下一个标题行之前) ---------- */
+typedef struct {
+    const char *begin;
+    const char *end;
+    int line;                           // 块内第一行的行号
+    int header_line;                    // 标题行的行号
+    int site_id;                        // 站点编号，[defaults]为FLEET_DEFAULTS_ID
+} FleetBlock;
+
+// 内存不足时返回的错误信息(静态存储，不释放)
+static char FLEET_OUT_OF_MEMORY[] = "内存分配失败";
+
+// 格式化一条错误信息(堆上分配，由调用者用Fleet_FreeError释放)；分配失败时返回FLEET_OUT_OF_MEMORY，
+// 保证出错时返回值不为NULL
+static char *Fleet_Error(const char *fmt, ...) {
+    char *message = (char *)malloc(FLEET_ERROR_LEN);
+    if (!message) {
+        return FLEET_OUT_OF_MEMORY;
+    }
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(message, FLEET_ERROR_LEN, fmt, args);
+    va_end(args);
+    return message;
+}
+
+// 释放Fleet_Error返回的错误信息
+static void Fleet_FreeError(char *message) {
+    if (message != FLEET_OUT_OF_MEMORY) {
+        free(message);
+    }
+}
+
+static int Fleet_IsSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+// 去掉行尾注释与首尾空白，结果为[*begin, *end)
+static void Fleet_TrimLine(const char **begin, const char **end) {
+    const char *b = *begin;
+    const char *e = *end;
+    for (const char *p = b; p < e; p++) {
+        if (*p == '#' || *p == ';') {
+            e = p;
+            break;
+        }
+    }
+    while (b < e && Fleet_IsSpace(*b)) {
+        b++;
+    }
+    while (e > b && Fleet_IsSpace(e[-1])) {
+        e--;
+    }
+    *begin = b;
+    *end = e;
+}
+
+// 解析标题行[defaults]或[site N]，成功返回0
+static int Fleet_ParseHeader(const char *begin, const char *end, int *site_id) {
+    if (end - begin < 2 || end[-1] != ']') {
+        return -1;
+    }
+    begin++;
+    end--;
+    while (begin < end && Fleet_IsSpace(*begin)) {
+        begin++;
+    }
+    while (end > begin && Fleet_IsSpace(end[-1])) {
+        end--;
+    }
+    if (end - begin == 8 && memcmp(begin, "defaults", 8) == 0) {
+        *site_id = FLEET_DEFAULTS_ID;
+        return 0;
+    }
+    if (end - begin < 6 || memcmp(begin, "site", 4) != 0 || !Fleet_IsSpace(begin[4])) {
+        return -1;
+    }
+    begin += 5;
+    while (begin < end && Fleet_IsSpace(*begin)) {
+        begin++;
+    }
+    long long id = 0;
+    if (begin == end) {
+        return -1;
+    }
+    for (; begin < end; begin++) {
+        if (*begin < '0' || *begin > '9') {
+            return -1;
+        }
+        id = id * 10 + (*begin - '0');
+        if (id > INT_MAX) {
+            return -1;
+        }
+    }
+    *site_id = (int)id;
+    return 0;
+}
+
+// 解析块内的"键 = 值"行，写入cfg并在seen中标记；成功返回NULL，否则返回错误信息
+static char *Fleet_ParseBlock(const FleetBlock *block, const char *filename, SystemConfig_Cfg *cfg,
+                              unsigned char *seen) {
+    unsigned char here[CONFIG_SCHEMA_FIELD_COUNT] = {0};
+    int line = block->line;
+    for (const char *p = block->begin; p < block->end; line++) {
+        const char *newline = (const char *)memchr(p, '\n', (size_t)(block->end - p));
+        const char *line_end = newline ? newline : block->end;
+        const char *b = p;
+        const char *e = line_end;
+        p = newline ? newline + 1 : block->end;
+        Fleet_TrimLine(&b, &e);
+        if (b == e) {
+            continue;
+        }
+
+        const char *eq = (const char *)memchr(b, '=', (size_t)(e - b));
+        if (!eq) {
+            return Fleet_Error("配置文件%s第%d行应为\"键 = 值\"", filename, line);
+        }
+        const char *key_end = eq;
+        while (key_end > b && Fleet_IsSpace(key_end[-1])) {
+            key_end--;
+        }
+        const char *value = eq + 1;
+        while (value < e && Fleet_IsSpace(*value)) {
+            value++;
+        }
+        int key_len = (int)(key_end - b);
+
+        const ConfigSchemaField *field = ConfigSchema_Find(b, (size_t)key_len);
+        if (!field) {
+            return Fleet_Error("配置文件%s第%d行未知的参数%.*s", filename, line, key_len, b);
+        }
+        int index = (int)(field - CONFIG_SCHEMA);
+        if (here[index]) {
+            return Fleet_Error("配置文件%s第%d行参数%s在同一块中重复", filename, line, field->name);
+        }
+
+        // 映射区不以'\0'结尾，数值先复制出来再转换
+        char text[FLEET_CONFIG_VALUE_MAX];
+        size_t value_len = (size_t)(e - value);
+        char *text_end = NULL;
+        double number = 0.0;
+        if (value_len > 0 && value_len < sizeof(text)) {
+            memcpy(text, value, value_len);
+            text[value_len] = '\0';
+            number = strtod(text, &text_end);
+        }
+        if (!text_end || text_end != text + value_len) {
+            return Fleet_Error("配置文件%s第%d行%s应为数值", filename, line, field->name);
+        }
+        if (ConfigSchema_Store(cfg, field, number) != 0) {
+            return Fleet_Error("配置文件%s第%d行%s=%g超出范围[%g, %g]", filename, line, field->name, number,
+                               field->min, field->max);
+        }
+        here[index] = 1;
+        seen[index] = 1;
+    }
+    return NULL;
+}
+
+// 检查站点配置完整且参数之间关系合理，成功返回NULL，否则返回错误信息
+static char *Fleet_CheckSite(const FleetBlock *block, const char *filename, const SystemConfig_Cfg *cfg,
+                             const unsigned char *seen) {
+    char missing[FLEET_ERROR_LEN] = "";
+    size_t used = 0;
+    for (int i = 0; i < CONFIG_SCHEMA_FIELD_COUNT; i++) {
+        if (!seen[i] && used + 1 < sizeof(missing)) {
+            used += (size_t)snprintf(missing + used, sizeof(missing) - used, "%s%s", used ? "、" : "",
+                                     CONFIG_SCHEMA[i].name);
+        }
+    }
+    if (used > 0) {
+        return Fleet_Error("配置文件%s第%d行站点%d缺少%s(默认值与本站点均未给出)", filename,
+                           block->header_line, block->site_id, missing);
+    }
+    const char *problem = ConfigSchema_CheckRelations(cfg);
+    if (problem) {
+        return Fleet_Error("配置文件%s第%d行站点%d: %s", filename, block->header_line, block->site_id, problem);
+    }
+    return NULL;
+}
+
+// 顺序扫描找出全部块，成功返回0
+static int Fleet_FindBlocks(const MappedFile *file, const char *filename, FleetBlock **blocks_out,
+                            size_t *count_out) {
+    FleetBlock *blocks = NULL;
+    size_t count = 0;
+    size_t capacity = 0;
+    const char *p = file->data;
+    const char *end = file->data + file->size;
+    int line = 1;
+
+    for (; p < end; line++) {
+        const char *newline = (const char *)memchr(p, '\n', (size_t)(end - p));
+        const char *line_end = newline ? newline : end;
+        const char *b = p;
+        const char *e = line_end;
+        const char *line_start = p;
+        p = newline ? newline + 1 : end;
+        Fleet_TrimLine(&b, &e);
+        if (b == e) {
+            continue;
+        }
+        if (*b != '[') {
+            if (count == 0) {
+                fprintf(stderr, "错误: 配置文件%s第%d行不在任何[defaults]或[site 编号]块中\n", filename, line);
+                free(blocks);
+                return -1;
+            }
+            continue;   // 键值行留给各块解析时处理
+        }
+
+        int site_id;
+        if (Fleet_ParseHeader(b, e, &site_id) != 0) {
+            fprintf(stderr, "错误: 配置文件%s第%d行块标题应为[defaults]或[site 编号]\n", filename, line);
+            free(blocks);
+            return -1;
+        }
+        if (site_id == FLEET_DEFAULTS_ID && count > 0) {
+            fprintf(stderr, "错误: 配置文件%s第%d行[defaults]块必须位于文件开头且只能有一个\n", filename, line);
+            free(blocks);
+            return -1;
+        }
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            FleetBlock *grown = (FleetBlock *)realloc(blocks, capacity * sizeof(FleetBlock));
+            if (!grown) {
+                fprintf(stderr, "错误: 内存分配失败\n");
+                free(blocks);
+                return -1;
+            }
+            blocks = grown;
+        }
+        if (count > 0) {
+            blocks[count - 1].end = line_start;
+        }
+        blocks[count].begin = p;
+        blocks[count].end = end;
+        blocks[count].line = line + 1;
+        blocks[count].header_line = line;
+        blocks[count].site_id = site_id;
+        count++;
+    }
+
+    *blocks_out = blocks;
+    *count_out = count;
+    return 0;
+}
+
+static int Fleet_CompareSite(const void *a, const void *b) {
+    const FleetBlock *x = *(const FleetBlock *const *)a;
+    const FleetBlock *y = *(const FleetBlock *const *)b;
+    if (x->site_id != y->site_id) {
+        return x->site_id < y->site_id ? -1 : 1;
+    }
+    return x->header_line < y->header_line ? -1 : 1;
+}
+
+// 检查站点编号不重复，成功返回0
+static int Fleet_CheckDuplicates(const FleetBlock *sites, size_t count, const char *filename) {
+    const FleetBlock **sorted = (const FleetBlock **)malloc(count * sizeof(const FleetBlock *));
+    if (!sorted) {
+        fprintf(stderr, "错误: 内存分配失败\n");
+        return -1;
+    }
+    for (size_t i = 0; i < count; i++) {
+        sorted[i] = &sites[i];
+    }
+    qsort(sorted, count, sizeof(const FleetBlock *), Fleet_CompareSite);
+    int ret = 0;
+    for (size_t i = 1; i < count; i++) {
+        if (sorted[i]->site_id == sorted[i - 1]->site_id) {
+            fprintf(stderr, "错误: 配置文件%s第%d行站点%d与第%d行重复\n", filename, sorted[i]->header_line,
+                    sorted[i]->site_id, sorted[i - 1]->header_line);
+            ret = -1;
+            break;
+        }
+    }
+    free(sorted);
+    return ret;
+}
+
+int FleetConfig_Load(FleetConfig *fleet, const char *filename, int threads) {
+    memset(fleet, 0, sizeof(*fleet));
+    MappedFile file;
+    if (MappedFile_Open(&file, filename) != 0) {
+        return -1;
+    }
+
+    // 1. 顺序扫描标题行，确定各块位置
+    FleetBlock *blocks = NULL;
+    size_t block_count = 0;
+    if (Fleet_FindBlocks(&file, filename, &blocks, &block_count) != 0) {
+        MappedFile_Close(&file);
+        return -1;
+    }
+    int has_defaults = block_count > 0 && blocks[0].site_id == FLEET_DEFAULTS_ID;
+    const FleetBlock *sites = blocks + has_defaults;
+    size_t site_count = block_count - (size_t)has_defaults;
+    if (site_count == 0) {
+        fprintf(stderr, "错误: 配置文件%s中没有任何[site 编号]块\n", filename);
+        free(blocks);
+        MappedFile_Close(&file);
+        return -1;
+    }
+    if (Fleet_CheckDuplicates(sites, site_count, filename) != 0) {
+        free(blocks);
+        MappedFile_Close(&file);
+        return -1;
+    }
+
+    // 2. 解析默认值
+    SystemConfig_Cfg defaults;
+    memset(&defaults, 0, sizeof(defaults));
+    unsigned char defaults_seen[CONFIG_SCHEMA_FIELD_COUNT] = {0};
+    if (has_defaults) {
+        char *error = Fleet_ParseBlock(&blocks[0], filename, &defaults, defaults_seen);
+        if (error) {
+            fprintf(stderr, "错误: %s\n", error);
+            Fleet_FreeError(error);
+            free(blocks);
+            MappedFile_Close(&file);
+            return -1;
+        }
+    }
+
+    // 3. 各站点块并行解析，每个站点只写自己下标对应的结果
+    fleet->site_ids = (int *)malloc(site_count * sizeof(int));
+    fleet->cfgs = (CompiledConfig *)malloc(site_count * sizeof(CompiledConfig));
+    char **errors = (char **)calloc(site_count, sizeof(char *));
+    if (!fleet->site_ids || !fleet->cfgs || !errors) {
+        fprintf(stderr, "错误: 内存分配失败\n");
+        free(errors);
+        FleetConfig_Free(fleet);
+        free(blocks);
+        MappedFile_Close(&file);
+        return -1;
+    }
+    ParallelFor(site_count, threads, [&](size_t i) {
+        SystemConfig_Cfg cfg = defaults;
+        unsigned char seen[CONFIG_SCHEMA_FIELD_COUNT];
+        memcpy(seen, defaults_seen, sizeof(seen));
+        char *error = Fleet_ParseBlock(&sites[i], filename, &cfg, seen);
+        if (!error) {
+            error = Fleet_CheckSite(&sites[i], filename, &cfg, seen);
+        }
+        fleet->site_ids[i] = sites[i].site_id;
+        CompiledConfig_Build(&fleet->cfgs[i], &cfg, NULL);
+        errors[i] = error;
+    });
+
+    // 4. 按站点顺序报告错误
+    size_t failed = 0;
+    for (size_t i = 0; i < site_count; i++) {
+        if (errors[i]) {
+            if (failed < FLEET_CONFIG_MAX_ERRORS) {
+                fprintf(stderr, "错误: %s\n", errors[i]);
+            }
+            failed++;
+            Fleet_FreeError(errors[i]);
+        }
+    }
+    if (failed > FLEET_CONFIG_MAX_ERRORS) {
+        fprintf(stderr, "错误: 另有%zu个站点配置有误，未逐一列出\n", failed - FLEET_CONFIG_MAX_ERRORS);
+    }
+    free(errors);
+    free(blocks);
+    MappedFile_Close(&file);
+    if (failed > 0) {
+        FleetConfig_Free(fleet);
+        return -1;
+    }
+    fleet->count = site_count;
+    return 0;
+}
+
+void FleetConfig_Free(FleetConfig *fleet) {
+    free(fleet->site_ids);
+    free(fleet->cfgs);
+    fleet->site_ids = NULL;
+    fleet->cfgs = NULL;
+    fleet->count = 0;
+}
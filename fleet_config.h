@@ -0,0 +1,54 @@
+/*
+ * 文件：fleet_config.h
+ * 功能：多站点配置文件(.fleet)加载
+ *
+ * 功能描述：
+ * 1. 一个文件描述全部台区：[defaults]块给出公共参数，每个[site 编号]块可以覆盖
+ *    SystemConfig_Cfg中的任意参数，未覆盖的参数取默认值；第i个[site]块对应第i个台区
+ * 2. 块内每行一个"键 = 值"，键名按字段表(见config_schema.h)查找并检查取值范围；
+ *    以#或;开头的行及行尾的#、;之后为注释
+ * 3. 文件以只读方式映射到内存，先顺序扫描一遍找出各块的位置，再把各站点块分给多个线程并行解析；
+ *    错误按站点顺序报告(附行号)，报告顺序与线程数无关
+ * 4. 各站点配置在解析线程中直接编译(CompiledConfig)，.fleet不含曲线参数，按默认降额曲线编译
+ *
+ * 示例：
+ *   [defaults]
+ *   V_ref_upper = 241.0
+ *   ...
+ *   [site 1]
+ *   Kp_upper = 6.0       # 该站点单独调整
+ *   [site 2]
+ */
+
+#ifndef VOLTAGE_CONTROL_FLEET_CONFIG_H
+#define VOLTAGE_CONTROL_FLEET_CONFIG_H
+
+#include <cstddef>
+#include "voltage_control.h"
+
+#define FLEET_CONFIG_MAX_ERRORS 20      // 最多报告的出错站点数，其余只计数
+#define FLEET_CONFIG_VALUE_MAX 64       // 数值文本最大长度
+
+/* ---------- 多站点配置 ---------- */
+typedef struct {
+    size_t count;                       // 站点数
+    int *site_ids;                      // 各站点编号([site N]中的N)，按文件中出现的顺序
+    CompiledConfig *cfgs;               // 各站点编译后的配置，参数 = 默认值 + 本站点覆盖项
+} FleetConfig;
+
+/**
+ * @brief 加载多站点配置文件
+ * @param fleet [输出] 多站点配置，用完后以FleetConfig_Free释放
+ * @param filename 文件名
+ * @param threads 解析线程数，小于1时使用全部硬件线程
+ * @return int 成功返回0，失败返回-1(已输出错误信息)
+ */
+int FleetConfig_Load(FleetConfig *fleet, const char *filename, int threads);
+
+/**
+ * @brief 释放多站点配置，对全零的结构调用也是安全的
+ * @param fleet 多站点配置
+ */
+void FleetConfig_Free(FleetConfig *fleet);
+
+#endif // VOLTAGE_CONTROL_FLEET_CONFIG_H
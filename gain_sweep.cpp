@@ -0,0 +1,259 @@
+/*
+ * 文件：gain_sweep.cpp
+ * 功能：PI增益网格扫描实现
+ */
+
+#include "gain_sweep.h"
+#include "grid_model.h"
+#include "parallel_for.h"
+#include "simulation.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+const char *const GAIN_SWEEP_PARAM_NAMES[GAIN_SWEEP_PARAM_COUNT] = {
+    "Kp_upper", "Ki_upper", "Kp_lower", "Ki_lower", "P_step_max"
+};
+
+const char *const GAIN_SWEEP_RANK_NAMES[4] = {"violation", "overshoot", "settling", "energy"};
+
+// 按GAIN_SWEEP_PARAM_NAMES顺序访问配置中的各参数
+static float *Config_At(SystemConfig_Cfg *cfg, int i) {
+    float *items[GAIN_SWEEP_PARAM_COUNT] = {
+        &cfg->Kp_upper, &cfg->Ki_upper, &cfg->Kp_lower, &cfg->Ki_lower, &cfg->P_step_max
+    };
+    return items[i];
+}
+
+void GainSweep_DefaultOptions(GainSweepOptions *options, const SystemConfig_Cfg *cfg) {
+    memset(options, 0, sizeof(*options));
+    SystemConfig_Cfg copy = *cfg;
+    for (int i = 0; i < GAIN_SWEEP_PARAM_COUNT; i++) {
+        float value = *Config_At(&copy, i);
+        options->axes[i] = {value, value, 1};
+    }
+}
+
+int GainSweep_ParseAxis(const char *spec, int *param, GainSweepAxis *result) {
+    const char *eq = strchr(spec, '=');
+    *param = -1;
+    for (int i = 0; eq && i < GAIN_SWEEP_PARAM_COUNT; i++) {
+        size_t len = strlen(GAIN_SWEEP_PARAM_NAMES[i]);
+        if ((size_t)(eq - spec) == len && strncmp(spec, GAIN_SWEEP_PARAM_NAMES[i], len) == 0) {
+            *param = i;
+        }
+    }
+    if (*param < 0) {
+        fprintf(stderr, "错误: 扫描参数%s无效，应为 名称=下限:上限:点数，名称可为"
+                        "Kp_upper/Ki_upper/Kp_lower/Ki_lower/P_step_max\n", spec);
+        return -1;
+    }
+
+    char *end;
+    GainSweepAxis axis;
+    axis.lo = strtof(eq + 1, &end);
+    axis.hi = axis.lo;
+    axis.points = 1;
+    int ok = end != eq + 1;
+    if (ok && *end == ':') {
+        const char *p = end + 1;
+        axis.hi = strtof(p, &end);
+        ok = end != p && *end == ':';
+        if (ok) {
+            p = end + 1;
+            unsigned long points = strtoul(p, &end, 10);
+            ok = end != p && points >= 1 && points <= 100000;
+            axis.points = (uint32_t)points;
+        }
+    }
+    if (!ok || *end != '\0' || !(axis.lo >= 0.0f) || !(axis.hi >= axis.lo)) {
+        fprintf(stderr, "错误: 扫描参数%s格式错误，应为 名称=下限:上限:点数 且 0<=下限<=上限\n", spec);
+        return -1;
+    }
+    *result = axis;
+    return 0;
+}
+
+int GainSweep_ParseRank(const char *name) {
+    for (int i = 0; i < 4; i++) {
+        if (strcmp(name, GAIN_SWEEP_RANK_NAMES[i]) == 0) {
+            return i;
+        }
+    }
+    fprintf(stderr, "错误: 排序指标%s无效，可用violation/overshoot/settling/energy\n", name);
+    return -1;
+}
+
+uint64_t GainSweep_Count(const GainSweepOptions *options) {
+    uint64_t count = 1;
+    for (int i = 0; i < GAIN_SWEEP_PARAM_COUNT; i++) {
+        count *= options->axes[i].points;
+        if (count > GAIN_SWEEP_MAX_COMBINATIONS) {
+            return count; // 调用者按上限报错，避免继续相乘溢出
+        }
+    }
+    return count;
+}
+
+// 组合编号按混合进制展开为各参数的取值，最后一个参数变化最快
+static void GainSweep_MakeGains(const GainSweepOptions *options, uint64_t index, float *gains) {
+    for (int i = GAIN_SWEEP_PARAM_COUNT - 1; i >= 0; i--) {
+        const GainSweepAxis *axis = &options->axes[i];
+        uint32_t k = (uint32_t)(index % axis->points);
+        index /= axis->points;
+        gains[i] = axis->points > 1 ? axis->lo + (axis->hi - axis->lo) * (float)k / (float)(axis->points - 1)
+                                    : axis->lo;
+    }
+}
+
+// 仿真一个组合
+static int GainSweep_RunOne(const SystemConfig_Cfg *base_cfg, const SOC_DeratingCurve *curve,
+                            const GainSweepOptions *options, uint64_t index,
+                            const volatile sig_atomic_t *stop_flag, GainSweepResult *result) {
+    result->index = index;
+    GainSweep_MakeGains(options, index, result->gains);
+    SystemConfig_Cfg cfg = *base_cfg;
+    for (int i = 0; i < GAIN_SWEEP_PARAM_COUNT; i++) {
+        *Config_At(&cfg, i) = result->gains[i];
+    }
+
+    GridModel grid;
+    if (options->grid && GridModel_Clone(&grid, options->grid) != 0) {
+        return -1;
+    }
+    VoltageController *ctrls = (VoltageController *)calloc(options->areas, sizeof(VoltageController));
+    if (!ctrls) {
+        fprintf(stderr, "错误: 内存分配失败\n");
+        if (options->grid) {
+            GridModel_Free(&grid);
+        }
+        return -1;
+    }
+    CompiledConfig compiled;
+    CompiledConfig_Build(&compiled, &cfg, curve);
+    int ret = 0;
+    for (size_t i = 0; i < options->areas && ret == 0; i++) {
+        VoltageController_Init(&ctrls[i], (int)i, &compiled, curve);
+        Simulation_Init(&ctrls[i].sim, options->seed, (uint64_t)i);
+        if (options->battery) {
+            ret = Simulation_EnableBattery(&ctrls[i].sim, options->battery);
+        }
+        if (ret == 0 && options->grid) {
+            ret = GridModel_Attach(&ctrls[i].sim, &grid, (uint32_t)i);
+        }
+    }
+
+    // 电池或电网模型挂接失败时不仿真，避免在错误的对象上扫描
+    SimulationSummary summary;
+    if (ret == 0) {
+        SimulationOptions sim_options = {options->duration_s, options->step_s, NULL, options->grid ? &grid : NULL};
+        ret = Simulation_RunControllers(ctrls, options->areas, &sim_options, stop_flag, &summary);
+    }
+    free(ctrls);
+    if (options->grid) {
+        GridModel_Free(&grid);
+    }
+    if (ret != 0) {
+        return -1;
+    }
+
+    result->violation_s = summary.time_above_upper_s + summary.time_below_lower_s;
+    result->overshoot_V = summary.overshoot_max_V;
+    result->settling_mean_s = SimulationSummary_SettlingScore(&summary);
+    result->settling_max_s = summary.settling_max_s;
+    result->unsettled = summary.unsettled_episodes;
+    result->energy_cycled_kwh = summary.energy_charge_kwh + summary.energy_discharge_kwh;
+    return 0;
+}
+
+// 排序指标的取值
+static double GainSweep_Metric(const GainSweepResult *result, int rank) {
+    switch (rank) {
+        case GAIN_SWEEP_RANK_OVERSHOOT: return result->overshoot_V;
+        case GAIN_SWEEP_RANK_SETTLING: return result->settling_mean_s;
+        case GAIN_SWEEP_RANK_ENERGY: return result->energy_cycled_kwh;
+        default: return result->violation_s;
+    }
+}
+
+int GainSweep_Run(const SystemConfig_Cfg *cfg, const SOC_DeratingCurve *curve, const GainSweepOptions *options,
+                  const volatile sig_atomic_t *stop_flag, GainSweepResult *results) {
+    uint64_t count = GainSweep_Count(options);
+    if (count > GAIN_SWEEP_MAX_COMBINATIONS || options->areas == 0 || !(options->step_s > 0.0)
+        || !(options->duration_s >= options->step_s) || options->rank < 0 || options->rank > 3) {
+        fprintf(stderr, "错误: 增益扫描参数非法 (组合数=%llu, 上限%llu, 台区数=%zu, 时长=%gs, 步长=%gs)\n",
+                (unsigned long long)count, (unsigned long long)GAIN_SWEEP_MAX_COMBINATIONS,
+                options->areas, options->duration_s, options->step_s);
+        return -1;
+    }
+    int *failed = (int *)calloc((size_t)count, sizeof(int));
+    if (!failed) {
+        fprintf(stderr, "错误: 内存分配失败\n");
+        return -1;
+    }
+
+    // 每个组合只写自己的结果槽
+    ParallelFor((size_t)count, options->threads, [&](size_t i) {
+        if (stop_flag && *stop_flag) {
+            failed[i] = 1;
+            return;
+        }
+        failed[i] = GainSweep_RunOne(cfg, curve, options, (uint64_t)i, stop_flag, &results[i]) != 0;
+    });
+
+    int ret = 0;
+    if (stop_flag && *stop_flag) {
+        fprintf(stderr, "错误: 增益扫描被中断，结果不完整，未输出\n");
+        ret = -1;
+    }
+    for (uint64_t i = 0; ret == 0 && i < count; i++) {
+        if (failed[i]) {
+            ret = -1;
+        }
+    }
+    free(failed);
+    if (ret != 0) {
+        return -1;
+    }
+
+    int rank = options->rank;
+    std::sort(results, results + count, [rank](const GainSweepResult &a, const GainSweepResult &b) {
+        double ma = GainSweep_Metric(&a, rank);
+        double mb = GainSweep_Metric(&b, rank);
+        return ma != mb ? ma < mb : a.index < b.index;
+    });
+    return 0;
+}
+
+void GainSweep_WriteCsv(const GainSweepResult *results, uint64_t count, FILE *fp) {
+    fprintf(fp, "rank,combination");
+    for (int i = 0; i < GAIN_SWEEP_PARAM_COUNT; i++) {
+        fprintf(fp, ",%s", GAIN_SWEEP_PARAM_NAMES[i]);
+    }
+    fprintf(fp, ",violation_s,overshoot_V,settling_mean_s,settling_max_s,unsettled,energy_cycled_kwh\n");
+    for (uint64_t r = 0; r < count; r++) {
+        const GainSweepResult *res = &results[r];
+        fprintf(fp, "%llu,%llu", (unsigned long long)(r + 1), (unsigned long long)res->index);
+        for (int i = 0; i < GAIN_SWEEP_PARAM_COUNT; i++) {
+            fprintf(fp, ",%.9g", res->gains[i]);
+        }
+        fprintf(fp, ",%.3f,%.4f,%.3f,%.3f,%llu,%.3f\n", res->violation_s, res->overshoot_V,
+                res->settling_mean_s, res->settling_max_s, (unsigned long long)res->unsettled,
+                res->energy_cycled_kwh);
+    }
+}
+
+void GainSweep_PrintTable(const GainSweepResult *results, uint64_t count, uint64_t rows, FILE *fp) {
+    fprintf(fp, "%5s %10s %10s %10s %10s %10s %12s %10s %10s %10s %8s %12s\n", "名次",
+            GAIN_SWEEP_PARAM_NAMES[0], GAIN_SWEEP_PARAM_NAMES[1], GAIN_SWEEP_PARAM_NAMES[2],
+            GAIN_SWEEP_PARAM_NAMES[3], GAIN_SWEEP_PARAM_NAMES[4],
+            "越限(s)", "超调(V)", "调节(s)", "最长(s)", "未稳定", "能量(kWh)");
+    for (uint64_t r = 0; r < count && r < rows; r++) {
+        const GainSweepResult *res = &results[r];
+        fprintf(fp, "%5llu %10.4g %10.4g %10.4g %10.4g %10.4g %12.1f %10.3f %10.1f %10.1f %8llu %12.2f\n",
+                (unsigned long long)(r + 1), res->gains[0], res->gains[1], res->gains[2], res->gains[3],
+                res->gains[4], res->violation_s, res->overshoot_V, res->settling_mean_s, res->settling_max_s,
+                (unsigned long long)res->unsettled, res->energy_cycled_kwh);
+    }
+}
@@ -0,0 +1,140 @@
+/*
+ * 文件：gain_sweep.h
+ * 功能：PI增益网格扫描
+ *
+ * 功能描述：
+ * 1. 对pi_controller中的四个增益与P_step_max分别给定取值区间与点数，
+ *    对全部组合逐一做闭环超实时仿真(可接入电网模型与电池模型)，多核并行执行
+ * 2. 各组合使用相同的随机种子与相同的电网模型初始状态，指标之间可直接比较
+ * 3. 每个组合输出越限时长、最大超调、调节时间与充放电能量，按指定指标排序后
+ *    以表格输出到控制台或CSV文件
+ */
+
+#ifndef VOLTAGE_CONTROL_GAIN_SWEEP_H
+#define VOLTAGE_CONTROL_GAIN_SWEEP_H
+
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include "voltage_control.h"
+
+#define GAIN_SWEEP_PARAM_COUNT 5            // 扫描参数个数
+#define GAIN_SWEEP_MAX_COMBINATIONS 10000000ULL // 组合数上限
+#define GAIN_SWEEP_CONSOLE_ROWS 20          // 未指定输出文件时控制台显示的行数
+
+struct GridModel;
+
+/* ---------- 扫描参数(下标即GAIN_SWEEP_PARAM_NAMES中的顺序) ---------- */
+typedef enum {
+    GAIN_SWEEP_KP_UPPER = 0,
+    GAIN_SWEEP_KI_UPPER = 1,
+    GAIN_SWEEP_KP_LOWER = 2,
+    GAIN_SWEEP_KI_LOWER = 3,
+    GAIN_SWEEP_P_STEP_MAX = 4
+} GainSweepParam;
+
+extern const char *const GAIN_SWEEP_PARAM_NAMES[GAIN_SWEEP_PARAM_COUNT];
+
+/* ---------- 排序指标 ---------- */
+typedef enum {
+    GAIN_SWEEP_RANK_VIOLATION = 0,      // 越限时长
+    GAIN_SWEEP_RANK_OVERSHOOT = 1,      // 最大超调
+    GAIN_SWEEP_RANK_SETTLING = 2,       // 平均调节时间
+    GAIN_SWEEP_RANK_ENERGY = 3          // 充放电能量
+} GainSweepRank;
+
+extern const char *const GAIN_SWEEP_RANK_NAMES[4];
+
+/* ---------- 单个参数的取值：区间[lo, hi]上等间距取points个点 ---------- */
+typedef struct {
+    float lo;
+    float hi;
+    uint32_t points;
+} GainSweepAxis;
+
+/* ---------- 扫描参数 ---------- */
+typedef struct {
+    GainSweepAxis axes[GAIN_SWEEP_PARAM_COUNT];
+    double duration_s;                  // 每个组合的仿真时长 (s)
+    double step_s;                      // 仿真步长 (s)
+    uint64_t seed;                      // 模拟数据源随机种子(全部组合相同)
+    size_t areas;                       // 台区数量
+    int threads;                        // 工作线程数，小于1时使用全部硬件线程
+    int rank;                           // 排序指标 GainSweepRank
+    const GridModel *grid;              // 电网模型，NULL表示开环(正弦电压)；每个组合使用独立副本
+    const BatteryParams *battery;       // 电池参数，NULL表示不启用电池模型
+} GainSweepOptions;
+
+/* ---------- 单个组合的结果 ---------- */
+typedef struct {
+    uint64_t index;                     // 组合编号
+    float gains[GAIN_SWEEP_PARAM_COUNT];
+    double violation_s;                 // 全部台区电压越出死区的时长合计 (s)
+    float overshoot_V;                  // 最大超调 (V)
+    double settling_mean_s;             // 平均调节时间 (s)，未稳定事件按持续到仿真结束计(见SimulationSummary_SettlingScore)
+    double settling_max_s;              // 已稳定事件的最长调节时间 (s)
+    uint64_t unsettled;                 // 仿真结束时仍未稳定的越限事件数
+    double energy_cycled_kwh;           // 充电与放电能量之和 (kWh)
+} GainSweepResult;
+
+/**
+ * @brief 以配置中的当前值初始化扫描参数(每个参数只有一个点)
+ * @param options [输出] 扫描参数，仿真时长、步长等其余字段由调用者填写
+ * @param cfg 基准配置
+ */
+void GainSweep_DefaultOptions(GainSweepOptions *options, const SystemConfig_Cfg *cfg);
+
+/**
+ * @brief 解析"名称=下限:上限:点数"或"名称=值"，如"Kp_upper=1:10:10"
+ * @param spec 参数字符串
+ * @param param [输出] 参数下标 GainSweepParam
+ * @param axis [输出] 取值
+ * @return int 成功返回0，格式错误返回-1
+ */
+int GainSweep_ParseAxis(const char *spec, int *param, GainSweepAxis *axis);
+
+/**
+ * @brief 解析排序指标名称(violation/overshoot/settling/energy)
+ * @param name 名称
+ * @return int GainSweepRank，名称无效返回-1
+ */
+int GainSweep_ParseRank(const char *name);
+
+/**
+ * @brief 组合总数
+ * @param options 扫描参数
+ * @return uint64_t 组合数
+ */
+uint64_t GainSweep_Count(const GainSweepOptions *options);
+
+/**
+ * @brief 并行仿真全部组合，结果按排序指标升序排列(相同时按组合编号)
+ * @param cfg 基准配置(被扫描的参数逐组合替换)
+ * @param curve SOC降额曲线
+ * @param options 扫描参数
+ * @param stop_flag 外部停止标志，置位后尽快结束并返回失败，可为NULL
+ * @param results [输出] 结果数组，长度为GainSweep_Count(options)
+ * @return int 成功返回0，参数错误、内存不足或被中断返回-1
+ */
+int GainSweep_Run(const SystemConfig_Cfg *cfg, const SOC_DeratingCurve *curve, const GainSweepOptions *options,
+                  const volatile sig_atomic_t *stop_flag, GainSweepResult *results);
+
+/**
+ * @brief 以CSV格式输出结果表(含名次)
+ * @param results 已排序的结果
+ * @param count 结果数
+ * @param fp 输出流
+ */
+void GainSweep_WriteCsv(const GainSweepResult *results, uint64_t count, FILE *fp);
+
+/**
+ * @brief 以对齐表格输出前rows个结果
+ * @param results 已排序的结果
+ * @param count 结果数
+ * @param rows 最多输出的行数
+ * @param fp 输出流
+ */
+void GainSweep_PrintTable(const GainSweepResult *results, uint64_t count, uint64_t rows, FILE *fp);
+
+#endif // VOLTAGE_CONTROL_GAIN_SWEEP_H
@@ -0,0 +1,447 @@
+/*
+ * 文件：gain_tuner.cpp
+ * 功能：PI增益与死区自动整定实现
+ */
+
+#include "gain_tuner.h"
+#include "config_schema.h"
+#include "grid_model.h"
+#include "parallel_for.h"
+#include "prng.h"
+#include "simulation.h"
+#include "cJSON.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+const char *const GAIN_TUNER_PARAM_NAMES[GAIN_TUNER_PARAM_COUNT] = {
+    "Kp_upper", "Ki_upper", "Kp_lower", "Ki_lower", "Deadband_upper", "Deadband_lower"
+};
+
+#define TUNER_DIM GAIN_TUNER_PARAM_COUNT
+
+// 单个场景的指标
+typedef struct {
+    double violation_h;
+    double overshoot_V;
+    double settling_min;
+    double energy_kwh;
+} TunerMetrics;
+
+// 按GAIN_TUNER_PARAM_NAMES顺序访问配置中的各参数
+static float *Config_At(SystemConfig_Cfg *cfg, int i) {
+    float *items[TUNER_DIM] = {
+        &cfg->Kp_upper, &cfg->Ki_upper, &cfg->Kp_lower, &cfg->Ki_lower, &cfg->Deadband_upper, &cfg->Deadband_lower
+    };
+    return items[i];
+}
+
+void GainTuner_DefaultWeights(GainTunerWeights *weights) {
+    weights->violation = 1.0;
+    weights->overshoot = 0.1;
+    weights->settling = 0.01;
+    weights->energy = 0.001;
+}
+
+void GainTuner_DefaultOptions(GainTunerOptions *options, const SystemConfig_Cfg *cfg) {
+    memset(options, 0, sizeof(*options));
+    SystemConfig_Cfg copy = *cfg;
+    for (int i = 0; i < TUNER_DIM; i++) {
+        float value = *Config_At(&copy, i);
+        const char *name = GAIN_TUNER_PARAM_NAMES[i];
+        const ConfigSchemaField *field = ConfigSchema_Find(name, strlen(name));
+        options->lo[i] = 0.0f;
+        if (i >= GAIN_TUNER_DEADBAND_UPPER) {
+            options->hi[i] = GAIN_TUNER_DEADBAND_MAX_V;
+        } else {
+            options->hi[i] = value > 0.0f ? value * GAIN_TUNER_GAIN_SCALE_MAX : 1.0f;
+        }
+        // 搜索区间不超出配置字段表的取值范围，保证整定结果能写回配置文件
+        options->lo[i] = fmaxf(options->lo[i], field->min);
+        options->hi[i] = fminf(options->hi[i], field->max);
+    }
+    GainTuner_DefaultWeights(&options->weights);
+    options->scenarios = GAIN_TUNER_DEFAULT_SCENARIOS;
+    options->max_iterations = GAIN_TUNER_DEFAULT_ITERATIONS;
+}
+
+int GainTuner_ParseWeight(GainTunerWeights *weights, const char *spec) {
+    static const char *const names[4] = {"violation", "overshoot", "settling", "energy"};
+    double *items[4] = {&weights->violation, &weights->overshoot, &weights->settling, &weights->energy};
+    const char *eq = strchr(spec, '=');
+    for (int i = 0; eq && i < 4; i++) {
+        size_t len = strlen(names[i]);
+        if ((size_t)(eq - spec) == len && strncmp(spec, names[i], len) == 0) {
+            char *end;
+            double value = strtod(eq + 1, &end);
+            if (end == eq + 1 || *end != '\0' || !(value >= 0.0)) {
+                break;
+            }
+            *items[i] = value;
+            return 0;
+        }
+    }
+    fprintf(stderr, "错误: 代价权重%s无效，应为 指标=非负权重，指标可为violation/overshoot/settling/energy\n", spec);
+    return -1;
+}
+
+void GainTuner_Apply(SystemConfig_Cfg *cfg, const float *params) {
+    for (int i = 0; i < TUNER_DIM; i++) {
+        *Config_At(cfg, i) = params[i];
+    }
+}
+
+// 归一化坐标[0,1]换算为参数值；取6位有效数字，写出的配置文件读回后与评估时的参数完全相同
+static void Tuner_FromUnit(const GainTunerOptions *options, const double *unit, float *params) {
+    for (int i = 0; i < TUNER_DIM; i++) {
+        double u = unit[i] < 0.0 ? 0.0 : (unit[i] > 1.0 ? 1.0 : unit[i]);
+        char text[32];
+        snprintf(text, sizeof(text), "%.6g", options->lo[i] + (options->hi[i] - options->lo[i]) * u);
+        params[i] = (float)strtod(text, NULL);
+    }
+}
+
+// 仿真一组参数在一个场景上的表现
+static int Tuner_RunScenario(const SystemConfig_Cfg *base_cfg, const SOC_DeratingCurve *curve,
+                             const GainTunerOptions *options, const float *params, uint32_t scenario,
+                             const volatile sig_atomic_t *stop_flag, TunerMetrics *metrics) {
+    SystemConfig_Cfg cfg = *base_cfg;
+    GainTuner_Apply(&cfg, params);
+
+    GridModel grid;
+    if (GridModel_Clone(&grid, options->grid) != 0) {
+        return -1;
+    }
+    VoltageController *ctrls = (VoltageController *)calloc(options->areas, sizeof(VoltageController));
+    if (!ctrls) {
+        fprintf(stderr, "错误: 内存分配失败\n");
+        GridModel_Free(&grid);
+        return -1;
+    }
+
+    // 场景参数用流2*scenario，各台区模拟数据源用奇数流，均与候选参数无关；场景0为电网模型本身
+    Prng rng;
+    Prng_Seed(&rng, options->seed, 2 * (uint64_t)scenario);
+    if (scenario > 0) {
+        float span = GAIN_TUNER_SCALE_HI - GAIN_TUNER_SCALE_LO;
+        grid.load_scale = GAIN_TUNER_SCALE_LO + span * Prng_Uniform(&rng);
+        grid.pv_scale = GAIN_TUNER_SCALE_LO + span * Prng_Uniform(&rng);
+    }
+    CompiledConfig compiled;
+    CompiledConfig_Build(&compiled, &cfg, curve);
+    int ret = 0;
+    for (size_t i = 0; i < options->areas && ret == 0; i++) {
+        VoltageController *ctrl = &ctrls[i];
+        VoltageController_Init(ctrl, (int)i, &compiled, curve);
+        Simulation_Init(&ctrl->sim, options->seed, 2 * ((uint64_t)scenario * options->areas + i) + 1);
+        if (scenario > 0) {
+            ctrl->sim.simulated_soc = GAIN_TUNER_SOC_LO + (GAIN_TUNER_SOC_HI - GAIN_TUNER_SOC_LO) * Prng_Uniform(&rng);
+        }
+        if (options->battery) {
+            ret = Simulation_EnableBattery(&ctrl->sim, options->battery);
+        }
+        if (ret == 0) {
+            ret = GridModel_Attach(&ctrl->sim, &grid, (uint32_t)i);
+        }
+    }
+
+    SimulationSummary summary;
+    if (ret == 0) {
+        SimulationOptions sim_options = {options->duration_s, options->step_s, NULL, &grid};
+        ret = Simulation_RunControllers(ctrls, options->areas, &sim_options, stop_flag, &summary);
+    }
+    free(ctrls);
+    GridModel_Free(&grid);
+    if (ret != 0) {
+        return -1;
+    }
+
+    double area_days = (double)options->areas * summary.simulated_s / 86400.0;
+    metrics->violation_h = summary.time_outside_ref_s / 3600.0 / area_days;
+    metrics->overshoot_V = summary.overshoot_max_V;
+    metrics->settling_min = SimulationSummary_SettlingScore(&summary) / 60.0; // 未稳定事件计到仿真结束
+    metrics->energy_kwh = (summary.energy_charge_kwh + summary.energy_discharge_kwh) / area_days;
+    return 0;
+}
+
+// 并行评估count组参数(归一化坐标)，每组在全部场景上仿真，指标取场景平均后按权重求代价
+static int Tuner_Evaluate(const SystemConfig_Cfg *cfg, const SOC_DeratingCurve *curve,
+                          const GainTunerOptions *options, const double (*units)[TUNER_DIM], size_t count,
+                          const volatile sig_atomic_t *stop_flag, GainTunerPoint *points) {
+    size_t scenarios = options->scenarios;
+    size_t tasks = count * scenarios;
+    TunerMetrics *metrics = (TunerMetrics *)calloc(tasks, sizeof(TunerMetrics));
+    int *failed = (int *)calloc(tasks, sizeof(int));
+    if (!metrics || !failed) {
+        fprintf(stderr, "错误: 内存分配失败\n");
+        free(metrics);
+        free(failed);
+        return -1;
+    }
+    for (size_t k = 0; k < count; k++) {
+        Tuner_FromUnit(options, units[k], points[k].params);
+    }
+
+    ParallelFor(tasks, options->threads, [&](size_t t) {
+        if (stop_flag && *stop_flag) {
+            failed[t] = 1;
+            return;
+        }
+        const GainTunerPoint *point = &points[t / scenarios];
+        failed[t] = Tuner_RunScenario(cfg, curve, options, point->params, (uint32_t)(t % scenarios),
+                                      stop_flag, &metrics[t]) != 0;
+    });
+
+    int ret = 0;
+    for (size_t t = 0; t < tasks; t++) {
+        if (failed[t]) {
+            ret = -1;
+        }
+    }
+    // 按下标顺序汇总，结果与线程数无关
+    const GainTunerWeights *w = &options->weights;
+    for (size_t k = 0; ret == 0 && k < count; k++) {
+        GainTunerPoint *point = &points[k];
+        TunerMetrics sum = {0.0, 0.0, 0.0, 0.0};
+        for (size_t s = 0; s < scenarios; s++) {
+            const TunerMetrics *m = &metrics[k * scenarios + s];
+            sum.violation_h += m->violation_h;
+            sum.overshoot_V += m->overshoot_V;
+            sum.settling_min += m->settling_min;
+            sum.energy_kwh += m->energy_kwh;
+        }
+        point->violation_h = sum.violation_h / (double)scenarios;
+        point->overshoot_V = sum.overshoot_V / (double)scenarios;
+        point->settling_min = sum.settling_min / (double)scenarios;
+        point->energy_kwh = sum.energy_kwh / (double)scenarios;
+        point->cost = w->violation * point->violation_h + w->overshoot * point->overshoot_V
+                      + w->settling * point->settling_min + w->energy * point->energy_kwh;
+    }
+    free(metrics);
+    free(failed);
+    return ret;
+}
+
+// 按代价升序排列单纯形顶点(代价相同时保持原顺序)
+static void Simplex_Sort(double (*units)[TUNER_DIM], GainTunerPoint *points) {
+    for (int i = 1; i <= TUNER_DIM; i++) {
+        for (int j = i; j > 0 && points[j].cost < points[j - 1].cost; j--) {
+            GainTunerPoint point = points[j];
+            points[j] = points[j - 1];
+            points[j - 1] = point;
+            for (int d = 0; d < TUNER_DIM; d++) {
+                double u = units[j][d];
+                units[j][d] = units[j - 1][d];
+                units[j - 1][d] = u;
+            }
+        }
+    }
+}
+
+// 单纯形直径：最优顶点到其余顶点的最大坐标差
+static double Simplex_Size(const double (*units)[TUNER_DIM]) {
+    double size = 0.0;
+    for (int i = 1; i <= TUNER_DIM; i++) {
+        for (int d = 0; d < TUNER_DIM; d++) {
+            double diff = fabs(units[i][d] - units[0][d]);
+            if (diff > size) size = diff;
+        }
+    }
+    return size;
+}
+
+int GainTuner_Run(const SystemConfig_Cfg *cfg, const SOC_DeratingCurve *curve, const GainTunerOptions *options,
+                  const volatile sig_atomic_t *stop_flag, FILE *progress, GainTunerResult *result) {
+    memset(result, 0, sizeof(*result));
+    int bounds_ok = 1;
+    for (int i = 0; i < TUNER_DIM; i++) {
+        bounds_ok = bounds_ok && options->lo[i] >= 0.0f && options->hi[i] > options->lo[i];
+    }
+    if (!options->grid) {
+        fprintf(stderr, "错误: 整定需要电网模型(闭环电压)\n");
+        return -1;
+    }
+    if (!bounds_ok || options->areas == 0 || options->scenarios == 0 || options->max_iterations < 0
+        || !(options->step_s > 0.0) || !(options->duration_s >= options->step_s)) {
+        fprintf(stderr, "错误: 整定参数非法 (台区数=%zu, 场景数=%u, 迭代次数=%d, 时长=%gs, 步长=%gs)\n",
+                options->areas, options->scenarios, options->max_iterations, options->duration_s, options->step_s);
+        return -1;
+    }
+
+    // 初始单纯形：起点及其沿各坐标移动1/4区间的N个顶点(越界时反向移动)
+    double units[TUNER_DIM + 1][TUNER_DIM];
+    GainTunerPoint points[TUNER_DIM + 1];
+    SystemConfig_Cfg copy = *cfg;
+    for (int d = 0; d < TUNER_DIM; d++) {
+        double u = (*Config_At(&copy, d) - options->lo[d]) / (options->hi[d] - options->lo[d]);
+        units[0][d] = u < 0.0 ? 0.0 : (u > 1.0 ? 1.0 : u);
+    }
+    for (int i = 1; i <= TUNER_DIM; i++) {
+        memcpy(units[i], units[0], sizeof(units[0]));
+        units[i][i - 1] += units[0][i - 1] + 0.25 <= 1.0 ? 0.25 : -0.25;
+    }
+    if (Tuner_Evaluate(cfg, curve, options, units, TUNER_DIM + 1, stop_flag, points) != 0) {
+        return -1;
+    }
+    result->evaluations = TUNER_DIM + 1;
+    result->initial = points[0];
+
+    // 每次迭代的候选点：反射、扩展、外收缩、内收缩
+    static const double coefficients[4] = {1.0, 2.0, 0.5, -0.5};
+    for (int iter = 0; iter < options->max_iterations; iter++) {
+        Simplex_Sort(units, points);
+        if (Simplex_Size(units) < GAIN_TUNER_TOLERANCE) {
+            result->converged = 1;
+            break;
+        }
+
+        double centroid[TUNER_DIM] = {0.0};
+        for (int i = 0; i < TUNER_DIM; i++) {
+            for (int d = 0; d < TUNER_DIM; d++) {
+                centroid[d] += units[i][d] / TUNER_DIM;
+            }
+        }
+        double trial[4][TUNER_DIM];
+        GainTunerPoint trial_points[4];
+        for (int c = 0; c < 4; c++) {
+            for (int d = 0; d < TUNER_DIM; d++) {
+                double u = centroid[d] + coefficients[c] * (centroid[d] - units[TUNER_DIM][d]);
+                trial[c][d] = u < 0.0 ? 0.0 : (u > 1.0 ? 1.0 : u);
+            }
+        }
+        if (Tuner_Evaluate(cfg, curve, options, trial, 4, stop_flag, trial_points) != 0) {
+            if (stop_flag && *stop_flag) {
+                break;
+            }
+            return -1;
+        }
+        result->evaluations += 4;
+
+        double f_reflect = trial_points[0].cost;
+        int accept = -1;
+        if (f_reflect < points[0].cost) {
+            accept = trial_points[1].cost < f_reflect ? 1 : 0;
+        } else if (f_reflect < points[TUNER_DIM - 1].cost) {
+            accept = 0;
+        } else if (f_reflect < points[TUNER_DIM].cost) {
+            accept = trial_points[2].cost <= f_reflect ? 2 : -1;
+        } else {
+            accept = trial_points[3].cost < points[TUNER_DIM].cost ? 3 : -1;
+        }
+
+        if (accept >= 0) {
+            memcpy(units[TUNER_DIM], trial[accept], sizeof(units[TUNER_DIM]));
+            points[TUNER_DIM] = trial_points[accept];
+        } else {
+            // 收缩：其余顶点向最优顶点靠拢一半
+            for (int i = 1; i <= TUNER_DIM; i++) {
+                for (int d = 0; d < TUNER_DIM; d++) {
+                    units[i][d] = units[0][d] + 0.5 * (units[i][d] - units[0][d]);
+                }
+            }
+            if (Tuner_Evaluate(cfg, curve, options, units + 1, TUNER_DIM, stop_flag, points + 1) != 0) {
+                if (stop_flag && *stop_flag) {
+                    break;
+                }
+                return -1;
+            }
+            result->evaluations += TUNER_DIM;
+        }
+        result->iterations = iter + 1;
+
+        if (progress) {
+            const GainTunerPoint *best = &points[0];
+            for (int i = 1; i <= TUNER_DIM; i++) {
+                if (points[i].cost < best->cost) best = &points[i];
+            }
+            fprintf(progress, "迭代%3d: 最优代价=%.6g, 单纯形直径=%.4g, 已评估%llu组参数\n",
+                    result->iterations, best->cost, Simplex_Size(units), (unsigned long long)result->evaluations);
+            fflush(progress);
+        }
+    }
+
+    Simplex_Sort(units, points);
+    result->best = points[0];
+    if (stop_flag && *stop_flag) {
+        fprintf(stderr, "整定被中断，输出已找到的最优参数\n");
+    }
+    return 0;
+}
+
+int GainTuner_WriteConfig(const char *base_file, const float *params, const char *output_file) {
+    char *content = Read_TextFile(base_file, "配置文件");
+    if (!content) {
+        return -1;
+    }
+    cJSON *root = cJSON_Parse(content);
+    free(content);
+    if (!root) {
+        fprintf(stderr, "错误: 配置文件 %s 不是合法的JSON\n", base_file);
+        return -1;
+    }
+    SystemConfig_Cfg checked;
+    memset(&checked, 0, sizeof(checked));
+    for (int i = 0; i < TUNER_DIM; i++) {
+        // 参数所属的节取自配置字段表
+        const char *name = GAIN_TUNER_PARAM_NAMES[i];
+        const ConfigSchemaField *field = ConfigSchema_Find(name, strlen(name));
+        const char *section_name = CONFIG_SECTION_NAMES[field->section];
+        cJSON *section = cJSON_GetObjectItemCaseSensitive(root, section_name);
+        cJSON *item = cJSON_GetObjectItemCaseSensitive(section, name);
+        if (!cJSON_IsNumber(item)) {
+            fprintf(stderr, "错误: 配置文件 %s 缺少 %s.%s\n", base_file, section_name, name);
+            cJSON_Delete(root);
+            return -1;
+        }
+        // 与Tuner_FromUnit一致取6位有效数字，避免写出0.100000001490116这样的单精度展开
+        char text[32];
+        snprintf(text, sizeof(text), "%.6g", params[i]);
+        double value = strtod(text, NULL);
+        // 按配置字段表检查取值范围，不写出读回时会被拒绝的配置文件
+        if (ConfigSchema_Set(&checked, field, value, output_file) != 0) {
+            cJSON_Delete(root);
+            return -1;
+        }
+        cJSON_SetNumberValue(item, value);
+    }
+    char *json = cJSON_Print(root);
+    cJSON_Delete(root);
+    if (!json) {
+        fprintf(stderr, "错误: 内存分配失败\n");
+        return -1;
+    }
+
+    int ret = 0;
+    FILE *fp = fopen(output_file, "w");
+    if (!fp) {
+        fprintf(stderr, "错误: 无法创建配置文件 %s\n", output_file);
+        ret = -1;
+    } else {
+        fprintf(fp, "%s\n", json);
+        if (fclose(fp) != 0) {
+            fprintf(stderr, "错误: 写入配置文件 %s 失败\n", output_file);
+            ret = -1;
+        }
+    }
+    free(json);
+    return ret;
+}
+
+void GainTuner_Print(const GainTunerResult *result, FILE *fp) {
+    fprintf(fp, "整定结果: 迭代%d次, 评估%llu组参数, %s\n", result->iterations,
+            (unsigned long long)result->evaluations, result->converged ? "已收敛" : "达到最大迭代次数");
+    fprintf(fp, "  %-16s %12s %12s\n", "参数", "起点", "最优");
+    for (int i = 0; i < TUNER_DIM; i++) {
+        fprintf(fp, "  %-16s %12.6g %12.6g\n", GAIN_TUNER_PARAM_NAMES[i],
+                result->initial.params[i], result->best.params[i]);
+    }
+    const GainTunerPoint *points[2] = {&result->initial, &result->best};
+    const char *labels[2] = {"起点", "最优"};
+    for (int k = 0; k < 2; k++) {
+        fprintf(fp, "  %s: 代价=%.6g, 超出设定值=%.3fh/台区天, 最大超调=%.3fV, 平均调节时间=%.2fmin, "
+                    "充放电能量=%.2fkWh/台区天\n",
+                labels[k], points[k]->cost, points[k]->violation_h, points[k]->overshoot_V,
+                points[k]->settling_min, points[k]->energy_kwh);
+    }
+}
@@ -0,0 +1,158 @@
+/*
+ * 文件：gain_tuner.h
+ * 功能：PI增益与死区自动整定(Nelder-Mead单纯形法)
+ *
+ * 功能描述：
+ * 1. 以配置文件中的四个PI增益与上下限死区为起点，用Nelder-Mead单纯形法在给定区间内
+ *    搜索使加权代价最小的参数，不需要梯度，每个候选参数只需若干次闭环仿真
+ * 2. 代价 = 各指标按权重加权求和：超出设定值时长(不计死区，死区加宽不会"减少"越限)、
+ *    最大超调、平均调节时间、充放电能量；各指标在多个场景上取平均
+ * 3. 整定只在电网模型上进行(闭环：储能功率改变台区电压)；正弦电压与录波回放中的电压
+ *    不随储能功率变化，越限时长与参数无关，整定结果只会是"少出力"。场景0为电网模型本身，
+ *    其余场景的负荷、光伏整体倍数与各储能初始SOC随机生成；每个候选参数在全部场景上使用
+ *    相同的随机流，代价是参数的确定性函数
+ * 4. 每次迭代的反射、扩展、外收缩、内收缩四个候选点(及收缩时的全部顶点)与全部场景
+ *    一起并行仿真，迭代次数不变而墙钟时间随核数下降
+ * 5. 结果写为可直接使用的配置文件：读入原配置文件，只替换被整定的参数
+ */
+
+#ifndef VOLTAGE_CONTROL_GAIN_TUNER_H
+#define VOLTAGE_CONTROL_GAIN_TUNER_H
+
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include "voltage_control.h"
+
+#define GAIN_TUNER_PARAM_COUNT 6            // 整定参数个数
+#define GAIN_TUNER_DEFAULT_ITERATIONS 40    // 默认最大迭代次数
+#define GAIN_TUNER_DEFAULT_SCENARIOS 4      // 默认场景数
+#define GAIN_TUNER_TOLERANCE 1e-3           // 单纯形在归一化参数空间中的直径小于此值即认为收敛
+#define GAIN_TUNER_DEADBAND_MAX_V 10.0f     // 死区搜索上限 (V)
+#define GAIN_TUNER_GAIN_SCALE_MAX 4.0f      // 增益搜索上限为配置值的倍数
+#define GAIN_TUNER_SCALE_LO 0.7f            // 随机场景负荷、光伏倍数下限
+#define GAIN_TUNER_SCALE_HI 1.3f            // 随机场景负荷、光伏倍数上限
+#define GAIN_TUNER_SOC_LO 0.3f              // 随机场景初始SOC下限
+#define GAIN_TUNER_SOC_HI 0.8f              // 随机场景初始SOC上限
+
+struct GridModel;
+
+/* ---------- 整定参数(下标即GAIN_TUNER_PARAM_NAMES中的顺序) ---------- */
+typedef enum {
+    GAIN_TUNER_KP_UPPER = 0,
+    GAIN_TUNER_KI_UPPER = 1,
+    GAIN_TUNER_KP_LOWER = 2,
+    GAIN_TUNER_KI_LOWER = 3,
+    GAIN_TUNER_DEADBAND_UPPER = 4,
+    GAIN_TUNER_DEADBAND_LOWER = 5
+} GainTunerParam;
+
+extern const char *const GAIN_TUNER_PARAM_NAMES[GAIN_TUNER_PARAM_COUNT];
+
+/* ---------- 代价权重 ---------- */
+typedef struct {
+    double violation;                   // 每台区每天超出设定值的小时数
+    double overshoot;                   // 最大超调 (V)
+    double settling;                    // 平均调节时间 (min)，未稳定事件按持续到仿真结束计
+    double energy;                      // 每台区每天充放电能量 (kWh)
+} GainTunerWeights;
+
+/* ---------- 整定参数 ---------- */
+typedef struct {
+    float lo[GAIN_TUNER_PARAM_COUNT];   // 各参数搜索下限
+    float hi[GAIN_TUNER_PARAM_COUNT];   // 各参数搜索上限
+    GainTunerWeights weights;
+    uint32_t scenarios;                 // 场景数
+    int max_iterations;                 // 最大迭代次数
+    double duration_s;                  // 每个场景的仿真时长 (s)
+    double step_s;                      // 仿真步长 (s)
+    uint64_t seed;                      // 随机种子
+    size_t areas;                       // 台区数量
+    int threads;                        // 工作线程数，小于1时使用全部硬件线程
+    const GridModel *grid;              // 电网模型(必需)，每次仿真使用独立副本
+    const BatteryParams *battery;       // 电池参数，NULL表示不启用电池模型
+} GainTunerOptions;
+
+/* ---------- 一组参数的评估结果(各指标为全部场景的平均值) ---------- */
+typedef struct {
+    float params[GAIN_TUNER_PARAM_COUNT];
+    double cost;                        // 加权代价
+    double violation_h;                 // 每台区每天超出设定值的小时数
+    double overshoot_V;                 // 最大超调 (V)
+    double settling_min;                // 平均调节时间 (min)，见SimulationSummary_SettlingScore
+    double energy_kwh;                  // 每台区每天充放电能量 (kWh)
+} GainTunerPoint;
+
+/* ---------- 整定结果 ---------- */
+typedef struct {
+    GainTunerPoint initial;             // 起点(配置文件中的参数)
+    GainTunerPoint best;                // 最优参数
+    int iterations;                     // 已完成的迭代次数
+    uint64_t evaluations;               // 已评估的参数组数
+    int converged;                      // 是否在达到最大迭代次数前收敛
+} GainTunerResult;
+
+/**
+ * @brief 默认代价权重：violation=1, overshoot=0.1, settling=0.01, energy=0.001
+ * @param weights [输出] 权重
+ */
+void GainTuner_DefaultWeights(GainTunerWeights *weights);
+
+/**
+ * @brief 以配置中的当前值确定搜索区间，并填写默认权重、场景数与迭代次数
+ *
+ * 增益区间为[0, GAIN_TUNER_GAIN_SCALE_MAX倍配置值]，死区区间为[0, GAIN_TUNER_DEADBAND_MAX_V]，
+ * 两者都再截到配置字段表的取值范围内
+ * @param options [输出] 整定参数，仿真时长、步长等其余字段由调用者填写
+ * @param cfg 基准配置
+ */
+void GainTuner_DefaultOptions(GainTunerOptions *options, const SystemConfig_Cfg *cfg);
+
+/**
+ * @brief 解析"指标=权重"，指标为violation/overshoot/settling/energy，如"energy=0.01"
+ * @param weights 权重，只修改指定的一项
+ * @param spec 参数字符串
+ * @return int 成功返回0，格式错误返回-1
+ */
+int GainTuner_ParseWeight(GainTunerWeights *weights, const char *spec);
+
+/**
+ * @brief 运行整定
+ * @param cfg 基准配置(起点)
+ * @param curve SOC降额曲线
+ * @param options 整定参数
+ * @param stop_flag 外部停止标志，置位后尽快停止并返回已找到的最优参数(起点尚未评估完时返回失败)，可为NULL
+ * @param progress 每次迭代输出进度的流，可为NULL
+ * @param result [输出] 整定结果
+ * @return int 成功返回0，参数错误或仿真失败返回-1
+ */
+int GainTuner_Run(const SystemConfig_Cfg *cfg, const SOC_DeratingCurve *curve, const GainTunerOptions *options,
+                  const volatile sig_atomic_t *stop_flag, FILE *progress, GainTunerResult *result);
+
+/**
+ * @brief 把整定参数写入配置
+ * @param cfg 配置
+ * @param params 整定参数
+ */
+void GainTuner_Apply(SystemConfig_Cfg *cfg, const float *params);
+
+/**
+ * @brief 读入原配置文件，替换被整定的参数后写到新文件(其余内容保持不变)
+ *
+ * 参数按配置字段表检查取值范围，超出范围时不写出文件
+ * @param base_file 原配置文件
+ * @param params 整定参数
+ * @param output_file 输出配置文件
+ * @return int 成功返回0，失败返回-1(已输出错误信息)
+ */
+int GainTuner_WriteConfig(const char *base_file, const float *params, const char *output_file);
+
+/**
+ * @brief 输出起点与最优参数的对比
+ * @param result 整定结果
+ * @param fp 输出流
+ */
+void GainTuner_Print(const GainTunerResult *result, FILE *fp);
+
+#endif // VOLTAGE_CONTROL_GAIN_TUNER_H
@@ -0,0 +1,492 @@
+/*
+ * 文件：grid_model.cpp
+ * 功能：仿真用配电网电压模型实现
+ */
+
+#include "grid_model.h"
+#include "cJSON.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#define GRID_ARRAY_COUNT 5          // 每个台区占用的float数组个数(不含灵敏度矩阵)
+
+// 内置日曲线：居民负荷(早晚双峰)与晴天光伏出力，逐小时标幺值
+static const float GRID_BUILTIN_LOAD[24] = {
+    0.45f, 0.40f, 0.38f, 0.37f, 0.38f, 0.45f, 0.60f, 0.75f, 0.70f, 0.60f, 0.55f, 0.55f,
+    0.55f, 0.52f, 0.52f, 0.55f, 0.65f, 0.85f, 1.00f, 0.98f, 0.90f, 0.78f, 0.65f, 0.52f
+};
+static const float GRID_BUILTIN_PV[24] = {
+    0.00f, 0.00f, 0.00f, 0.00f, 0.00f, 0.00f, 0.05f, 0.20f, 0.40f, 0.60f, 0.80f, 0.95f,
+    1.00f, 0.95f, 0.80f, 0.60f, 0.40f, 0.20f, 0.05f, 0.00f, 0.00f, 0.00f, 0.00f, 0.00f
+};
+
+// 分配曲线数组
+static int GridProfile_Alloc(GridModel *grid, size_t count) {
+    grid->profile_time_s = (double *)calloc(count, sizeof(double));
+    grid->profile_load = (float *)calloc(count, sizeof(float));
+    grid->profile_pv = (float *)calloc(count, sizeof(float));
+    if (!grid->profile_time_s || !grid->profile_load || !grid->profile_pv) {
+        fprintf(stderr, "错误: 内存分配失败\n");
+        return -1;
+    }
+    grid->profile_count = count;
+    return 0;
+}
+
+// 使用内置逐小时日曲线
+static int GridProfile_Builtin(GridModel *grid) {
+    if (GridProfile_Alloc(grid, 24) != 0) {
+        return -1;
+    }
+    for (size_t i = 0; i < 24; i++) {
+        grid->profile_time_s[i] = 3600.0 * (double)i;
+        grid->profile_load[i] = GRID_BUILTIN_LOAD[i];
+        grid->profile_pv[i] = GRID_BUILTIN_PV[i];
+    }
+    grid->profile_period_s = GRID_DEFAULT_PROFILE_PERIOD_S;
+    return 0;
+}
+
+// 从CSV读入日曲线：每行 time_s,load_pu,pv_pu，时刻严格递增且小于曲线周期
+static int GridProfile_LoadCsv(GridModel *grid, const char *filename) {
+    FILE *fp = fopen(filename, "r");
+    if (!fp) {
+        fprintf(stderr, "错误: 无法打开负荷/光伏曲线文件 %s\n", filename);
+        return -1;
+    }
+
+    // 第一遍统计数据行数，第二遍解析
+    char line[256];
+    size_t rows = 0;
+    while (fgets(line, sizeof(line), fp)) {
+        rows++;
+    }
+    if (rows == 0 || GridProfile_Alloc(grid, rows) != 0) {
+        if (rows == 0) {
+            fprintf(stderr, "错误: 负荷/光伏曲线文件 %s 为空\n", filename);
+        }
+        fclose(fp);
+        return -1;
+    }
+    rewind(fp);
+
+    size_t count = 0;
+    long line_num = 0;
+    int ret = 0;
+    while (fgets(line, sizeof(line), fp)) {
+        line_num++;
+        if (line[0] == '\n' || line[0] == '\r' || line[0] == '#') {
+            continue;
+        }
+        char *end;
+        double time_s = strtod(line, &end);
+        double load = 0.0;
+        double pv = 0.0;
+        int ok = end != line && *end == ',';
+        if (ok) {
+            const char *p = end + 1;
+            load = strtod(p, &end);
+            ok = end != p && *end == ',';
+        }
+        if (ok) {
+            const char *p = end + 1;
+            pv = strtod(p, &end);
+            ok = end != p;
+        }
+        if (!ok) {
+            if (count == 0) {
+                continue; // 表头
+            }
+            fprintf(stderr, "错误: 曲线文件第%ld行格式错误，应为 time_s,load_pu,pv_pu\n", line_num);
+            ret = -1;
+            break;
+        }
+        if (count > 0 && !(time_s > grid->profile_time_s[count - 1])) {
+            fprintf(stderr, "错误: 曲线文件第%ld行时刻未递增\n", line_num);
+            ret = -1;
+            break;
+        }
+        grid->profile_time_s[count] = time_s;
+        grid->profile_load[count] = (float)load;
+        grid->profile_pv[count] = (float)pv;
+        count++;
+    }
+    fclose(fp);
+    if (ret != 0) {
+        return -1;
+    }
+    if (count == 0) {
+        fprintf(stderr, "错误: 曲线文件 %s 中没有数据行\n", filename);
+        return -1;
+    }
+    grid->profile_count = count;
+    return 0;
+}
+
+// 读取一个数或长度为count的数组到values
+static int Grid_ParsePerArea(const cJSON *root, const char *name, float *values, size_t count, double fallback) {
+    const cJSON *item = cJSON_GetObjectItemCaseSensitive(root, name);
+    if (!item) {
+        for (size_t i = 0; i < count; i++) {
+            values[i] = (float)fallback;
+        }
+        return 0;
+    }
+    if (cJSON_IsNumber(item)) {
+        for (size_t i = 0; i < count; i++) {
+            values[i] = (float)item->valuedouble;
+        }
+        return 0;
+    }
+    if (!cJSON_IsArray(item) || (size_t)cJSON_GetArraySize(item) != count) {
+        fprintf(stderr, "错误: 电网模型参数%s应为一个数或长度为%zu的数组\n", name, count);
+        return -1;
+    }
+    size_t i = 0;
+    const cJSON *value;
+    cJSON_ArrayForEach(value, item) {
+        if (!cJSON_IsNumber(value)) {
+            fprintf(stderr, "错误: 电网模型参数%s的第%zu个元素不是数值\n", name, i);
+            return -1;
+        }
+        values[i++] = (float)value->valuedouble;
+    }
+    return 0;
+}
+
+// 读取count行count列的灵敏度矩阵
+static int Grid_ParseSensitivity(const cJSON *root, float *matrix, size_t count) {
+    const cJSON *rows = cJSON_GetObjectItemCaseSensitive(root, "sensitivity");
+    if (!cJSON_IsArray(rows) || (size_t)cJSON_GetArraySize(rows) != count) {
+        fprintf(stderr, "错误: 灵敏度矩阵sensitivity应为%zu行%zu列的数组\n", count, count);
+        return -1;
+    }
+    size_t i = 0;
+    const cJSON *row;
+    cJSON_ArrayForEach(row, rows) {
+        if (!cJSON_IsArray(row) || (size_t)cJSON_GetArraySize(row) != count) {
+            fprintf(stderr, "错误: 灵敏度矩阵第%zu行应有%zu个元素\n", i, count);
+            return -1;
+        }
+        size_t j = 0;
+        const cJSON *value;
+        cJSON_ArrayForEach(value, row) {
+            if (!cJSON_IsNumber(value)) {
+                fprintf(stderr, "错误: 灵敏度矩阵第%zu行第%zu列不是数值\n", i, j);
+                return -1;
+            }
+            matrix[i * count + j] = (float)value->valuedouble;
+            j++;
+        }
+        i++;
+    }
+    return 0;
+}
+
+// 加载馈线文件并把各储能的母线编号换算为拓扑序下标
+static int Grid_ParseFeeder(GridModel *grid, const cJSON *root, size_t count) {
+    const cJSON *feeder = cJSON_GetObjectItemCaseSensitive(root, "feeder");
+    const cJSON *buses = cJSON_GetObjectItemCaseSensitive(root, "storage_bus");
+    if (!cJSON_IsString(feeder)) {
+        fprintf(stderr, "错误: 辐射状馈线模型须用feeder指定馈线文件\n");
+        return -1;
+    }
+    if (!cJSON_IsArray(buses) || (size_t)cJSON_GetArraySize(buses) != count) {
+        fprintf(stderr, "错误: storage_bus应为长度%zu的母线编号数组\n", count);
+        return -1;
+    }
+    grid->storage_bus = (uint32_t *)calloc(count, sizeof(uint32_t));
+    if (!grid->storage_bus) {
+        fprintf(stderr, "错误: 内存分配失败\n");
+        return -1;
+    }
+    if (RadialFeeder_LoadCsv(&grid->feeder, feeder->valuestring, grid->V_source) != 0) {
+        return -1;
+    }
+    size_t i = 0;
+    const cJSON *bus;
+    cJSON_ArrayForEach(bus, buses) {
+        int32_t index = cJSON_IsNumber(bus) && bus->valuedouble >= 0.0
+                        ? RadialFeeder_BusIndex(&grid->feeder, (uint32_t)bus->valuedouble) : -1;
+        if (index < 0) {
+            fprintf(stderr, "错误: storage_bus的第%zu个元素不是馈线中的母线编号\n", i);
+            return -1;
+        }
+        grid->storage_bus[i++] = (uint32_t)index;
+    }
+    return 0;
+}
+
+// 读取数值参数，缺省时取fallback
+static double Grid_GetNumber(const cJSON *root, const char *name, double fallback) {
+    const cJSON *item = cJSON_GetObjectItemCaseSensitive(root, name);
+    return cJSON_IsNumber(item) ? item->valuedouble : fallback;
+}
+
+// 解析JSON各项到已清零的grid
+static int GridModel_Parse(GridModel *grid, const cJSON *root, size_t count) {
+    const cJSON *model = cJSON_GetObjectItemCaseSensitive(root, "model");
+    if (!cJSON_IsString(model)) {
+        fprintf(stderr, "错误: 电网模型文件缺少model(thevenin、sensitivity或radial)\n");
+        return -1;
+    }
+    if (strcmp(model->valuestring, "thevenin") == 0) {
+        grid->type = GRID_MODEL_THEVENIN;
+    } else if (strcmp(model->valuestring, "sensitivity") == 0) {
+        grid->type = GRID_MODEL_SENSITIVITY;
+    } else if (strcmp(model->valuestring, "radial") == 0) {
+        grid->type = GRID_MODEL_RADIAL;
+    } else {
+        fprintf(stderr, "错误: 未知的电网模型 %s(应为thevenin、sensitivity或radial)\n", model->valuestring);
+        return -1;
+    }
+
+    grid->V_source = (float)Grid_GetNumber(root, "V_source", 220.0);
+    grid->V_nominal = (float)Grid_GetNumber(root, "V_nominal", 220.0);
+    grid->R_ohm = (float)Grid_GetNumber(root, "R_ohm", 0.0);
+    grid->X_ohm = (float)Grid_GetNumber(root, "X_ohm", 0.0);
+    double power_factor = Grid_GetNumber(root, "load_power_factor", 1.0);
+    if (!(grid->V_nominal > 0.0f) || !(grid->R_ohm >= 0.0f) || !(grid->X_ohm >= 0.0f)
+        || !(power_factor > 0.0 && power_factor <= 1.0)) {
+        fprintf(stderr, "错误: 电网模型参数非法 (V_nominal=%g, R_ohm=%g, X_ohm=%g, load_power_factor=%g)\n",
+                grid->V_nominal, grid->R_ohm, grid->X_ohm, power_factor);
+        return -1;
+    }
+    grid->load_tan_phi = (float)(sqrt(1.0 - power_factor * power_factor) / power_factor);
+
+    // 各台区数组与灵敏度矩阵共用一块内存
+    size_t matrix_count = grid->type == GRID_MODEL_SENSITIVITY ? count * count : 0;
+    float *p = (float *)calloc(count * GRID_ARRAY_COUNT + matrix_count, sizeof(float));
+    if (!p) {
+        fprintf(stderr, "错误: 内存分配失败\n");
+        return -1;
+    }
+    grid->block = p;
+    grid->load_kw = p;      p += count;
+    grid->pv_kw = p;        p += count;
+    grid->P_storage = p;    p += count;
+    grid->P_inject = p;     p += count;
+    grid->V = p;            p += count;
+    grid->sensitivity = matrix_count ? p : NULL;
+    grid->count = count;
+
+    if (Grid_ParsePerArea(root, "load_kw", grid->load_kw, count, 0.0) != 0
+        || Grid_ParsePerArea(root, "pv_kw", grid->pv_kw, count, 0.0) != 0) {
+        return -1;
+    }
+    if (grid->type == GRID_MODEL_SENSITIVITY && Grid_ParseSensitivity(root, grid->sensitivity, count) != 0) {
+        return -1;
+    }
+    if (grid->type == GRID_MODEL_RADIAL && Grid_ParseFeeder(grid, root, count) != 0) {
+        return -1;
+    }
+
+    const cJSON *profile = cJSON_GetObjectItemCaseSensitive(root, "profile");
+    if (cJSON_IsString(profile)) {
+        if (GridProfile_LoadCsv(grid, profile->valuestring) != 0) {
+            return -1;
+        }
+        grid->profile_period_s = Grid_GetNumber(root, "profile_period_s", GRID_DEFAULT_PROFILE_PERIOD_S);
+        if (!(grid->profile_period_s > grid->profile_time_s[grid->profile_count - 1] - grid->profile_time_s[0])) {
+            fprintf(stderr, "错误: 曲线周期profile_period_s=%gs须大于曲线跨度\n", grid->profile_period_s);
+            return -1;
+        }
+    } else if (GridProfile_Builtin(grid) != 0) {
+        return -1;
+    }
+
+    // 初始电压：储能功率为零时的解
+    GridModel_Solve(grid, 0.0);
+    return 0;
+}
+
+int GridModel_Load(GridModel *grid, const char *filename, size_t count) {
+    memset(grid, 0, sizeof(*grid));
+    grid->load_scale = 1.0f;
+    grid->pv_scale = 1.0f;
+    if (count == 0) {
+        fprintf(stderr, "错误: 台区数量必须大于0\n");
+        return -1;
+    }
+    char *content = Read_TextFile(filename, "电网模型文件");
+    if (!content) {
+        return -1;
+    }
+    cJSON *root = cJSON_Parse(content);
+    free(content);
+    if (!root) {
+        const char *error_ptr = cJSON_GetErrorPtr();
+        fprintf(stderr, "错误: 电网模型文件 %s 解析失败: %s\n", filename, error_ptr ? error_ptr : "");
+        return -1;
+    }
+    int ret = GridModel_Parse(grid, root, count);
+    cJSON_Delete(root);
+    if (ret != 0) {
+        GridModel_Free(grid);
+    }
+    return ret;
+}
+
+// 复制n个元素的数组，n为0时返回NULL
+template <typename T>
+static T *Grid_CopyArray(const T *src, size_t n, int *failed) {
+    if (n == 0 || !src) {
+        return NULL;
+    }
+    T *dst = (T *)malloc(n * sizeof(T));
+    if (!dst) {
+        *failed = 1;
+        return NULL;
+    }
+    memcpy(dst, src, n * sizeof(T));
+    return dst;
+}
+
+int GridModel_Clone(GridModel *dst, const GridModel *src) {
+    *dst = *src;
+    memset(&dst->feeder, 0, sizeof(dst->feeder));
+    size_t n = src->count;
+    size_t floats = n * GRID_ARRAY_COUNT + (src->sensitivity ? n * n : 0);
+    int failed = 0;
+    float *p = Grid_CopyArray((const float *)src->block, floats, &failed);
+    dst->block = p;
+    dst->profile_time_s = Grid_CopyArray(src->profile_time_s, src->profile_count, &failed);
+    dst->profile_load = Grid_CopyArray(src->profile_load, src->profile_count, &failed);
+    dst->profile_pv = Grid_CopyArray(src->profile_pv, src->profile_count, &failed);
+    dst->storage_bus = Grid_CopyArray(src->storage_bus, n, &failed);
+    if (src->type == GRID_MODEL_RADIAL && !failed && RadialFeeder_Clone(&dst->feeder, &src->feeder) != 0) {
+        failed = 1;
+    }
+    if (failed) {
+        fprintf(stderr, "错误: 内存分配失败\n");
+        GridModel_Free(dst);
+        return -1;
+    }
+
+    // 数组在块内的偏移与原模型相同
+    dst->load_kw = p;       p += n;
+    dst->pv_kw = p;         p += n;
+    dst->P_storage = p;     p += n;
+    dst->P_inject = p;      p += n;
+    dst->V = p;             p += n;
+    dst->sensitivity = src->sensitivity ? p : NULL;
+    return 0;
+}
+
+void GridModel_Free(GridModel *grid) {
+    free(grid->block);
+    free(grid->profile_time_s);
+    free(grid->profile_load);
+    free(grid->profile_pv);
+    free(grid->storage_bus);
+    RadialFeeder_Free(&grid->feeder);
+    memset(grid, 0, sizeof(*grid));
+}
+
+// 按时刻线性插值负荷/光伏标幺值，曲线按周期回绕
+static void GridProfile_Sample(const GridModel *grid, double time_s, float *load_pu, float *pv_pu) {
+    const double *t = grid->profile_time_s;
+    size_t n = grid->profile_count;
+    double period = grid->profile_period_s;
+    double x = fmod(time_s - t[0], period);
+    if (x < 0.0) {
+        x += period;
+    }
+    x += t[0];
+
+    // 二分查找最后一个 t[lo] <= x 的点
+    size_t lo = 0;
+    size_t hi = n;
+    while (hi - lo > 1) {
+        size_t mid = (lo + hi) / 2;
+        if (t[mid] <= x) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    size_t next = lo + 1 < n ? lo + 1 : 0;
+    double t_next = lo + 1 < n ? t[next] : t[0] + period;
+    float w = t_next > t[lo] ? (float)((x - t[lo]) / (t_next - t[lo])) : 0.0f;
+    *load_pu = grid->profile_load[lo] + (grid->profile_load[next] - grid->profile_load[lo]) * w;
+    *pv_pu = grid->profile_pv[lo] + (grid->profile_pv[next] - grid->profile_pv[lo]) * w;
+}
+
+void GridModel_Solve(GridModel *grid, double time_s) {
+    float load_pu, pv_pu;
+    GridProfile_Sample(grid, time_s, &load_pu, &pv_pu);
+    load_pu *= grid->load_scale;
+    pv_pu *= grid->pv_scale;
+    size_t n = grid->count;
+
+    // 注入功率 = 光伏 - 负荷 - 储能(充电为正)
+    for (size_t i = 0; i < n; i++) {
+        grid->P_inject[i] = grid->pv_kw[i] * pv_pu - grid->load_kw[i] * load_pu - grid->P_storage[i];
+    }
+
+    switch (grid->type) {
+        case GRID_MODEL_THEVENIN: {
+            // ΔV ≈ (R·P + X·Q) / V_nominal，功率由kW换算为W；负荷无功按功率因数计入
+            float k = 1000.0f / grid->V_nominal;
+            for (size_t i = 0; i < n; i++) {
+                float Q_inject = -grid->load_kw[i] * load_pu * grid->load_tan_phi;
+                grid->V[i] = grid->V_source + (grid->R_ohm * grid->P_inject[i] + grid->X_ohm * Q_inject) * k;
+            }
+            break;
+        }
+        case GRID_MODEL_SENSITIVITY:
+            for (size_t i = 0; i < n; i++) {
+                const float *row = grid->sensitivity + i * n;
+                float dV = 0.0f;
+                for (size_t j = 0; j < n; j++) {
+                    dV += row[j] * grid->P_inject[j];
+                }
+                grid->V[i] = grid->V_source + dV;
+            }
+            break;
+        case GRID_MODEL_RADIAL:
+            RadialFeeder_Solve(&grid->feeder, load_pu, pv_pu, grid->load_tan_phi,
+                               grid->storage_bus, grid->P_storage, n);
+            for (size_t i = 0; i < n; i++) {
+                grid->V[i] = RadialFeeder_Magnitude(&grid->feeder, grid->storage_bus[i]);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+int GridModel_Attach(SimulationState *sim, const GridModel *grid, uint32_t node) {
+    if (node >= grid->count) {
+        fprintf(stderr, "错误: 电网模型只有%zu个台区，无法挂接第%u个\n", grid->count, node);
+        return -1;
+    }
+    sim->grid = grid;
+    sim->grid_node = node;
+    return 0;
+}
+
+void GridModel_Print(const GridModel *grid, FILE *fp) {
+    static const char *const names[] = {"戴维南等效", "灵敏度矩阵", "辐射状馈线"};
+    fprintf(fp, "电网模型: %s, 台区数=%zu, 电源电压=%.1fV, 曲线点数=%zu(周期%.0fs)\n",
+            names[grid->type], grid->count, grid->V_source, grid->profile_count, grid->profile_period_s);
+    if (grid->type == GRID_MODEL_RADIAL) {
+        fprintf(fp, "  ");
+        RadialFeeder_PrintStats(&grid->feeder, fp);
+        return;
+    }
+
+    double load_total = 0.0;
+    double pv_total = 0.0;
+    for (size_t i = 0; i < grid->count; i++) {
+        load_total += grid->load_kw[i];
+        pv_total += grid->pv_kw[i];
+    }
+    fprintf(fp, "  负荷峰值合计=%.1fkW, 光伏峰值合计=%.1fkW\n", load_total, pv_total);
+    if (grid->type == GRID_MODEL_THEVENIN) {
+        fprintf(fp, "  R=%.4fΩ, X=%.4fΩ, 灵敏度=%.3fV/kW\n",
+                grid->R_ohm, grid->X_ohm, grid->R_ohm * 1000.0f / grid->V_nominal);
+    }
+}
@@ -0,0 +1,112 @@
+/*
+ * 文件：grid_model.h
+ * 功能：仿真用配电网电压模型，使储能功率反过来影响台区电压(闭环)
+ *
+ * 功能描述：
+ * 1. 电网模型由JSON文件描述，可选戴维南等效阻抗模型、电压-功率灵敏度矩阵模型
+ *    或辐射状馈线潮流模型(见radial_feeder.h，各储能接在馈线的指定母线上)
+ * 2. 各台区的注入功率 = 光伏出力 - 负荷 - 储能功率(充电为正)，负荷与光伏按日曲线变化，
+ *    日曲线可取内置的典型曲线，也可从CSV文件读入(time_s,load_pu,pv_pu，按标幺值插值)
+ * 3. 仿真循环每周期先写入各储能上一周期的实际功率，再求解全部台区电压；
+ *    挂接了电网模型的模拟数据源以求解结果代替正弦电压曲线
+ * 4. 求解过程不分配内存
+ */
+
+#ifndef VOLTAGE_CONTROL_GRID_MODEL_H
+#define VOLTAGE_CONTROL_GRID_MODEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include "voltage_control.h"
+#include "radial_feeder.h"
+
+#define GRID_DEFAULT_PROFILE_PERIOD_S 86400.0  // 负荷/光伏曲线默认周期 (s)
+
+/* ---------- 电网模型类型 ---------- */
+typedef enum {
+    GRID_MODEL_THEVENIN = 0,        // 各台区独立的戴维南等效电源 + 阻抗
+    GRID_MODEL_SENSITIVITY = 1,     // 电压-有功灵敏度矩阵，台区之间相互耦合
+    GRID_MODEL_RADIAL = 2           // 辐射状馈线前推回代潮流，各储能为馈线上的一个母线
+} GridModelType;
+
+/* ---------- 电网模型 ---------- */
+struct GridModel {
+    int type;                       // GridModelType
+    size_t count;                   // 台区(储能)数量
+    float V_source;                 // 等效电源电压，即零注入功率时的台区电压 (V)
+    float V_nominal;                // 额定电压，用于把阻抗换算为电压-功率灵敏度 (V)
+    float R_ohm;                    // 戴维南等效电阻 (Ω)
+    float X_ohm;                    // 戴维南等效电抗 (Ω)
+    float load_tan_phi;             // 负荷无功/有功之比，由负荷功率因数换算
+    float *sensitivity;             // 灵敏度矩阵 count*count，行主序，第i行第j列为台区j注入1kW时台区i的电压变化 (V/kW)
+    float *load_kw;                 // 各台区负荷峰值 (kW)
+    float *pv_kw;                   // 各台区光伏峰值 (kW)
+    float *P_storage;               // 各储能实际功率 (kW)，正为充电；由仿真循环在求解前写入
+    float *P_inject;                // 各台区注入有功功率 (kW)，求解时的中间结果
+    float *V;                       // 求解结果：各台区电压 (V)
+    double *profile_time_s;         // 负荷/光伏曲线各点时刻 (s)，严格递增
+    float *profile_load;            // 各点负荷标幺值
+    float *profile_pv;              // 各点光伏标幺值
+    size_t profile_count;           // 曲线点数
+    double profile_period_s;        // 曲线周期 (s)，最后一点之后回绕到第一点
+    float load_scale;               // 负荷整体倍数，加载后为1，整定时用于生成不同场景
+    float pv_scale;                 // 光伏整体倍数，加载后为1
+    RadialFeeder feeder;            // 辐射状馈线，仅GRID_MODEL_RADIAL时使用
+    uint32_t *storage_bus;          // 各储能所在母线的拓扑序下标，仅GRID_MODEL_RADIAL时使用
+    void *block;                    // 各台区数组共用的一次性内存分配
+};
+
+/**
+ * @brief 从JSON文件加载电网模型
+ *
+ * 文件格式示例见grid.json。"model"为"thevenin"时使用R_ohm/X_ohm/load_power_factor，
+ * 为"sensitivity"时须给出count行count列的"sensitivity"矩阵；为"radial"时"feeder"指定馈线CSV文件，
+ * "storage_bus"为长度count的母线编号数组，负荷与光伏取自馈线文件中各母线。其余两种模型的
+ * "load_kw"与"pv_kw"可为一个数(全部台区相同)或长度为count的数组。
+ * "profile"指定日曲线CSV文件，缺省使用内置曲线。
+ * @param grid [输出] 电网模型
+ * @param filename JSON文件路径
+ * @param count 台区数量
+ * @return int 成功返回0，失败返回-1(已输出错误信息)
+ */
+int GridModel_Load(GridModel *grid, const char *filename, size_t count);
+
+/**
+ * @brief 复制电网模型，供多个线程各自独立仿真(求解时会写入模型中的状态)
+ * @param dst [输出] 副本
+ * @param src 电网模型
+ * @return int 成功返回0，内存不足返回-1
+ */
+int GridModel_Clone(GridModel *dst, const GridModel *src);
+
+/**
+ * @brief 释放电网模型
+ * @param grid 电网模型
+ */
+void GridModel_Free(GridModel *grid);
+
+/**
+ * @brief 按P_storage中的储能功率求解time_s时刻全部台区的电压，结果写入V
+ * @param grid 电网模型
+ * @param time_s 仿真时刻 (s)，用于取负荷/光伏曲线
+ */
+void GridModel_Solve(GridModel *grid, double time_s);
+
+/**
+ * @brief 把模拟数据源挂接到电网模型的第node个台区，之后电压取自求解结果
+ * @param sim 模拟数据源状态
+ * @param grid 电网模型
+ * @param node 台区下标
+ * @return int 成功返回0，node超出范围返回-1
+ */
+int GridModel_Attach(SimulationState *sim, const GridModel *grid, uint32_t node);
+
+/**
+ * @brief 输出电网模型摘要(辐射状馈线模型同时输出潮流求解统计)
+ * @param grid 电网模型
+ * @param fp 输出流
+ */
+void GridModel_Print(const GridModel *grid, FILE *fp);
+
+#endif // VOLTAGE_CONTROL_GRID_MODEL_H
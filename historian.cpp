@@ -0,0 +1,693 @@
+/*
+ * 文件：historian.cpp
+ * 功能：控制器运行数据的列式历史库文件实现
+ */
+
+#include "historian.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#define HISTORIAN_ENCODE_BUF_SIZE (HISTORIAN_CHUNK_ROWS * 64 + 256) // 一个数据块编码后的长度上限
+
+const char *const HISTORIAN_COLUMN_NAMES[HISTORIAN_COL_COUNT] = {
+    "timestamp", "V_meas", "SOC", "P_meas", "P_soc_charge_limit", "P_soc_discharge_limit", "Ctrl_Mode", "P_cmd"
+};
+
+/* ---------- 变长整数 ---------- */
+
+static inline uint64_t ZigZag_Encode(int64_t v) {
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static inline int64_t ZigZag_Decode(uint64_t v) {
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+static inline size_t Varint_Put(uint8_t *p, uint64_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        p[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+// 读取一个变长整数，越界或超过10字节返回-1
+static inline int Varint_Get(const uint8_t *p, size_t len, size_t *pos, uint64_t *v) {
+    uint64_t result = 0;
+    for (int shift = 0; shift < 70 && *pos < len; shift += 7) {
+        uint8_t b = p[(*pos)++];
+        result |= (uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            *v = result;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/* ---------- 位流(高位在前) ---------- */
+
+typedef struct {
+    uint8_t *out;
+    size_t len;
+    uint64_t acc;               // 尚未写出的位，最多7 + 32位
+    int acc_bits;
+} BitWriter;
+
+static inline void Bits_Put(BitWriter *w, uint32_t value, int count) {
+    w->acc = (w->acc << count) | ((uint64_t)value & ((1ULL << count) - 1));
+    w->acc_bits += count;
+    while (w->acc_bits >= 8) {
+        w->acc_bits -= 8;
+        w->out[w->len++] = (uint8_t)(w->acc >> w->acc_bits);
+    }
+}
+
+static inline void Bits_Flush(BitWriter *w) {
+    if (w->acc_bits > 0) {
+        w->out[w->len++] = (uint8_t)(w->acc << (8 - w->acc_bits));
+        w->acc_bits = 0;
+    }
+}
+
+typedef struct {
+    const uint8_t *in;
+    size_t len;
+    size_t pos;
+    uint64_t acc;
+    int acc_bits;
+    int overrun;                // 读到了数据末尾之后
+} BitReader;
+
+static inline uint32_t Bits_Get(BitReader *r, int count) {
+    while (r->acc_bits < count) {
+        uint8_t b = 0;
+        if (r->pos < r->len) {
+            b = r->in[r->pos++];
+        } else {
+            r->overrun = 1;
+        }
+        r->acc = (r->acc << 8) | b;
+        r->acc_bits += 8;
+    }
+    r->acc_bits -= count;
+    return (uint32_t)((r->acc >> r->acc_bits) & ((1ULL << count) - 1));
+}
+
+static inline int Bits_LeadingZeros(uint32_t x) {
+#if defined(_MSC_VER)
+    unsigned long msb;
+    _BitScanReverse(&msb, x);
+    return 31 - (int)msb;
+#else
+    return __builtin_clz(x);
+#endif
+}
+
+static inline int Bits_TrailingZeros(uint32_t x) {
+#if defined(_MSC_VER)
+    unsigned long lsb;
+    _BitScanForward(&lsb, x);
+    return (int)lsb;
+#else
+    return __builtin_ctz(x);
+#endif
+}
+
+/* ---------- 列编码 ---------- */
+
+// 时间戳：首值、首个差分、其后的二阶差分，均为zigzag变长整数；等间隔时每行1字节
+static size_t Encode_Timestamps(const int64_t *ts, uint32_t rows, uint8_t *out) {
+    size_t len = Varint_Put(out, ZigZag_Encode(ts[0]));
+    int64_t prev_delta = 0;
+    for (uint32_t i = 1; i < rows; i++) {
+        int64_t delta = ts[i] - ts[i - 1];
+        len += Varint_Put(out + len, ZigZag_Encode(i == 1 ? delta : delta - prev_delta));
+        prev_delta = delta;
+    }
+    return len;
+}
+
+static int Decode_Timestamps(const uint8_t *in, size_t len, uint32_t rows, int64_t *ts) {
+    size_t pos = 0;
+    uint64_t v;
+    if (Varint_Get(in, len, &pos, &v) != 0) {
+        return -1;
+    }
+    ts[0] = ZigZag_Decode(v);
+    int64_t delta = 0;
+    for (uint32_t i = 1; i < rows; i++) {
+        if (Varint_Get(in, len, &pos, &v) != 0) {
+            return -1;
+        }
+        delta = (i == 1) ? ZigZag_Decode(v) : delta + ZigZag_Decode(v);
+        ts[i] = ts[i - 1] + delta;
+    }
+    return 0;
+}
+
+static inline uint32_t Float_Bits(float f) {
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+static inline float Float_FromBits(uint32_t u) {
+    float f;
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+// 浮点数XOR编码：与前值相同记1位'0'；否则记'10'+沿用上次有效位窗口，或'11'+5位前导零数+5位有效位长度-1+有效位
+static size_t Encode_Floats(const float *values, uint32_t rows, uint8_t *out) {
+    BitWriter w = {out, 0, 0, 0};
+    uint32_t prev = Float_Bits(values[0]);
+    Bits_Put(&w, prev, 32);
+    int window_lead = -1;
+    int window_trail = 0;
+
+    for (uint32_t i = 1; i < rows; i++) {
+        uint32_t cur = Float_Bits(values[i]);
+        uint32_t x = cur ^ prev;
+        prev = cur;
+        if (x == 0) {
+            Bits_Put(&w, 0, 1);
+            continue;
+        }
+        int lead = Bits_LeadingZeros(x);
+        int trail = Bits_TrailingZeros(x);
+        if (window_lead >= 0 && lead >= window_lead && trail >= window_trail) {
+            Bits_Put(&w, 2, 2);
+            Bits_Put(&w, x >> window_trail, 32 - window_lead - window_trail);
+        } else {
+            int meaningful = 32 - lead - trail;
+            Bits_Put(&w, 3, 2);
+            Bits_Put(&w, (uint32_t)lead, 5);
+            Bits_Put(&w, (uint32_t)(meaningful - 1), 5);
+            Bits_Put(&w, x >> trail, meaningful);
+            window_lead = lead;
+            window_trail = trail;
+        }
+    }
+    Bits_Flush(&w);
+    return w.len;
+}
+
+static int Decode_Floats(const uint8_t *in, size_t len, uint32_t rows, float *values) {
+    BitReader r = {in, len, 0, 0, 0, 0};
+    uint32_t prev = Bits_Get(&r, 32);
+    values[0] = Float_FromBits(prev);
+    int window_lead = 0;
+    int window_trail = 0;
+
+    for (uint32_t i = 1; i < rows; i++) {
+        if (Bits_Get(&r, 1) != 0) {
+            if (Bits_Get(&r, 1) != 0) {
+                window_lead = (int)Bits_Get(&r, 5);
+                int meaningful = (int)Bits_Get(&r, 5) + 1;
+                window_trail = 32 - window_lead - meaningful;
+                if (window_trail < 0) {
+                    return -1;
+                }
+            }
+            prev ^= Bits_Get(&r, 32 - window_lead - window_trail) << window_trail;
+        }
+        values[i] = Float_FromBits(prev);
+    }
+    return r.overrun ? -1 : 0;
+}
+
+// 控制模式：游程编码，(zigzag值, 游程长度)成对的变长整数
+static size_t Encode_Modes(const float *values, uint32_t rows, uint8_t *out) {
+    size_t len = 0;
+    uint32_t i = 0;
+    while (i < rows) {
+        int64_t mode = (int64_t)values[i];
+        uint32_t run = 1;
+        while (i + run < rows && (int64_t)values[i + run] == mode) {
+            run++;
+        }
+        len += Varint_Put(out + len, ZigZag_Encode(mode));
+        len += Varint_Put(out + len, run);
+        i += run;
+    }
+    return len;
+}
+
+static int Decode_Modes(const uint8_t *in, size_t len, uint32_t rows, float *values) {
+    size_t pos = 0;
+    uint32_t i = 0;
+    while (i < rows) {
+        uint64_t mode;
+        uint64_t run;
+        if (Varint_Get(in, len, &pos, &mode) != 0 || Varint_Get(in, len, &pos, &run) != 0
+            || run == 0 || run > rows - i) {
+            return -1;
+        }
+        float value = (float)ZigZag_Decode(mode);
+        for (uint64_t k = 0; k < run; k++) {
+            values[i++] = value;
+        }
+    }
+    return 0;
+}
+
+/* ---------- 写入器 ---------- */
+
+int HistorianWriter_Init(HistorianWriter *writer, FILE *out) {
+    memset(writer, 0, sizeof(*writer));
+    writer->out = out;
+    writer->encode_buf = (uint8_t *)malloc(HISTORIAN_ENCODE_BUF_SIZE);
+    if (!writer->encode_buf) {
+        fprintf(stderr, "错误: 内存分配失败\n");
+        return -1;
+    }
+
+    HistorianFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, HISTORIAN_MAGIC, sizeof(header.magic));
+    header.version = HISTORIAN_VERSION;
+    header.column_count = HISTORIAN_COL_COUNT;
+    if (fwrite(&header, sizeof(header), 1, out) != 1) {
+        fprintf(stderr, "错误: 写入历史库文件头失败\n");
+        free(writer->encode_buf);
+        writer->encode_buf = NULL;
+        return -1;
+    }
+    writer->bytes_written = sizeof(header);
+
+    // 索引项先暂存到临时文件，写入器不必在内存中保留全部块头
+    writer->index = tmpfile();
+    if (!writer->index) {
+        fprintf(stderr, "警告: 无法创建历史库索引临时文件，文件尾不写索引，读取时将逐块扫描\n");
+    }
+    return 0;
+}
+
+// 把一个台区缓存的记录编码为一个数据块写出
+static int HistorianWriter_FlushSeries(HistorianWriter *writer, int32_t area_id, HistorianSeries *s) {
+    HistorianChunkHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = HISTORIAN_CHUNK_MAGIC;
+    header.area_id = area_id;
+    header.row_count = s->rows;
+
+    header.ts_min = s->timestamp_ns[0];
+    header.ts_max = s->timestamp_ns[0];
+    for (uint32_t i = 1; i < s->rows; i++) {
+        if (s->timestamp_ns[i] < header.ts_min) header.ts_min = s->timestamp_ns[i];
+        if (s->timestamp_ns[i] > header.ts_max) header.ts_max = s->timestamp_ns[i];
+    }
+
+    uint8_t *buf = writer->encode_buf;
+    size_t len = Encode_Timestamps(s->timestamp_ns, s->rows, buf);
+    for (int c = 0; c < HISTORIAN_VALUE_COLUMNS; c++) {
+        const float *values = s->values[c];
+        header.column_offset[c + 1] = (uint32_t)len;
+        if (c + 1 == HISTORIAN_COL_CTRL_MODE) {
+            len += Encode_Modes(values, s->rows, buf + len);
+        } else {
+            len += Encode_Floats(values, s->rows, buf + len);
+        }
+
+        // NaN不参与统计，全为NaN时最小值为+inf、最大值为-inf，任何数值范围都不会命中
+        float lo = INFINITY;
+        float hi = -INFINITY;
+        for (uint32_t i = 0; i < s->rows; i++) {
+            if (values[i] < lo) lo = values[i];
+            if (values[i] > hi) hi = values[i];
+        }
+        header.min[c] = lo;
+        header.max[c] = hi;
+    }
+    header.payload_size = (uint32_t)len;
+
+    s->rows = 0;
+    if (fwrite(&header, sizeof(header), 1, writer->out) != 1 || fwrite(buf, 1, len, writer->out) != len) {
+        if (!writer->failed) {
+            fprintf(stderr, "错误: 写入历史库数据块失败\n");
+        }
+        writer->failed = 1;
+        return -1;
+    }
+    if (writer->index) {
+        HistorianChunk entry;
+        entry.offset = writer->bytes_written;
+        entry.header = header;
+        if (fwrite(&entry, sizeof(entry), 1, writer->index) != 1) {
+            fprintf(stderr, "警告: 写入历史库索引临时文件失败，文件尾不写索引\n");
+            fclose(writer->index);
+            writer->index = NULL;
+        }
+    }
+    writer->rows_written += header.row_count;
+    writer->chunks_written++;
+    writer->bytes_written += sizeof(header) + len;
+    return 0;
+}
+
+int HistorianWriter_Append(HistorianWriter *writer, const TelemetryRecord *record) {
+    if (record->area_id < 0) {
+        fprintf(stderr, "错误: 台区编号%d非法，历史库不记录\n", record->area_id);
+        return -1;
+    }
+
+    size_t area = (size_t)record->area_id;
+    if (area >= writer->series_count) {
+        size_t count = writer->series_count ? writer->series_count : 16;
+        while (count <= area) {
+            count *= 2;
+        }
+        HistorianSeries **series = (HistorianSeries **)realloc(writer->series, count * sizeof(HistorianSeries *));
+        if (!series) {
+            fprintf(stderr, "错误: 内存分配失败\n");
+            return -1;
+        }
+        memset(series + writer->series_count, 0, (count - writer->series_count) * sizeof(HistorianSeries *));
+        writer->series = series;
+        writer->series_count = count;
+    }
+    HistorianSeries *s = writer->series[area];
+    if (!s) {
+        s = (HistorianSeries *)malloc(sizeof(HistorianSeries));
+        if (!s) {
+            fprintf(stderr, "错误: 内存分配失败\n");
+            return -1;
+        }
+        s->rows = 0;
+        writer->series[area] = s;
+    }
+
+    uint32_t row = s->rows++;
+    s->timestamp_ns[row] = record->timestamp_ns;
+    s->values[HISTORIAN_COL_V_MEAS - 1][row] = record->V_meas;
+    s->values[HISTORIAN_COL_SOC - 1][row] = record->SOC;
+    s->values[HISTORIAN_COL_P_MEAS - 1][row] = record->P_meas;
+    s->values[HISTORIAN_COL_P_SOC_CHARGE_LIMIT - 1][row] = record->P_soc_charge_limit;
+    s->values[HISTORIAN_COL_P_SOC_DISCHARGE_LIMIT - 1][row] = record->P_soc_discharge_limit;
+    s->values[HISTORIAN_COL_CTRL_MODE - 1][row] = (float)record->Ctrl_Mode;
+    s->values[HISTORIAN_COL_P_CMD - 1][row] = record->P_cmd;
+
+    if (s->rows == HISTORIAN_CHUNK_ROWS) {
+        return HistorianWriter_FlushSeries(writer, record->area_id, s);
+    }
+    return 0;
+}
+
+// 把暂存的索引项按8字节对齐拷贝到文件末尾，再写出文件尾
+static int HistorianWriter_WriteFooter(HistorianWriter *writer) {
+    static const uint8_t padding[8] = {0};
+    size_t pad = (size_t)((8 - writer->bytes_written % 8) % 8);
+    if (pad && fwrite(padding, 1, pad, writer->out) != pad) {
+        return -1;
+    }
+    writer->bytes_written += pad;
+
+    HistorianFooter footer;
+    memset(&footer, 0, sizeof(footer));
+    memcpy(footer.magic, HISTORIAN_FOOTER_MAGIC, sizeof(footer.magic));
+    footer.index_offset = writer->bytes_written;
+    footer.chunk_count = writer->chunks_written;
+    footer.rows = writer->rows_written;
+
+    // 编码缓冲区此时已空闲，用作拷贝缓冲区
+    if (fflush(writer->index) != 0 || fseek(writer->index, 0, SEEK_SET) != 0) {
+        return -1;
+    }
+    uint64_t remaining = writer->chunks_written * sizeof(HistorianChunk);
+    while (remaining > 0) {
+        size_t len = remaining < HISTORIAN_ENCODE_BUF_SIZE ? (size_t)remaining : HISTORIAN_ENCODE_BUF_SIZE;
+        if (fread(writer->encode_buf, 1, len, writer->index) != len
+            || fwrite(writer->encode_buf, 1, len, writer->out) != len) {
+            return -1;
+        }
+        remaining -= len;
+        writer->bytes_written += len;
+    }
+    if (fwrite(&footer, sizeof(footer), 1, writer->out) != 1) {
+        return -1;
+    }
+    writer->bytes_written += sizeof(footer);
+    return 0;
+}
+
+int HistorianWriter_Finish(HistorianWriter *writer) {
+    for (size_t i = 0; i < writer->series_count; i++) {
+        HistorianSeries *s = writer->series[i];
+        if (s && s->rows > 0) {
+            HistorianWriter_FlushSeries(writer, (int32_t)i, s);
+        }
+        free(s);
+    }
+    free(writer->series);
+    writer->series = NULL;
+    writer->series_count = 0;
+
+    if (writer->index) {
+        if (!writer->failed && HistorianWriter_WriteFooter(writer) != 0) {
+            fprintf(stderr, "错误: 写入历史库文件尾索引失败\n");
+            writer->failed = 1;
+        }
+        fclose(writer->index);
+        writer->index = NULL;
+    }
+    free(writer->encode_buf);
+    writer->encode_buf = NULL;
+    if (fflush(writer->out) != 0) {
+        writer->failed = 1;
+    }
+    return writer->failed ? -1 : 0;
+}
+
+void HistorianWriter_PrintStats(const HistorianWriter *writer, FILE *fp) {
+    fprintf(fp, "历史库: 行数=%llu, 数据块=%llu, 文件大小=%.2fMB, 平均每行%.2f字节(原始记录%zu字节)%s\n",
+            (unsigned long long)writer->rows_written, (unsigned long long)writer->chunks_written,
+            (double)writer->bytes_written / (1024.0 * 1024.0),
+            writer->rows_written ? (double)writer->bytes_written / (double)writer->rows_written : 0.0,
+            sizeof(TelemetryRecord), writer->failed ? ", 写入失败" : "");
+}
+
+/* ---------- 读取器 ---------- */
+
+// 检查块头的行数与列偏移是否自洽
+static int Chunk_Validate(const HistorianChunkHeader *header) {
+    if (header->row_count == 0 || header->row_count > HISTORIAN_CHUNK_ROWS || header->column_offset[0] != 0) {
+        return -1;
+    }
+    for (int c = 1; c < HISTORIAN_COL_COUNT; c++) {
+        if (header->column_offset[c] < header->column_offset[c - 1]) {
+            return -1;
+        }
+    }
+    return header->column_offset[HISTORIAN_COL_COUNT - 1] <= header->payload_size ? 0 : -1;
+}
+
+// 检查文件尾索引，有效时让chunks直接指向映射区中的索引
+static int Reader_UseFooter(HistorianReader *reader) {
+    if (reader->file_size < sizeof(HistorianFileHeader) + sizeof(HistorianFooter)) {
+        return -1;
+    }
+    HistorianFooter footer;
+    memcpy(&footer, reader->file.data + reader->file_size - sizeof(footer), sizeof(footer));
+    uint64_t index_end = reader->file_size - sizeof(footer);
+    if (memcmp(footer.magic, HISTORIAN_FOOTER_MAGIC, sizeof(footer.magic)) != 0
+        || footer.index_offset < sizeof(HistorianFileHeader) || footer.index_offset > index_end
+        || footer.index_offset % 8 != 0 || footer.chunk_count > SIZE_MAX / sizeof(HistorianChunk)
+        || (index_end - footer.index_offset) != footer.chunk_count * sizeof(HistorianChunk)) {
+        return -1;
+    }
+    reader->chunks = (const HistorianChunk *)(reader->file.data + footer.index_offset);
+    reader->chunk_count = (size_t)footer.chunk_count;
+    reader->rows = footer.rows;
+    reader->data_end = footer.index_offset;
+    return 0;
+}
+
+// 没有文件尾索引时依次扫描块头，到不完整或损坏的数据块为止
+static int Reader_ScanChunks(HistorianReader *reader, const char *filename) {
+    size_t capacity = 0;
+    uint64_t offset = sizeof(HistorianFileHeader);
+    while (offset < reader->file_size) {
+        HistorianChunk chunk;
+        chunk.offset = offset;
+        if (reader->file_size - offset < sizeof(HistorianChunkHeader)) {
+            fprintf(stderr, "警告: 历史库文件 %s 末尾有不完整的数据块(偏移%llu)，已忽略\n", filename,
+                    (unsigned long long)offset);
+            break;
+        }
+        memcpy(&chunk.header, reader->file.data + offset, sizeof(chunk.header));
+        if (reader->file_size - offset - sizeof(HistorianChunkHeader) < chunk.header.payload_size) {
+            fprintf(stderr, "警告: 历史库文件 %s 末尾有不完整的数据块(偏移%llu)，已忽略\n", filename,
+                    (unsigned long long)offset);
+            break;
+        }
+        if (chunk.header.magic != HISTORIAN_CHUNK_MAGIC || Chunk_Validate(&chunk.header) != 0) {
+            fprintf(stderr, "警告: 历史库文件 %s 在偏移%llu处损坏，之后的数据已忽略\n", filename,
+                    (unsigned long long)offset);
+            break;
+        }
+
+        if (reader->chunk_count == capacity) {
+            capacity = capacity ? capacity * 2 : 1024;
+            HistorianChunk *chunks =
+                (HistorianChunk *)realloc(reader->scanned_chunks, capacity * sizeof(HistorianChunk));
+            if (!chunks) {
+                fprintf(stderr, "错误: 内存分配失败\n");
+                return -1;
+            }
+            reader->scanned_chunks = chunks;
+        }
+        reader->scanned_chunks[reader->chunk_count++] = chunk;
+        reader->rows += chunk.header.row_count;
+        offset += sizeof(HistorianChunkHeader) + chunk.header.payload_size;
+    }
+    reader->chunks = reader->scanned_chunks;
+    reader->data_end = offset < reader->file_size ? offset : reader->file_size;
+    return 0;
+}
+
+int HistorianReader_Open(HistorianReader *reader, const char *filename) {
+    memset(reader, 0, sizeof(*reader));
+    if (MappedFile_Open(&reader->file, filename) != 0) {
+        return -1;
+    }
+    reader->file_size = reader->file.size;
+
+    HistorianFileHeader header;
+    if (reader->file_size < sizeof(header)) {
+        fprintf(stderr, "错误: %s 不是历史库文件\n", filename);
+        HistorianReader_Close(reader);
+        return -1;
+    }
+    memcpy(&header, reader->file.data, sizeof(header));
+    if (memcmp(header.magic, HISTORIAN_MAGIC, sizeof(header.magic)) != 0 || header.version < 1
+        || header.version > HISTORIAN_VERSION || header.column_count != HISTORIAN_COL_COUNT) {
+        fprintf(stderr, "错误: %s 不是版本1~%d的历史库文件\n", filename, HISTORIAN_VERSION);
+        HistorianReader_Close(reader);
+        return -1;
+    }
+
+    if (Reader_UseFooter(reader) != 0 && Reader_ScanChunks(reader, filename) != 0) {
+        HistorianReader_Close(reader);
+        return -1;
+    }
+    return 0;
+}
+
+void HistorianReader_Close(HistorianReader *reader) {
+    MappedFile_Close(&reader->file);
+    free(reader->scanned_chunks);
+    memset(reader, 0, sizeof(*reader));
+}
+
+// 返回映射区中一个数据块的一列；文件尾索引未逐项检查，使用前在此检查块头与范围
+static const uint8_t *Reader_LoadColumn(HistorianReader *reader, size_t chunk, int column, size_t *len) {
+    const HistorianChunk *c = &reader->chunks[chunk];
+    if (c->header.magic != HISTORIAN_CHUNK_MAGIC || Chunk_Validate(&c->header) != 0
+        || c->offset > reader->data_end
+        || reader->data_end - c->offset < sizeof(HistorianChunkHeader) + (uint64_t)c->header.payload_size) {
+        fprintf(stderr, "错误: 历史库数据块索引损坏(偏移%llu)\n", (unsigned long long)c->offset);
+        return NULL;
+    }
+    uint32_t begin = c->header.column_offset[column];
+    uint32_t end = column + 1 < HISTORIAN_COL_COUNT ? c->header.column_offset[column + 1] : c->header.payload_size;
+    *len = end - begin;
+    return (const uint8_t *)reader->file.data + c->offset + sizeof(HistorianChunkHeader) + begin;
+}
+
+int HistorianReader_ReadTimestamps(HistorianReader *reader, size_t chunk, int64_t *out) {
+    size_t len;
+    const uint8_t *data = Reader_LoadColumn(reader, chunk, HISTORIAN_COL_TIMESTAMP, &len);
+    if (!data) {
+        return -1;
+    }
+    if (Decode_Timestamps(data, len, reader->chunks[chunk].header.row_count, out) != 0) {
+        fprintf(stderr, "错误: 历史库数据块时间戳列损坏(偏移%llu)\n", (unsigned long long)reader->chunks[chunk].offset);
+        return -1;
+    }
+    return 0;
+}
+
+int HistorianReader_ReadColumn(HistorianReader *reader, size_t chunk, int column, float *out) {
+    if (column <= HISTORIAN_COL_TIMESTAMP || column >= HISTORIAN_COL_COUNT) {
+        fprintf(stderr, "错误: 列号%d不是数值列\n", column);
+        return -1;
+    }
+    size_t len;
+    const uint8_t *data = Reader_LoadColumn(reader, chunk, column, &len);
+    if (!data) {
+        return -1;
+    }
+    uint32_t rows = reader->chunks[chunk].header.row_count;
+    int ret = column == HISTORIAN_COL_CTRL_MODE ? Decode_Modes(data, len, rows, out)
+                                                : Decode_Floats(data, len, rows, out);
+    if (ret != 0) {
+        fprintf(stderr, "错误: 历史库数据块%s列损坏(偏移%llu)\n", HISTORIAN_COLUMN_NAMES[column],
+                (unsigned long long)reader->chunks[chunk].offset);
+    }
+    return ret;
+}
+
+void HistorianQuery_Init(HistorianQuery *query, int column) {
+    query->column = column;
+    query->area_id = -1;
+    query->ts_from = INT64_MIN;
+    query->ts_to = INT64_MAX;
+    query->value_lo = -INFINITY;
+    query->value_hi = INFINITY;
+}
+
+int HistorianReader_Scan(HistorianReader *reader, const HistorianQuery *query, HistorianScanFn fn, void *user,
+                         HistorianScanStats *stats) {
+    // 块头的min/max按数值列下标访问，须先检查列号
+    if (query->column <= HISTORIAN_COL_TIMESTAMP || query->column >= HISTORIAN_COL_COUNT) {
+        fprintf(stderr, "错误: 列号%d不是数值列\n", query->column);
+        return -1;
+    }
+    HistorianScanStats local = {0, 0, 0};
+    int64_t timestamps[HISTORIAN_CHUNK_ROWS];
+    float values[HISTORIAN_CHUNK_ROWS];
+    int value_index = query->column - 1;
+
+    for (size_t i = 0; i < reader->chunk_count; i++) {
+        const HistorianChunkHeader *h = &reader->chunks[i].header;
+        if ((query->area_id >= 0 && h->area_id != query->area_id)
+            || h->ts_max < query->ts_from || h->ts_min > query->ts_to
+            || !(h->max[value_index] >= query->value_lo && h->min[value_index] <= query->value_hi)) {
+            local.chunks_skipped++;
+            continue;
+        }
+        if (HistorianReader_ReadColumn(reader, i, query->column, values) != 0
+            || HistorianReader_ReadTimestamps(reader, i, timestamps) != 0) {
+            return -1;
+        }
+        local.chunks_scanned++;
+        for (uint32_t r = 0; r < h->row_count; r++) {
+            if (timestamps[r] >= query->ts_from && timestamps[r] <= query->ts_to
+                && values[r] >= query->value_lo && values[r] <= query->value_hi) {
+                local.rows_matched++;
+                fn(user, h->area_id, timestamps[r], values[r]);
+            }
+        }
+    }
+    if (stats) {
+        *stats = local;
+    }
+    return 0;
+}
+
+int Historian_FindColumn(const char *name) {
+    for (int c = 0; c < HISTORIAN_COL_COUNT; c++) {
+        if (strcmp(name, HISTORIAN_COLUMN_NAMES[c]) == 0) {
+            return c;
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,237 @@
+/*
+ * 文件：historian.h
+ * 功能：控制器运行数据的列式历史库文件
+ *
+ * 功能描述：
+ * 1. 只追加写入：每个台区的记录先缓存在内存中，攒满一个数据块(HISTORIAN_CHUNK_ROWS行)
+ *    后按列编码写出；正常结束时在文件末尾追加全部块头组成的索引和文件尾
+ * 2. 轻量压缩：时间戳用二阶差分+zigzag变长整数，浮点列用XOR(Gorilla)位编码，
+ *    控制模式用游程编码；1s周期的稳定数据每行约十几个字节，远小于文本输出
+ * 3. 每个数据块头记录台区、行数、时间范围、各列的最小/最大值及列偏移，
+ *    读取时按台区、时间或数值范围跳过无关数据块，命中的数据块也只解码所需的列
+ * 4. 读取器映射整个文件，直接使用文件尾的索引，打开文件不随数据块数增加读取次数或内存；
+ *    没有索引的文件(如进程被强制结束)退回逐块扫描块头，末尾不完整的数据块被忽略
+ */
+
+#ifndef VOLTAGE_CONTROL_HISTORIAN_H
+#define VOLTAGE_CONTROL_HISTORIAN_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include "mapped_file.h"
+#include "telemetry_log.h"
+
+#define HISTORIAN_MAGIC "VCHIST1"           // 文件头魔数(含结尾'\0'共8字节)
+#define HISTORIAN_VERSION 2                 // 版本2增加文件尾索引，仍可读取版本1的文件
+#define HISTORIAN_FOOTER_MAGIC "VCHIDX1"    // 文件尾魔数(含结尾'\0'共8字节)
+#define HISTORIAN_CHUNK_MAGIC 0x4B4E4843u   // 数据块头魔数"CHNK"
+#define HISTORIAN_CHUNK_ROWS 1024           // 每个数据块的最大行数
+
+/* ---------- 列 ---------- */
+typedef enum {
+    HISTORIAN_COL_TIMESTAMP = 0,            // 记录时刻 (ns)
+    HISTORIAN_COL_V_MEAS,                   // 电压测量值 (V)
+    HISTORIAN_COL_SOC,                      // SOC
+    HISTORIAN_COL_P_MEAS,                   // PCS当前功率 (kW)
+    HISTORIAN_COL_P_SOC_CHARGE_LIMIT,       // SOC充电功率限值 (kW)
+    HISTORIAN_COL_P_SOC_DISCHARGE_LIMIT,    // SOC放电功率限值 (kW)
+    HISTORIAN_COL_CTRL_MODE,                // 控制模式
+    HISTORIAN_COL_P_CMD,                    // 有功功率指令 (kW)
+    HISTORIAN_COL_COUNT
+} HistorianColumn;
+
+#define HISTORIAN_VALUE_COLUMNS (HISTORIAN_COL_COUNT - 1)  // 时间戳以外的数值列数
+
+extern const char *const HISTORIAN_COLUMN_NAMES[HISTORIAN_COL_COUNT];
+
+/* ---------- 文件头(16字节) ---------- */
+typedef struct {
+    char magic[8];                  // HISTORIAN_MAGIC
+    uint32_t version;               // HISTORIAN_VERSION
+    uint32_t column_count;          // HISTORIAN_COL_COUNT
+} HistorianFileHeader;
+
+/* ---------- 数据块头(128字节)，其后紧跟payload_size字节的列数据 ---------- */
+typedef struct {
+    uint32_t magic;                                 // HISTORIAN_CHUNK_MAGIC
+    int32_t area_id;                                // 台区编号
+    uint32_t row_count;                             // 行数
+    uint32_t payload_size;                          // 列数据总长度 (字节)
+    uint32_t column_offset[HISTORIAN_COL_COUNT];    // 各列在列数据中的起始偏移，按列顺序排列
+    int64_t ts_min;                                 // 最早时间戳
+    int64_t ts_max;                                 // 最晚时间戳
+    float min[HISTORIAN_VALUE_COLUMNS];             // 各数值列最小值(下标为列号-1)
+    float max[HISTORIAN_VALUE_COLUMNS];             // 各数值列最大值
+    uint32_t reserved[2];
+} HistorianChunkHeader;
+
+/* ---------- 索引项：数据块头及其在文件中的偏移(136字节) ---------- */
+typedef struct {
+    uint64_t offset;                // 数据块头在文件中的偏移
+    HistorianChunkHeader header;    // 数据块头
+} HistorianChunk;
+
+/* ---------- 文件尾(32字节)：其前紧挨着按文件顺序排列的chunk_count个索引项 ---------- */
+typedef struct {
+    char magic[8];                  // HISTORIAN_FOOTER_MAGIC
+    uint64_t index_offset;          // 索引在文件中的偏移，按8字节对齐
+    uint64_t chunk_count;           // 数据块数
+    uint64_t rows;                  // 总行数
+} HistorianFooter;
+
+static_assert(sizeof(HistorianFileHeader) == 16, "HistorianFileHeader必须为16字节");
+static_assert(sizeof(HistorianChunkHeader) == 128, "HistorianChunkHeader必须为128字节");
+static_assert(sizeof(HistorianChunk) == 136, "HistorianChunk必须为136字节");
+static_assert(sizeof(HistorianFooter) == 32, "HistorianFooter必须为32字节");
+
+/* ---------- 单个台区尚未写出的记录(按列存放) ---------- */
+typedef struct {
+    int64_t timestamp_ns[HISTORIAN_CHUNK_ROWS];
+    float values[HISTORIAN_VALUE_COLUMNS][HISTORIAN_CHUNK_ROWS];
+    uint32_t rows;
+} HistorianSeries;
+
+/* ---------- 写入器(单线程使用) ---------- */
+struct HistorianWriter {
+    FILE *out;                      // 输出流，由调用者打开和关闭
+    FILE *index;                    // 已写出数据块的索引项暂存文件，结束时拷贝到文件尾；NULL表示不写索引
+    HistorianSeries **series;       // 按台区编号索引的缓存，按需分配
+    size_t series_count;            // series数组长度
+    uint8_t *encode_buf;            // 数据块编码缓冲区
+    uint64_t rows_written;          // 已写出的行数
+    uint64_t chunks_written;        // 已写出的数据块数
+    uint64_t bytes_written;         // 已写出的字节数(含文件头)
+    int failed;                     // 曾经写入失败
+};
+
+/**
+ * @brief 初始化写入器并写出文件头
+ * @param writer 写入器
+ * @param out 输出流，须以"wb"打开
+ * @return int 成功返回0，失败返回-1
+ */
+int HistorianWriter_Init(HistorianWriter *writer, FILE *out);
+
+/**
+ * @brief 追加一条记录，所属台区攒满一个数据块时编码写出
+ * @param writer 写入器
+ * @param record 遥测记录(cycle字段不保存)
+ * @return int 成功返回0，台区编号为负、内存不足或写入失败返回-1
+ */
+int HistorianWriter_Append(HistorianWriter *writer, const TelemetryRecord *record);
+
+/**
+ * @brief 写出全部台区未满的数据块和文件尾索引并释放写入器，不关闭输出流
+ * @param writer 写入器
+ * @return int 全部数据成功写出返回0，否则返回-1
+ */
+int HistorianWriter_Finish(HistorianWriter *writer);
+
+/**
+ * @brief 输出写入统计
+ * @param writer 写入器
+ * @param fp 输出流
+ */
+void HistorianWriter_PrintStats(const HistorianWriter *writer, FILE *fp);
+
+/* ---------- 读取器 ---------- */
+typedef struct {
+    MappedFile file;                // 映射的历史库文件
+    const HistorianChunk *chunks;   // 全部完整数据块，按文件顺序；指向映射区中的索引或scanned_chunks
+    size_t chunk_count;
+    HistorianChunk *scanned_chunks; // 没有文件尾索引时逐块扫描得到的索引
+    uint64_t data_end;              // 数据块区的结束偏移
+    uint64_t rows;                  // 总行数
+    uint64_t file_size;             // 文件长度 (字节)
+} HistorianReader;
+
+/**
+ * @brief 映射历史库文件并取得数据块索引，有文件尾索引时不读取任何数据块
+ * @param reader 读取器
+ * @param filename 文件名
+ * @return int 成功返回0，失败返回-1
+ */
+int HistorianReader_Open(HistorianReader *reader, const char *filename);
+
+/**
+ * @brief 解除映射并释放索引
+ * @param reader 读取器
+ */
+void HistorianReader_Close(HistorianReader *reader);
+
+/**
+ * @brief 读取并解码一个数据块的时间戳列
+ * @param reader 读取器
+ * @param chunk 数据块下标
+ * @param out [输出] 时间戳，长度不小于该块行数
+ * @return int 成功返回0，失败返回-1
+ */
+int HistorianReader_ReadTimestamps(HistorianReader *reader, size_t chunk, int64_t *out);
+
+/**
+ * @brief 读取并解码一个数据块的一个数值列(控制模式以浮点数返回)
+ * @param reader 读取器
+ * @param chunk 数据块下标
+ * @param column 列，不能是HISTORIAN_COL_TIMESTAMP
+ * @param out [输出] 数值，长度不小于该块行数
+ * @return int 成功返回0，失败返回-1
+ */
+int HistorianReader_ReadColumn(HistorianReader *reader, size_t chunk, int column, float *out);
+
+/**
+ * @brief 扫描回调
+ * @param user 调用者数据
+ * @param area_id 台区编号
+ * @param timestamp_ns 记录时刻
+ * @param value 列值
+ */
+typedef void (*HistorianScanFn)(void *user, int32_t area_id, int64_t timestamp_ns, float value);
+
+/* ---------- 扫描条件 ---------- */
+typedef struct {
+    int column;                     // 数值列
+    int32_t area_id;                // 台区编号，负数表示全部台区
+    int64_t ts_from;                // 时间范围 [ts_from, ts_to]
+    int64_t ts_to;
+    float value_lo;                 // 数值范围 [value_lo, value_hi]
+    float value_hi;
+} HistorianQuery;
+
+/* ---------- 扫描统计 ---------- */
+typedef struct {
+    uint64_t chunks_scanned;        // 解码的数据块数
+    uint64_t chunks_skipped;        // 按块头跳过的数据块数
+    uint64_t rows_matched;          // 满足条件的行数
+} HistorianScanStats;
+
+/**
+ * @brief 初始化扫描条件为某一列的全部数据
+ * @param query [输出] 扫描条件
+ * @param column 数值列
+ */
+void HistorianQuery_Init(HistorianQuery *query, int column);
+
+/**
+ * @brief 按条件扫描一列，对每个满足条件的行调用fn
+ *
+ * 台区、时间范围或[最小值, 最大值]与条件不相交的数据块只看块头即跳过，
+ * 命中的数据块只读取时间戳列与目标列。
+ * @param reader 读取器
+ * @param query 扫描条件
+ * @param fn 回调
+ * @param user 回调的调用者数据
+ * @param stats [输出] 扫描统计，可为NULL
+ * @return int 成功返回0，列号不是数值列或读取失败返回-1
+ */
+int HistorianReader_Scan(HistorianReader *reader, const HistorianQuery *query, HistorianScanFn fn, void *user,
+                         HistorianScanStats *stats);
+
+/**
+ * @brief 按名称查找列
+ * @param name 列名，与HISTORIAN_COLUMN_NAMES相同
+ * @return int 列号，找不到返回-1
+ */
+int Historian_FindColumn(const char *name);
+
+#endif // VOLTAGE_CONTROL_HISTORIAN_H
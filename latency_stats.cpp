@@ -0,0 +1,178 @@
+/*
+ * 文件：latency_stats.cpp
+ * 功能：控制周期分阶段耗时统计实现
+ */
+
+#include "latency_stats.h"
+
+#include <cstdlib>
+#include <cstring>
+
+static const char *LATENCY_STAGE_NAMES[LATENCY_STAGE_COUNT] = {
+    "acquisition",
+    "soc_limits",
+    "mode_decision",
+    "pi_compute",
+    "command_output",
+    "cycle_total",
+};
+
+// 桶内最大耗时值 (ns)
+static uint64_t Bucket_UpperBound(int index) {
+    int group = index / LATENCY_SUB_BUCKETS;
+    int sub = index % LATENCY_SUB_BUCKETS;
+    if (group == 0) {
+        return (uint64_t)sub;
+    }
+    int shift = group - 1;
+    uint64_t lower = (uint64_t)(LATENCY_SUB_BUCKETS + sub) << shift;
+    return lower + ((uint64_t)1 << shift) - 1;
+}
+
+void LatencyHistogram_Reset(LatencyHistogram *hist) {
+    for (int i = 0; i < LATENCY_BUCKET_COUNT; i++) {
+        hist->counts[i].store(0, std::memory_order_relaxed);
+    }
+    hist->sum_ns.store(0, std::memory_order_relaxed);
+    hist->min_ns.store(UINT64_MAX, std::memory_order_relaxed);
+    hist->max_ns.store(0, std::memory_order_relaxed);
+    hist->total_count.store(0, std::memory_order_release);
+}
+
+uint64_t LatencyHistogram_Percentile(const LatencyHistogram *hist, double percentile) {
+    uint64_t total = hist->total_count.load(std::memory_order_acquire);
+    if (total == 0) {
+        return 0;
+    }
+
+    // 第target个样本(从1计)所在的桶即为该百分位
+    uint64_t target = (uint64_t)(percentile / 100.0 * (double)total + 0.5);
+    if (target < 1) target = 1;
+    if (target > total) target = total;
+
+    uint64_t max_ns = hist->max_ns.load(std::memory_order_relaxed);
+    uint64_t seen = 0;
+    for (int i = 0; i < LATENCY_BUCKET_COUNT; i++) {
+        seen += hist->counts[i].load(std::memory_order_relaxed);
+        if (seen >= target) {
+            uint64_t upper = Bucket_UpperBound(i);
+            return upper < max_ns ? upper : max_ns;
+        }
+    }
+    return max_ns;
+}
+
+void LatencyProbes_Init(LatencyProbes *probes, int64_t budget_ns) {
+    for (int i = 0; i < LATENCY_STAGE_COUNT; i++) {
+        LatencyHistogram_Reset(&probes->stages[i]);
+    }
+    probes->budget_ns = budget_ns;
+    probes->over_budget.store(0, std::memory_order_relaxed);
+}
+
+const char *LatencyStage_Name(int stage) {
+    if (stage < 0 || stage >= LATENCY_STAGE_COUNT) {
+        return "unknown";
+    }
+    return LATENCY_STAGE_NAMES[stage];
+}
+
+void LatencyProbes_WriteJson(const LatencyProbes *probes, FILE *fp) {
+    fprintf(fp, "{\n");
+    fprintf(fp, "  \"unit\": \"ns\",\n");
+    fprintf(fp, "  \"budget_ns\": %lld,\n", (long long)probes->budget_ns);
+    fprintf(fp, "  \"over_budget\": %llu,\n",
+            (unsigned long long)probes->over_budget.load(std::memory_order_relaxed));
+    fprintf(fp, "  \"stages\": {\n");
+
+    for (int s = 0; s < LATENCY_STAGE_COUNT; s++) {
+        const LatencyHistogram *hist = &probes->stages[s];
+        uint64_t count = hist->total_count.load(std::memory_order_acquire);
+        uint64_t sum = hist->sum_ns.load(std::memory_order_relaxed);
+        uint64_t min_ns = count ? hist->min_ns.load(std::memory_order_relaxed) : 0;
+
+        fprintf(fp, "    \"%s\": {\n", LATENCY_STAGE_NAMES[s]);
+        fprintf(fp, "      \"count\": %llu,\n", (unsigned long long)count);
+        fprintf(fp, "      \"min\": %llu,\n", (unsigned long long)min_ns);
+        fprintf(fp, "      \"mean\": %.1f,\n", count ? (double)sum / (double)count : 0.0);
+        fprintf(fp, "      \"p50\": %llu,\n", (unsigned long long)LatencyHistogram_Percentile(hist, 50.0));
+        fprintf(fp, "      \"p90\": %llu,\n", (unsigned long long)LatencyHistogram_Percentile(hist, 90.0));
+        fprintf(fp, "      \"p99\": %llu,\n", (unsigned long long)LatencyHistogram_Percentile(hist, 99.0));
+        fprintf(fp, "      \"p999\": %llu,\n", (unsigned long long)LatencyHistogram_Percentile(hist, 99.9));
+        fprintf(fp, "      \"max\": %llu,\n", (unsigned long long)hist->max_ns.load(std::memory_order_relaxed));
+
+        // 只输出非空桶：[桶内最大耗时, 次数]
+        fprintf(fp, "      \"buckets\": [");
+        int first = 1;
+        for (int i = 0; i < LATENCY_BUCKET_COUNT; i++) {
+            uint64_t n = hist->counts[i].load(std::memory_order_relaxed);
+            if (n == 0) {
+                continue;
+            }
+            fprintf(fp, "%s[%llu, %llu]", first ? "" : ", ",
+                    (unsigned long long)Bucket_UpperBound(i), (unsigned long long)n);
+            first = 0;
+        }
+        fprintf(fp, "]\n");
+        fprintf(fp, "    }%s\n", s + 1 < LATENCY_STAGE_COUNT ? "," : "");
+    }
+
+    fprintf(fp, "  }\n");
+    fprintf(fp, "}\n");
+}
+
+int LatencyProbes_DumpJson(const LatencyProbes *probes, const char *filename) {
+    size_t len = strlen(filename);
+    char *tmp_name = (char *)malloc(len + 5);
+    if (!tmp_name) {
+        fprintf(stderr, "错误: 内存分配失败\n");
+        return -1;
+    }
+    memcpy(tmp_name, filename, len);
+    memcpy(tmp_name + len, ".tmp", 5);
+
+    FILE *fp = fopen(tmp_name, "w");
+    if (!fp) {
+        fprintf(stderr, "错误: 无法创建耗时统计文件 %s\n", tmp_name);
+        free(tmp_name);
+        return -1;
+    }
+    LatencyProbes_WriteJson(probes, fp);
+    int write_failed = ferror(fp);
+    if (fclose(fp) != 0 || write_failed) {
+        fprintf(stderr, "错误: 写入耗时统计文件 %s 失败\n", tmp_name);
+        remove(tmp_name);
+        free(tmp_name);
+        return -1;
+    }
+
+#ifdef _WIN32
+    remove(filename); // Windows下rename不覆盖已有文件
+#endif
+    if (rename(tmp_name, filename) != 0) {
+        fprintf(stderr, "错误: 无法写入耗时统计文件 %s\n", filename);
+        remove(tmp_name);
+        free(tmp_name);
+        return -1;
+    }
+    free(tmp_name);
+    return 0;
+}
+
+void LatencyProbes_PrintSummary(const LatencyProbes *probes, FILE *fp) {
+    fprintf(fp, "耗时统计(us): 预算=%.1f, 超预算周期=%llu\n", (double)probes->budget_ns / 1e3,
+            (unsigned long long)probes->over_budget.load(std::memory_order_relaxed));
+    for (int s = 0; s < LATENCY_STAGE_COUNT; s++) {
+        const LatencyHistogram *hist = &probes->stages[s];
+        uint64_t count = hist->total_count.load(std::memory_order_acquire);
+        if (count == 0) {
+            continue;
+        }
+        fprintf(fp, "  %-15s 次数=%llu, 平均=%.3f, P50=%.3f, P99=%.3f, 最大=%.3f\n",
+                LATENCY_STAGE_NAMES[s], (unsigned long long)count,
+                (double)hist->sum_ns.load(std::memory_order_relaxed) / (double)count / 1e3,
+                (double)LatencyHistogram_Percentile(hist, 50.0) / 1e3,
+                (double)LatencyHistogram_Percentile(hist, 99.0) / 1e3,
+                (double)hist->max_ns.load(std::memory_order_relaxed) / 1e3);
+    }
+}
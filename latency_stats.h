@@ -0,0 +1,159 @@
+/*
+ * 文件：latency_stats.h
+ * 功能：控制周期分阶段耗时统计
+ *
+ * 功能描述：
+ * 1. 对数-线性分桶(HDR风格)直方图：每个2的幂区间再均分为32个子桶，
+ *    覆盖0ns ~ 2^64ns全范围，相对误差不超过1/32
+ * 2. 记录只做几次原子变量读写，不加锁、不分配内存，可在控制线程中常开
+ * 3. 按阶段(采集、SOC限值、模式判断、PI计算、指令输出、整周期)分别统计，
+ *    可随时或在退出时以JSON格式导出，用于证明控制周期满足时间预算
+ */
+
+#ifndef VOLTAGE_CONTROL_LATENCY_STATS_H
+#define VOLTAGE_CONTROL_LATENCY_STATS_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#define LATENCY_SUB_BUCKET_BITS 5                               // 每个2的幂区间的子桶位数
+#define LATENCY_SUB_BUCKETS (1 << LATENCY_SUB_BUCKET_BITS)      // 每个2的幂区间的子桶数
+#define LATENCY_BUCKET_COUNT ((64 - LATENCY_SUB_BUCKET_BITS + 1) * LATENCY_SUB_BUCKETS)
+
+/* ---------- 统计阶段 ---------- */
+typedef enum {
+    LATENCY_STAGE_ACQUISITION = 0,  // 读取测量值
+    LATENCY_STAGE_SOC_LIMITS,       // SOC功率限值计算
+    LATENCY_STAGE_MODE,             // 控制模式判断
+    LATENCY_STAGE_PI,               // PI控制计算
+    LATENCY_STAGE_OUTPUT,           // 指令输出
+    LATENCY_STAGE_CYCLE,            // 整个控制周期(以上阶段之和，不含等待)
+    LATENCY_STAGE_COUNT
+} LatencyStage;
+
+/* ---------- 耗时直方图 ----------
+ * 每个直方图只允许一个线程写入，其他线程可随时读取导出；
+ * 计数均为原子变量，写入端只做relaxed读后写，不需要带锁的原子指令 */
+struct LatencyHistogram {
+    std::atomic<uint64_t> counts[LATENCY_BUCKET_COUNT];
+    std::atomic<uint64_t> total_count;
+    std::atomic<uint64_t> sum_ns;
+    std::atomic<uint64_t> min_ns;
+    std::atomic<uint64_t> max_ns;
+};
+
+/* ---------- 分阶段耗时探针 ---------- */
+struct LatencyProbes {
+    LatencyHistogram stages[LATENCY_STAGE_COUNT];
+    int64_t budget_ns;                      // 控制周期时间预算
+    std::atomic<uint64_t> over_budget;      // 整周期耗时超过预算的次数
+};
+
+/**
+ * @brief 计算耗时值所在的桶下标
+ * @param value_ns 耗时 (ns)
+ * @return int 桶下标
+ */
+inline int LatencyHistogram_BucketIndex(uint64_t value_ns) {
+    if (value_ns < LATENCY_SUB_BUCKETS) {
+        return (int)value_ns;
+    }
+#if defined(_MSC_VER)
+    unsigned long msb;
+    _BitScanReverse64(&msb, value_ns);
+    int shift = (int)msb - LATENCY_SUB_BUCKET_BITS;
+#else
+    int shift = 63 - __builtin_clzll(value_ns) - LATENCY_SUB_BUCKET_BITS;
+#endif
+    return (shift + 1) * LATENCY_SUB_BUCKETS + (int)(value_ns >> shift) - LATENCY_SUB_BUCKETS;
+}
+
+/**
+ * @brief 记录一次耗时(仅限该直方图唯一的写入线程调用)
+ * @param hist 直方图
+ * @param value_ns 耗时 (ns)，负值按0处理
+ */
+inline void LatencyHistogram_Record(LatencyHistogram *hist, int64_t value_ns) {
+    uint64_t v = value_ns > 0 ? (uint64_t)value_ns : 0;
+    std::atomic<uint64_t> *bucket = &hist->counts[LatencyHistogram_BucketIndex(v)];
+    bucket->store(bucket->load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    hist->sum_ns.store(hist->sum_ns.load(std::memory_order_relaxed) + v, std::memory_order_relaxed);
+    if (v < hist->min_ns.load(std::memory_order_relaxed)) {
+        hist->min_ns.store(v, std::memory_order_relaxed);
+    }
+    if (v > hist->max_ns.load(std::memory_order_relaxed)) {
+        hist->max_ns.store(v, std::memory_order_relaxed);
+    }
+    // 总数最后以release发布，读取端先读总数即可看到与之对应的各桶计数
+    hist->total_count.store(hist->total_count.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+/**
+ * @brief 清空直方图
+ * @param hist 直方图
+ */
+void LatencyHistogram_Reset(LatencyHistogram *hist);
+
+/**
+ * @brief 计算百分位耗时
+ * @param hist 直方图
+ * @param percentile 百分位 (0~100)
+ * @return uint64_t 该百分位所在桶的上界 (ns)，无样本时返回0
+ */
+uint64_t LatencyHistogram_Percentile(const LatencyHistogram *hist, double percentile);
+
+/**
+ * @brief 初始化分阶段耗时探针
+ * @param probes 探针
+ * @param budget_ns 控制周期时间预算 (ns)
+ */
+void LatencyProbes_Init(LatencyProbes *probes, int64_t budget_ns);
+
+/**
+ * @brief 记录一个阶段的耗时
+ * @param probes 探针
+ * @param stage 阶段 LatencyStage
+ * @param value_ns 耗时 (ns)
+ */
+inline void LatencyProbes_Record(LatencyProbes *probes, int stage, int64_t value_ns) {
+    LatencyHistogram_Record(&probes->stages[stage], value_ns);
+    if (stage == LATENCY_STAGE_CYCLE && value_ns > probes->budget_ns) {
+        probes->over_budget.store(probes->over_budget.load(std::memory_order_relaxed) + 1,
+                                  std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief 阶段名称(用作JSON键名)
+ * @param stage 阶段 LatencyStage
+ * @return const char* 名称
+ */
+const char *LatencyStage_Name(int stage);
+
+/**
+ * @brief 以JSON格式输出全部阶段的统计结果与非空桶
+ * @param probes 探针
+ * @param fp 输出流
+ */
+void LatencyProbes_WriteJson(const LatencyProbes *probes, FILE *fp);
+
+/**
+ * @brief 把JSON统计结果写入文件(先写临时文件再改名，读取方不会看到半个文件)
+ * @param probes 探针
+ * @param filename 文件名
+ * @return int 成功返回0，失败返回-1
+ */
+int LatencyProbes_DumpJson(const LatencyProbes *probes, const char *filename);
+
+/**
+ * @brief 输出各阶段耗时摘要(次数、平均、P50/P99/最大值)
+ * @param probes 探针
+ * @param fp 输出流
+ */
+void LatencyProbes_PrintSummary(const LatencyProbes *probes, FILE *fp);
+
+#endif // VOLTAGE_CONTROL_LATENCY_STATS_H
@@ -0,0 +1,1161 @@
+/*
+ * 文件：main.cpp
+ * 功能：台区储能电压调节控制器程序入口
+ *
+ * 功能描述：
+ * 1. 解析命令行参数并加载配置文件
+ * 2. 按需启动日志线程、采集线程，初始化逐台区控制器或批量引擎
+ * 3. 按固定周期驱动主控制循环，收到SIGINT/SIGTERM后输出统计信息并退出
+ * 4. 超实时仿真、蒙特卡洛研究及其分批结果合并
+ * 5. 回放现场录波轨迹(可与上述任一运行方式组合)，以及CSV录波到轨迹文件的转换
+ * 6. 把运行数据写入列式历史库，并按列查询历史库
+ * 7. 可选的电池物理模型，使仿真与模拟数据源中的SOC随功率指令闭环变化
+ * 8. 可选的电网电压模型，使仿真中的台区电压随储能功率、负荷与光伏变化
+ * 9. PI增益网格扫描：并行仿真各增益组合，按越限时长、超调等指标排序输出
+ * 10. PI增益与死区自动整定：多场景并行评估的Nelder-Mead搜索，结果写为新的配置文件
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <csignal>
+#include <cstring>
+#include "scheduler.h"
+#include "control_loop.h"
+#include "simulation.h"
+#include "monte_carlo.h"
+#include "parallel_for.h"
+#include "trace_replay.h"
+#include "historian.h"
+#include "grid_model.h"
+#include "gain_sweep.h"
+#include "gain_tuner.h"
+#include "config_reload.h"
+#include "fleet_config.h"
+#include "config_image.h"
+
+#define TUNED_CONFIG_FILE "config_tuned.json"   // 整定结果默认写入的配置文件
+
+// 退出标志，由SIGINT/SIGTERM置位，主循环检测后正常退出
+static volatile sig_atomic_t g_stop_requested = 0;
+
+static void Handle_StopSignal(int sig) {
+    (void)sig;
+    g_stop_requested = 1;
+}
+
+// 耗时统计导出请求，由SIGUSR1置位，主循环在周期间隙导出
+static volatile sig_atomic_t g_dump_requested = 0;
+
+static void Handle_DumpSignal(int sig) {
+    (void)sig;
+    g_dump_requested = 1;
+}
+
+// 停止日志线程(输出剩余记录)并关闭日志文件
+static void Close_Telemetry(TelemetryLogger *logger, FILE *telemetry_fp) {
+    if (logger) {
+        TelemetryLogger_Stop(logger);
+    }
+    if (telemetry_fp) {
+        fclose(telemetry_fp);
+    }
+}
+
+// 把第index个台区的数据源挂接到录波轨迹，未回放时什么也不做
+static int Attach_Replay(SimulationState *sim, const TraceFile *replay, int index) {
+    return replay ? TraceReplay_Attach(sim, replay, (uint32_t)index) : 0;
+}
+
+// 为数据源启用电池模型，未指定电池参数时什么也不做
+static int Enable_Battery(SimulationState *sim, const BatteryParams *battery) {
+    return battery ? Simulation_EnableBattery(sim, battery) : 0;
+}
+
+// 把第index个台区的数据源挂接到电网模型，未指定电网模型时什么也不做
+static int Attach_Grid(SimulationState *sim, const GridModel *grid, int index) {
+    return grid ? GridModel_Attach(sim, grid, (uint32_t)index) : 0;
+}
+
+// 关闭录波轨迹(未回放时为NULL)
+static void Close_Replay(TraceFile *replay) {
+    if (replay) {
+        TraceFile_Close(replay);
+    }
+}
+
+// 第index个台区的配置：指定了各台区配置(多站点配置或镜像)时取对应站点，否则全部台区共用cfg
+static const CompiledConfig *Area_Config(const CompiledConfig *cfg, const CompiledConfig *area_cfgs, int index) {
+    return area_cfgs ? &area_cfgs[index] : cfg;
+}
+
+// 释放多站点配置并解除配置镜像映射(未使用时为全零，调用也是安全的)
+static void Close_SiteConfig(FleetConfig *sites, ConfigImage *image) {
+    FleetConfig_Free(sites);
+    ConfigImage_Close(image);
+}
+
+// 停止配置热加载线程(未启用时为NULL)
+static void Close_Reloader(ConfigReloader *reloader) {
+    if (reloader) {
+        ConfigReloader_Stop(reloader);
+    }
+}
+
+// 控制周期间隙检查热加载：有新版本时把配置复制进各台区(批量模式复制进fleet)，
+// PI积分、控制模式等运行状态保持不变
+static void Apply_ConfigReload(ConfigReloader *reloader, uint64_t *version, VoltageController *ctrls,
+                               VoltageFleet *fleet, size_t count) {
+    const ConfigSnapshot *snapshot = reloader ? ConfigReloader_Poll(reloader, version) : NULL;
+    if (!snapshot) {
+        return;
+    }
+    if (fleet) {
+        VoltageFleet_SetCurve(fleet, &snapshot->curve);
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (fleet) {
+            VoltageFleet_SetConfig(fleet, i, &snapshot->cfg);
+        } else {
+            ctrls[i].cfg = snapshot->cfg;
+            ctrls[i].curve = snapshot->curve;
+        }
+    }
+    ConfigReloader_Release(reloader, snapshot);
+}
+
+// 超实时仿真：不启动调度器与任何线程，按虚拟时钟尽快跑完全部周期后输出汇总
+static int Run_Simulation(const CompiledConfig *cfg, const CompiledConfig *area_cfgs, const SOC_DeratingCurve *curve,
+                          int area_count,
+                          int fleet_mode, uint64_t seed, const TraceFile *replay, const BatteryParams *battery,
+                          const SimulationOptions *options) {
+    SimulationSummary summary;
+    int ret;
+
+    printf("超实时仿真: 时长=%.0fs, 步长=%gs, 台区数=%d, 周期数=%.0f, 随机种子=%llu\n", options->duration_s,
+           options->step_s, area_count, ceil(options->duration_s / options->step_s), (unsigned long long)seed);
+    fflush(stdout);
+
+    if (fleet_mode) {
+        VoltageFleet fleet;
+        SimulationState *sims = (SimulationState *)calloc((size_t)area_count, sizeof(SimulationState));
+        if (!sims || VoltageFleet_Init(&fleet, (size_t)area_count) != 0) {
+            fprintf(stderr, "错误: 内存分配失败\n");
+            free(sims);
+            return EXIT_FAILURE;
+        }
+        VoltageFleet_SetCurve(&fleet, curve);
+        for (int i = 0; i < area_count; i++) {
+            VoltageFleet_SetConfig(&fleet, (size_t)i, Area_Config(cfg, area_cfgs, i));
+            Simulation_Init(&sims[i], seed, (uint64_t)i);
+            Attach_Replay(&sims[i], replay, i);
+            Enable_Battery(&sims[i], battery);
+            Attach_Grid(&sims[i], options->grid, i);
+        }
+        ret = Simulation_RunFleet(&fleet, sims, options, &g_stop_requested, &summary);
+        VoltageFleet_Free(&fleet);
+        free(sims);
+    } else {
+        VoltageController *ctrls = (VoltageController *)calloc((size_t)area_count, sizeof(VoltageController));
+        if (!ctrls) {
+            fprintf(stderr, "错误: 内存分配失败\n");
+            return EXIT_FAILURE;
+        }
+        for (int i = 0; i < area_count; i++) {
+            VoltageController_Init(&ctrls[i], i, Area_Config(cfg, area_cfgs, i), curve);
+            Simulation_Init(&ctrls[i].sim, seed, (uint64_t)i);
+            Attach_Replay(&ctrls[i].sim, replay, i);
+            Enable_Battery(&ctrls[i].sim, battery);
+            Attach_Grid(&ctrls[i].sim, options->grid, i);
+        }
+        ret = Simulation_RunControllers(ctrls, (size_t)area_count, options, &g_stop_requested, &summary);
+        free(ctrls);
+    }
+
+    if (ret != 0) {
+        return EXIT_FAILURE;
+    }
+    if (g_stop_requested) {
+        printf("仿真被中断，以下为已完成部分的汇总\n");
+    }
+    SimulationSummary_Print(&summary, stdout);
+    return 0;
+}
+
+// 输出蒙特卡洛汇总：指定文件时写JSON，否则JSON输出到控制台
+static int Output_MonteCarlo(const MonteCarloAggregate *aggregate, const char *output_file) {
+    MonteCarloAggregate_Print(aggregate, stdout);
+    if (!output_file) {
+        MonteCarloAggregate_WriteJson(aggregate, stdout);
+        return 0;
+    }
+    FILE *fp = fopen(output_file, "w");
+    if (!fp) {
+        fprintf(stderr, "错误: 无法创建结果文件 %s\n", output_file);
+        return EXIT_FAILURE;
+    }
+    MonteCarloAggregate_WriteJson(aggregate, fp);
+    if (fclose(fp) != 0) {
+        fprintf(stderr, "错误: 写入结果文件 %s 失败\n", output_file);
+        return EXIT_FAILURE;
+    }
+    return 0;
+}
+
+// 蒙特卡洛研究：按场景编号并行超实时仿真，汇总越限统计
+static int Run_MonteCarlo(const SystemConfig_Cfg *cfg, const SOC_DeratingCurve *curve,
+                          const MonteCarloOptions *options, const char *output_file) {
+    MonteCarloRanges ranges;
+    MonteCarloAggregate aggregate;
+
+    MonteCarlo_DefaultRanges(&ranges);
+    printf("蒙特卡洛研究: 场景[%llu, %llu), 每场景时长=%.0fs, 步长=%gs, 线程数=%d, 随机种子=%llu\n",
+           (unsigned long long)options->first_scenario,
+           (unsigned long long)(options->first_scenario + options->scenarios), options->duration_s,
+           options->step_s, options->threads > 0 ? options->threads : ParallelFor_DefaultThreads(),
+           (unsigned long long)options->seed);
+    fflush(stdout);
+
+    if (MonteCarlo_Run(cfg, curve, &ranges, options, &g_stop_requested, &aggregate) != 0) {
+        return EXIT_FAILURE;
+    }
+    return Output_MonteCarlo(&aggregate, output_file);
+}
+
+// PI增益网格扫描：并行仿真全部组合，按指标排序后输出前若干名，指定文件时把完整结果写为CSV
+static int Run_GainSweep(const SystemConfig_Cfg *cfg, const SOC_DeratingCurve *curve,
+                         const GainSweepOptions *options, const char *output_file) {
+    uint64_t count = GainSweep_Count(options);
+    if (count > GAIN_SWEEP_MAX_COMBINATIONS) {
+        fprintf(stderr, "错误: 增益组合数超过上限%llu\n", (unsigned long long)GAIN_SWEEP_MAX_COMBINATIONS);
+        return EXIT_FAILURE;
+    }
+    printf("PI增益扫描: 组合数=%llu, 台区数=%zu, 每组合时长=%.0fs, 步长=%gs, 线程数=%d, 排序指标=%s\n",
+           (unsigned long long)count, options->areas, options->duration_s, options->step_s,
+           options->threads > 0 ? options->threads : ParallelFor_DefaultThreads(),
+           GAIN_SWEEP_RANK_NAMES[options->rank]);
+    fflush(stdout);
+
+    GainSweepResult *results = (GainSweepResult *)calloc((size_t)count, sizeof(GainSweepResult));
+    if (!results) {
+        fprintf(stderr, "错误: 内存分配失败\n");
+        return EXIT_FAILURE;
+    }
+    if (GainSweep_Run(cfg, curve, options, &g_stop_requested, results) != 0) {
+        free(results);
+        return EXIT_FAILURE;
+    }
+    GainSweep_PrintTable(results, count, GAIN_SWEEP_CONSOLE_ROWS, stdout);
+    int ret = 0;
+    if (output_file) {
+        FILE *fp = fopen(output_file, "w");
+        if (!fp) {
+            fprintf(stderr, "错误: 无法创建结果文件 %s\n", output_file);
+            free(results);
+            return EXIT_FAILURE;
+        }
+        GainSweep_WriteCsv(results, count, fp);
+        if (fclose(fp) != 0) {
+            fprintf(stderr, "错误: 写入结果文件 %s 失败\n", output_file);
+            ret = EXIT_FAILURE;
+        }
+    }
+    free(results);
+    return ret;
+}
+
+// PI增益与死区自动整定：从配置文件中的参数出发搜索，最优参数写为新的配置文件
+static int Run_GainTuner(const SystemConfig_Cfg *cfg, const SOC_DeratingCurve *curve,
+                         const GainTunerOptions *options, const char *config_file, const char *output_file) {
+    printf("PI增益整定: 台区数=%zu, 场景数=%u, 每场景时长=%.0fs, 步长=%gs, 最大迭代=%d, 线程数=%d\n",
+           options->areas, options->scenarios, options->duration_s, options->step_s, options->max_iterations,
+           options->threads > 0 ? options->threads : ParallelFor_DefaultThreads());
+    printf("  代价权重: violation=%g, overshoot=%g, settling=%g, energy=%g\n", options->weights.violation,
+           options->weights.overshoot, options->weights.settling, options->weights.energy);
+    fflush(stdout);
+
+    GainTunerResult result;
+    if (GainTuner_Run(cfg, curve, options, &g_stop_requested, stdout, &result) != 0) {
+        return EXIT_FAILURE;
+    }
+    GainTuner_Print(&result, stdout);
+    if (GainTuner_WriteConfig(config_file, result.best.params, output_file) != 0) {
+        return EXIT_FAILURE;
+    }
+    printf("整定后的配置已写入 %s\n", output_file);
+    return 0;
+}
+
+// 合并多个批次的蒙特卡洛结果文件(场景编号区间须相邻，顺序任意)
+static int Merge_MonteCarlo(const char **files, int file_count, const char *output_file) {
+    MonteCarloAggregate merged;
+    int *used = (int *)calloc((size_t)file_count, sizeof(int));
+    MonteCarloAggregate *parts = (MonteCarloAggregate *)calloc((size_t)file_count, sizeof(MonteCarloAggregate));
+    if (!used || !parts) {
+        fprintf(stderr, "错误: 内存分配失败\n");
+        free(used);
+        free(parts);
+        return EXIT_FAILURE;
+    }
+    for (int i = 0; i < file_count; i++) {
+        if (MonteCarloAggregate_ReadJson(files[i], &parts[i]) != 0) {
+            free(used);
+            free(parts);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // 从编号最小的批次开始，依次接上与当前区间相邻的批次
+    int first = 0;
+    for (int i = 1; i < file_count; i++) {
+        if (parts[i].first_scenario < parts[first].first_scenario) {
+            first = i;
+        }
+    }
+    merged = parts[first];
+    used[first] = 1;
+    for (int merged_count = 1; merged_count < file_count; merged_count++) {
+        int next = -1;
+        for (int i = 0; i < file_count; i++) {
+            if (!used[i] && parts[i].first_scenario == merged.first_scenario + merged.scenarios) {
+                next = i;
+                break;
+            }
+        }
+        if (next < 0) {
+            fprintf(stderr, "错误: 场景编号%llu之后缺少相邻批次，无法合并\n",
+                    (unsigned long long)(merged.first_scenario + merged.scenarios));
+            free(used);
+            free(parts);
+            return EXIT_FAILURE;
+        }
+        if (MonteCarloAggregate_Merge(&merged, &parts[next]) != 0) {
+            fprintf(stderr, "错误: 无法合并结果文件 %s\n", files[next]);
+            free(used);
+            free(parts);
+            return EXIT_FAILURE;
+        }
+        used[next] = 1;
+    }
+    free(used);
+    free(parts);
+    return Output_MonteCarlo(&merged, output_file);
+}
+
+// 历史库查询的累计结果
+typedef struct {
+    uint64_t rows;
+    double sum;
+    float min;
+    float max;
+    int64_t ts_first;
+    int64_t ts_last;
+} HistorianQueryResult;
+
+static void Accumulate_Row(void *user, int32_t area_id, int64_t timestamp_ns, float value) {
+    (void)area_id;
+    HistorianQueryResult *result = (HistorianQueryResult *)user;
+    if (result->rows == 0 || value < result->min) result->min = value;
+    if (result->rows == 0 || value > result->max) result->max = value;
+    if (result->rows == 0 || timestamp_ns < result->ts_first) result->ts_first = timestamp_ns;
+    if (result->rows == 0 || timestamp_ns > result->ts_last) result->ts_last = timestamp_ns;
+    result->sum += value;
+    result->rows++;
+}
+
+// 按列查询历史库：只读取块头与所需的列，输出满足条件的行数与统计值
+static int Query_Historian(const char *filename, const char *column_name, int area_id, const char *window) {
+    int column = Historian_FindColumn(column_name);
+    if (column <= HISTORIAN_COL_TIMESTAMP) {
+        fprintf(stderr, "错误: 未知的数值列 %s，可用:", column_name);
+        for (int c = HISTORIAN_COL_TIMESTAMP + 1; c < HISTORIAN_COL_COUNT; c++) {
+            fprintf(stderr, " %s", HISTORIAN_COLUMN_NAMES[c]);
+        }
+        fprintf(stderr, "\n");
+        return EXIT_FAILURE;
+    }
+    HistorianQuery query;
+    HistorianQuery_Init(&query, column);
+    query.area_id = area_id;
+    if (window && sscanf(window, "%f:%f", &query.value_lo, &query.value_hi) != 2) {
+        fprintf(stderr, "错误: 数值范围%s应为 下限:上限\n", window);
+        return EXIT_FAILURE;
+    }
+
+    HistorianReader reader;
+    if (HistorianReader_Open(&reader, filename) != 0) {
+        return EXIT_FAILURE;
+    }
+    printf("历史库: 数据块=%zu, 行数=%llu, 文件大小=%.2fMB, 平均每行%.2f字节\n", reader.chunk_count,
+           (unsigned long long)reader.rows, (double)reader.file_size / (1024.0 * 1024.0),
+           reader.rows ? (double)reader.file_size / (double)reader.rows : 0.0);
+
+    HistorianQueryResult result;
+    memset(&result, 0, sizeof(result));
+    HistorianScanStats stats;
+    int64_t start = Monotonic_NowNs();
+    int ret = HistorianReader_Scan(&reader, &query, Accumulate_Row, &result, &stats);
+    double elapsed_s = (double)(Monotonic_NowNs() - start) / 1e9;
+    HistorianReader_Close(&reader);
+    if (ret != 0) {
+        return EXIT_FAILURE;
+    }
+
+    printf("查询 %s: 扫描数据块=%llu, 跳过数据块=%llu, 命中行数=%llu, 耗时=%.3fs\n", column_name,
+           (unsigned long long)stats.chunks_scanned, (unsigned long long)stats.chunks_skipped,
+           (unsigned long long)result.rows, elapsed_s);
+    if (result.rows > 0) {
+        printf("  最小值=%.4f, 最大值=%.4f, 平均值=%.4f, 时间范围=%.3f~%.3fs\n", result.min, result.max,
+               result.sum / (double)result.rows, (double)result.ts_first / 1e9, (double)result.ts_last / 1e9);
+    }
+    return 0;
+}
+
+static void Print_Usage(const char *prog) {
+    fprintf(stderr, "用法: %s [-c 配置文件] [-p 控制周期ms] [-n 台区数量] [-f] [-a] [-L] [-t 日志文件] [-l 耗时统计文件]\n"
+                    "       %s -S 仿真时长 [-d 仿真步长] [-r 随机种子] [-B 电池容量] [-G 电网模型] [-c 配置文件] [-n 台区数量] [-f]\n"
+                    "       %s -X 名称=下限:上限:点数 [-X ...] [-K 排序指标] [-S 时长] [-G 电网模型] [-B 电池容量] [-j 线程数] [-o 结果文件]\n"
+                    "       %s -U 迭代数 [-N 场景数] [-W 指标=权重 ...] [-S 时长] -G 电网模型 [-B 电池容量] [-j 线程数] [-o 配置文件]\n"
+                    "       %s -M 场景数 [-F 起始场景] [-j 线程数] [-S 场景时长] [-d 仿真步长] [-r 随机种子] [-o 结果文件]\n"
+                    "       %s -m 结果文件 [-m 结果文件 ...] [-o 结果文件]\n"
+                    "       %s -T 录波CSV文件 -o 轨迹文件\n"
+                    "       %s -Q 历史库文件 -k 列名 [-A 台区编号] [-w 下限:上限]\n", prog, prog, prog, prog, prog, prog, prog, prog);
+    fprintf(stderr, "  -c, --config     配置文件路径，默认config.json；扩展名为.csv时按CSV格式读取(见config.csv)，\n"
+                    "                   为.fleet时按多站点格式读取(见fleet_config.h)，台区数取站点数；\n"
+                    "                   为.cfgbin时映射-C生成的配置镜像，不做文本解析\n");
+    fprintf(stderr, "  -C, --compile-config  校验-c指定的配置(JSON/CSV/.fleet)并连同编译好的降额曲线写成二进制配置镜像后退出\n");
+    fprintf(stderr, "  -p, --period-ms  控制周期(ms)，默认1000，最小%d\n", SCHEDULER_MIN_PERIOD_MS);
+    fprintf(stderr, "  -n, --areas      本进程驱动的台区数量，默认1\n");
+    fprintf(stderr, "  -f, --fleet      使用结构数组批量引擎计算全部台区，退出时输出一次汇总信息\n");
+    fprintf(stderr, "  -a, --async-acq  由独立采集线程读取测量值，控制线程无锁取用最新样本\n");
+    fprintf(stderr, "  -t, --telemetry  把每个台区每个周期的运行记录以二进制格式写入指定文件，\n");
+    fprintf(stderr, "                   未指定时普通模式以文本输出到控制台，批量模式不记录\n");
+    fprintf(stderr, "  -L, --reload     普通模式与批量模式下监视配置文件，修改后由后台线程加载、校验并在周期间隙生效，\n"
+                    "                   未通过校验的配置被丢弃，运行中的配置保持不变\n");
+    fprintf(stderr, "  -l, --latency-json  普通模式下退出时(及收到SIGUSR1时)把各阶段耗时直方图以JSON写入指定文件\n");
+    fprintf(stderr, "  -S, --simulate   以虚拟时钟超实时仿真指定时长后输出汇总，如3600、30d、1y\n");
+    fprintf(stderr, "  -d, --step       仿真步长(即控制周期)，默认1s，支持ms/s/m后缀\n");
+    fprintf(stderr, "  -r, --seed       模拟数据源随机种子，默认%llu；第i个台区使用第i个随机流\n",
+            (unsigned long long)SIMULATION_DEFAULT_SEED);
+    fprintf(stderr, "  -M, --monte-carlo  运行指定数量的随机场景(蒙特卡洛研究)，每个场景默认仿真1d\n");
+    fprintf(stderr, "  -F, --first-scenario  本批次起始场景编号，默认0，用于分批运行\n");
+    fprintf(stderr, "  -j, --threads    蒙特卡洛、增益扫描与多站点配置解析的工作线程数，默认使用全部硬件线程\n");
+    fprintf(stderr, "  -o, --output     蒙特卡洛汇总JSON(或增益扫描完整结果CSV)写入指定文件，未指定时输出到控制台；\n"
+                    "                   整定(-U)时为输出的配置文件\n");
+    fprintf(stderr, "  -m, --merge      合并多个批次的蒙特卡洛结果文件，可重复指定\n");
+    fprintf(stderr, "  -R, --replay     以内存映射方式回放录波轨迹文件代替模拟数据，第i个台区回放第i个通道，\n");
+    fprintf(stderr, "                   每个控制周期取一个样本；台区数默认取轨迹的通道数；\n");
+    fprintf(stderr, "                   仿真步长默认取采样间隔，-S trace 表示仿真整条轨迹\n");
+    fprintf(stderr, "  -T, --trace-from-csv  把CSV录波(time_s,area,V_meas,SOC,P_meas)转换为轨迹文件(-o指定)\n");
+    fprintf(stderr, "  -B, --battery    按指定可用容量(kWh)启用电池模型，SOC由功率指令积分得到(闭环)，\n");
+    fprintf(stderr, "                   效率%.0f%%、爬坡率%gkW/s、自放电%g/天；不能与-a、-R、-M一起使用\n",
+            BATTERY_DEFAULT_EFFICIENCY * 100.0f, BATTERY_DEFAULT_RAMP_KW_PER_S, BATTERY_DEFAULT_SELF_DISCHARGE_PER_DAY);
+    fprintf(stderr, "  -G, --grid       仿真模式下按指定JSON文件(见grid.json)建立电网模型，台区电压随储能功率、\n");
+    fprintf(stderr, "                   负荷与光伏变化(闭环)；不能与-R、-M一起使用\n");
+    fprintf(stderr, "  -X, --sweep      扫描一个PI参数(Kp_upper/Ki_upper/Kp_lower/Ki_lower/P_step_max)，在[下限,上限]上\n");
+    fprintf(stderr, "                   等间距取指定点数，可重复指定，未指定的参数取配置文件中的值；\n");
+    fprintf(stderr, "                   各组合并行仿真(默认1d，-S指定)，控制台显示前%d名\n", GAIN_SWEEP_CONSOLE_ROWS);
+    fprintf(stderr, "  -K, --rank       增益扫描排序指标：violation(越限时长，默认)/overshoot/settling/energy\n");
+    fprintf(stderr, "  -U, --tune       以Nelder-Mead法整定四个PI增益与上下限死区，最多迭代指定次数，\n");
+    fprintf(stderr, "                   须指定电网模型(-G)，每场景默认仿真1d(-S指定)，结果写入-o指定的配置文件(默认%s)\n",
+            TUNED_CONFIG_FILE);
+    fprintf(stderr, "  -N, --scenarios  整定使用的场景数，默认%d：电网模型本身及负荷、光伏倍数与初始SOC随机的场景\n",
+            GAIN_TUNER_DEFAULT_SCENARIOS);
+    fprintf(stderr, "  -W, --weight     整定代价权重，可重复指定：violation(超出设定值h/台区天)=1、overshoot(V)=0.1、\n");
+    fprintf(stderr, "                   settling(min)=0.01、energy(kWh/台区天)=0.001\n");
+    fprintf(stderr, "  -H, --historian  把每个台区每个周期的运行数据写入列式历史库文件(普通模式与仿真模式)\n");
+    fprintf(stderr, "  -Q, --query      查询历史库文件中的一列(-k指定列名)，可按台区(-A)与数值范围(-w)过滤\n");
+}
+
+int main(int argc, char *argv[])
+{
+    const char *config_file = "config.json";
+    int period_ms = 1000;
+    int area_count = 1;
+    int fleet_mode = 0;
+    int async_acq = 0;
+    int hot_reload = 0;
+    const char *telemetry_file = NULL;
+    const char *latency_file = NULL;
+    int simulate = 0;
+    uint64_t seed = SIMULATION_DEFAULT_SEED;
+    SimulationOptions sim_options = {0.0, 1.0, NULL, NULL};
+    uint64_t mc_scenarios = 0;
+    uint64_t mc_first_scenario = 0;
+    int mc_threads = 0;
+    const char *mc_output = NULL;
+    const char **merge_files = (const char **)calloc((size_t)argc, sizeof(const char *));
+    int merge_count = 0;
+    const char *replay_file = NULL;
+    const char *csv_trace_file = NULL;
+    int area_given = 0;
+    int step_given = 0;
+    int simulate_whole_trace = 0;
+    TraceFile trace;
+    TraceFile *replay = NULL;
+    const char *historian_file = NULL;
+    const char *query_file = NULL;
+    const char *query_column = "V_meas";
+    const char *query_window = NULL;
+    int query_area = -1;
+    BatteryParams battery_params;
+    BatteryParams *battery = NULL;
+    const char *grid_file = NULL;
+    GainSweepAxis sweep_axes[GAIN_SWEEP_PARAM_COUNT];
+    int sweep_given[GAIN_SWEEP_PARAM_COUNT] = {0};
+    int sweep = 0;
+    int sweep_rank = GAIN_SWEEP_RANK_VIOLATION;
+    int tune_iterations = -1;
+    long tune_scenarios = GAIN_TUNER_DEFAULT_SCENARIOS;
+    GainTunerWeights tune_weights;
+    GainTuner_DefaultWeights(&tune_weights);
+    SystemConfig_Cfg sys_cfg;
+    SOC_DeratingCurve soc_curve;
+    CompiledConfig sys_compiled;        // 由sys_cfg与soc_curve编译，控制热路径使用
+    FleetConfig site_config = {0, NULL, NULL};
+    ConfigImage config_image;
+    memset(&config_image, 0, sizeof(config_image));
+    const CompiledConfig *area_cfgs = NULL;
+    const char *image_output = NULL;
+
+    // 解析命令行参数
+    for (int i = 1; i < argc; i++) {
+        if ((strcmp(argv[i], "-c") == 0 || strcmp(argv[i], "--config") == 0) && i + 1 < argc) {
+            config_file = argv[++i];
+        } else if ((strcmp(argv[i], "-p") == 0 || strcmp(argv[i], "--period-ms") == 0) && i + 1 < argc) {
+            period_ms = atoi(argv[++i]);
+        } else if ((strcmp(argv[i], "-n") == 0 || strcmp(argv[i], "--areas") == 0) && i + 1 < argc) {
+            area_count = atoi(argv[++i]);
+            area_given = 1;
+        } else if (strcmp(argv[i], "-f") == 0 || strcmp(argv[i], "--fleet") == 0) {
+            fleet_mode = 1;
+        } else if (strcmp(argv[i], "-a") == 0 || strcmp(argv[i], "--async-acq") == 0) {
+            async_acq = 1;
+        } else if ((strcmp(argv[i], "-C") == 0 || strcmp(argv[i], "--compile-config") == 0) && i + 1 < argc) {
+            image_output = argv[++i];
+        } else if (strcmp(argv[i], "-L") == 0 || strcmp(argv[i], "--reload") == 0) {
+            hot_reload = 1;
+        } else if ((strcmp(argv[i], "-t") == 0 || strcmp(argv[i], "--telemetry") == 0) && i + 1 < argc) {
+            telemetry_file = argv[++i];
+        } else if ((strcmp(argv[i], "-l") == 0 || strcmp(argv[i], "--latency-json") == 0) && i + 1 < argc) {
+            latency_file = argv[++i];
+        } else if ((strcmp(argv[i], "-S") == 0 || strcmp(argv[i], "--simulate") == 0) && i + 1 < argc) {
+            if (strcmp(argv[++i], "trace") == 0) {
+                simulate_whole_trace = 1; // 时长在打开轨迹文件后确定
+            } else if (Simulation_ParseDuration(argv[i], &sim_options.duration_s) != 0) {
+                return EXIT_FAILURE;
+            }
+            simulate = 1;
+        } else if ((strcmp(argv[i], "-r") == 0 || strcmp(argv[i], "--seed") == 0) && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 0);
+        } else if ((strcmp(argv[i], "-d") == 0 || strcmp(argv[i], "--step") == 0) && i + 1 < argc) {
+            if (Simulation_ParseDuration(argv[++i], &sim_options.step_s) != 0) {
+                return EXIT_FAILURE;
+            }
+            step_given = 1;
+        } else if ((strcmp(argv[i], "-M") == 0 || strcmp(argv[i], "--monte-carlo") == 0) && i + 1 < argc) {
+            mc_scenarios = strtoull(argv[++i], NULL, 0);
+        } else if ((strcmp(argv[i], "-F") == 0 || strcmp(argv[i], "--first-scenario") == 0) && i + 1 < argc) {
+            mc_first_scenario = strtoull(argv[++i], NULL, 0);
+        } else if ((strcmp(argv[i], "-j") == 0 || strcmp(argv[i], "--threads") == 0) && i + 1 < argc) {
+            mc_threads = atoi(argv[++i]);
+        } else if ((strcmp(argv[i], "-o") == 0 || strcmp(argv[i], "--output") == 0) && i + 1 < argc) {
+            mc_output = argv[++i];
+        } else if ((strcmp(argv[i], "-m") == 0 || strcmp(argv[i], "--merge") == 0) && i + 1 < argc) {
+            merge_files[merge_count++] = argv[++i];
+        } else if ((strcmp(argv[i], "-R") == 0 || strcmp(argv[i], "--replay") == 0) && i + 1 < argc) {
+            replay_file = argv[++i];
+        } else if ((strcmp(argv[i], "-T") == 0 || strcmp(argv[i], "--trace-from-csv") == 0) && i + 1 < argc) {
+            csv_trace_file = argv[++i];
+        } else if ((strcmp(argv[i], "-H") == 0 || strcmp(argv[i], "--historian") == 0) && i + 1 < argc) {
+            historian_file = argv[++i];
+        } else if ((strcmp(argv[i], "-B") == 0 || strcmp(argv[i], "--battery") == 0) && i + 1 < argc) {
+            BatteryParams_Default(&battery_params);
+            battery_params.capacity_kwh = (float)atof(argv[++i]);
+            battery = &battery_params;
+        } else if ((strcmp(argv[i], "-G") == 0 || strcmp(argv[i], "--grid") == 0) && i + 1 < argc) {
+            grid_file = argv[++i];
+        } else if ((strcmp(argv[i], "-X") == 0 || strcmp(argv[i], "--sweep") == 0) && i + 1 < argc) {
+            int param;
+            GainSweepAxis axis;
+            if (GainSweep_ParseAxis(argv[++i], &param, &axis) != 0) {
+                free(merge_files);
+                return EXIT_FAILURE;
+            }
+            sweep_axes[param] = axis;
+            sweep_given[param] = 1;
+            sweep = 1;
+        } else if ((strcmp(argv[i], "-K") == 0 || strcmp(argv[i], "--rank") == 0) && i + 1 < argc) {
+            sweep_rank = GainSweep_ParseRank(argv[++i]);
+            if (sweep_rank < 0) {
+                free(merge_files);
+                return EXIT_FAILURE;
+            }
+        } else if ((strcmp(argv[i], "-U") == 0 || strcmp(argv[i], "--tune") == 0) && i + 1 < argc) {
+            tune_iterations = atoi(argv[++i]);
+        } else if ((strcmp(argv[i], "-N") == 0 || strcmp(argv[i], "--scenarios") == 0) && i + 1 < argc) {
+            tune_scenarios = atol(argv[++i]);
+        } else if ((strcmp(argv[i], "-W") == 0 || strcmp(argv[i], "--weight") == 0) && i + 1 < argc) {
+            if (GainTuner_ParseWeight(&tune_weights, argv[++i]) != 0) {
+                free(merge_files);
+                return EXIT_FAILURE;
+            }
+        } else if ((strcmp(argv[i], "-Q") == 0 || strcmp(argv[i], "--query") == 0) && i + 1 < argc) {
+            query_file = argv[++i];
+        } else if ((strcmp(argv[i], "-k") == 0 || strcmp(argv[i], "--column") == 0) && i + 1 < argc) {
+            query_column = argv[++i];
+        } else if ((strcmp(argv[i], "-A") == 0 || strcmp(argv[i], "--area") == 0) && i + 1 < argc) {
+            query_area = atoi(argv[++i]);
+        } else if ((strcmp(argv[i], "-w") == 0 || strcmp(argv[i], "--window") == 0) && i + 1 < argc) {
+            query_window = argv[++i];
+        } else {
+            Print_Usage(argv[0]);
+            free(merge_files);
+            return EXIT_FAILURE;
+        }
+    }
+    if (merge_count > 0) {
+        // 合并结果文件不需要配置文件
+        int ret = Merge_MonteCarlo(merge_files, merge_count, mc_output);
+        free(merge_files);
+        return ret;
+    }
+    free(merge_files);
+    if (query_file) {
+        return Query_Historian(query_file, query_column, query_area, query_window);
+    }
+    if (csv_trace_file) {
+        if (!mc_output) {
+            fprintf(stderr, "错误: 转换录波需要用-o指定轨迹文件\n");
+            return EXIT_FAILURE;
+        }
+        return TraceFile_ConvertCsv(csv_trace_file, mc_output) == 0 ? 0 : EXIT_FAILURE;
+    }
+    if (simulate_whole_trace && !replay_file) {
+        fprintf(stderr, "错误: -S trace 只能与录波回放(-R)一起使用\n");
+        return EXIT_FAILURE;
+    }
+    if (replay_file && mc_scenarios > 0) {
+        fprintf(stderr, "错误: 蒙特卡洛研究不支持录波回放(-R)\n");
+        return EXIT_FAILURE;
+    }
+    if (area_count < 1) {
+        fprintf(stderr, "错误: 台区数量必须大于0\n");
+        return EXIT_FAILURE;
+    }
+    if (simulate && (async_acq || telemetry_file)) {
+        fprintf(stderr, "错误: 仿真模式不支持采集线程(-a)与日志文件(-t)\n");
+        return EXIT_FAILURE;
+    }
+    if (telemetry_file && historian_file) {
+        fprintf(stderr, "错误: 日志文件(-t)与历史库(-H)只能指定一个\n");
+        return EXIT_FAILURE;
+    }
+    if (battery && (async_acq || replay_file || mc_scenarios > 0)) {
+        fprintf(stderr, "错误: 电池模型(-B)不能与采集线程(-a)、录波回放(-R)或蒙特卡洛研究(-M)一起使用\n");
+        return EXIT_FAILURE;
+    }
+    if (battery) {
+        BatteryModel model;
+        if (BatteryModel_Init(&model, battery) != 0) {
+            return EXIT_FAILURE;
+        }
+    }
+    int tune = tune_iterations >= 0;
+    if (grid_file && (!(simulate || sweep || tune) || replay_file || mc_scenarios > 0)) {
+        fprintf(stderr, "错误: 电网模型(-G)只能用于超实时仿真(-S)、增益扫描(-X)或整定(-U)，"
+                        "且不能与录波回放(-R)或蒙特卡洛研究(-M)一起使用\n");
+        return EXIT_FAILURE;
+    }
+    if (sweep && (mc_scenarios > 0 || replay_file || historian_file || fleet_mode || async_acq || telemetry_file)) {
+        fprintf(stderr, "错误: 增益扫描(-X)不能与-M、-R、-H、-f、-a、-t一起使用\n");
+        return EXIT_FAILURE;
+    }
+    if (tune && (sweep || mc_scenarios > 0 || replay_file || historian_file || fleet_mode || async_acq
+                 || telemetry_file)) {
+        fprintf(stderr, "错误: 整定(-U)不能与-X、-M、-R、-H、-f、-a、-t一起使用\n");
+        return EXIT_FAILURE;
+    }
+    if (tune && !grid_file) {
+        fprintf(stderr, "错误: 整定(-U)需要用-G指定电网模型，开环电压不随增益变化\n");
+        return EXIT_FAILURE;
+    }
+    if (hot_reload && (simulate || mc_scenarios > 0 || sweep || tune)) {
+        fprintf(stderr, "错误: 配置热加载(-L)只用于实时控制，不能与-S、-M、-X、-U一起使用\n");
+        return EXIT_FAILURE;
+    }
+    const char *config_ext = strrchr(config_file, '.');
+    int fleet_config = config_ext && strcmp(config_ext, ".fleet") == 0;
+    int image_config = config_ext && strcmp(config_ext, ".cfgbin") == 0;
+    if (fleet_config && (mc_scenarios > 0 || sweep || tune || hot_reload)) {
+        fprintf(stderr, "错误: 多站点配置(.fleet)只用于实时控制与超实时仿真，不能与-M、-X、-U、-L一起使用\n");
+        return EXIT_FAILURE;
+    }
+    if (image_config && (tune || hot_reload || image_output)) {
+        fprintf(stderr, "错误: 配置镜像(.cfgbin)不能用于整定(-U)、热加载(-L)或再次生成镜像(-C)，请使用原配置文件\n");
+        return EXIT_FAILURE;
+    }
+    if (tune && config_ext && (strcmp(config_ext, ".csv") == 0 || fleet_config)) {
+        fprintf(stderr, "错误: 整定(-U)结果按原配置文件写回JSON，需要JSON格式的配置文件(-c)\n");
+        return EXIT_FAILURE;
+    }
+    if (tune && (tune_scenarios < 1 || tune_scenarios > 100000)) {
+        fprintf(stderr, "错误: 整定场景数必须在1~100000之间\n");
+        return EXIT_FAILURE;
+    }
+    if (historian_file && mc_scenarios > 0) {
+        fprintf(stderr, "错误: 蒙特卡洛研究不支持历史库(-H)\n");
+        return EXIT_FAILURE;
+    }
+
+    // 加载配置文件：多站点配置按站点数确定台区数，降额曲线使用默认值，下面显示第一个站点的参数
+    if (fleet_config) {
+        int64_t load_start = Monotonic_NowNs();
+        if (FleetConfig_Load(&site_config, config_file, mc_threads) != 0) {
+            fprintf(stderr, "程序启动失败：配置文件错误。\n");
+            return EXIT_FAILURE;
+        }
+        if (area_given && (size_t)area_count != site_config.count) {
+            fprintf(stderr, "错误: 台区数量%d与多站点配置的站点数%zu不一致\n", area_count, site_config.count);
+            Close_SiteConfig(&site_config, &config_image);
+            return EXIT_FAILURE;
+        }
+        area_cfgs = site_config.cfgs;
+        area_count = (int)site_config.count;
+        area_given = 1;
+        sys_cfg = site_config.cfgs[0].params;
+        SOC_DeratingCurve_Default(&soc_curve);
+        printf("多站点配置: 站点数=%zu, 加载耗时=%.1fms, 第一个站点为site %d\n", site_config.count,
+               (double)(Monotonic_NowNs() - load_start) / 1e6, site_config.site_ids[0]);
+    } else if (image_config) {
+        // 配置镜像：只映射并校验，各台区直接读取映射区中的配置
+        int64_t load_start = Monotonic_NowNs();
+        if (ConfigImage_Open(&config_image, config_file) != 0) {
+            fprintf(stderr, "程序启动失败：配置文件错误。\n");
+            return EXIT_FAILURE;
+        }
+        sys_cfg = config_image.cfgs[0].params;
+        soc_curve = *config_image.curve;
+        if (!ConfigImage_IsShared(&config_image)) {
+            if (mc_scenarios > 0 || sweep) {
+                fprintf(stderr, "错误: 多站点配置镜像只用于实时控制与超实时仿真，不能与-M、-X一起使用\n");
+                Close_SiteConfig(&site_config, &config_image);
+                return EXIT_FAILURE;
+            }
+            if (area_given && (size_t)area_count != config_image.count) {
+                fprintf(stderr, "错误: 台区数量%d与配置镜像的站点数%zu不一致\n", area_count, config_image.count);
+                Close_SiteConfig(&site_config, &config_image);
+                return EXIT_FAILURE;
+            }
+            area_cfgs = config_image.cfgs;
+            area_count = (int)config_image.count;
+            area_given = 1;
+        }
+        printf("配置镜像: 站点数=%zu%s, 加载耗时=%.3fms\n", config_image.count,
+               ConfigImage_IsShared(&config_image) ? "(全部台区共用)" : "",
+               (double)(Monotonic_NowNs() - load_start) / 1e6);
+    } else if (load_configuration(config_file, &sys_cfg, &soc_curve) != 0) {
+        fprintf(stderr, "程序启动失败：配置文件错误。\n");
+        return EXIT_FAILURE;
+    }
+    printf("配置加载成功!\n");
+
+    // 全部台区共用的配置编译一次，控制热路径只读取编译后的形式；镜像中已是编译好的配置
+    if (image_config) {
+        sys_compiled = config_image.cfgs[0];
+    } else {
+        CompiledConfig_Build(&sys_compiled, &sys_cfg, &soc_curve);
+    }
+
+    // 生成配置镜像后退出：配置已在加载时完成校验
+    if (image_output) {
+        int ret = ConfigImage_Write(image_output, area_cfgs ? area_cfgs : &sys_compiled, area_cfgs ? site_config.site_ids : NULL,
+                                    area_cfgs ? site_config.count : 1, &soc_curve);
+        if (ret == 0) {
+            printf("配置镜像已写入 %s (站点数=%zu)\n", image_output, area_cfgs ? site_config.count : (size_t)1);
+        }
+        Close_SiteConfig(&site_config, &config_image);
+        return ret == 0 ? 0 : EXIT_FAILURE;
+    }
+
+    // 查看部分读取信息
+    printf("V_ref_upper=%f\n", sys_cfg.V_ref_upper);
+    printf("V_ref_lower=%f\n",sys_cfg.V_ref_lower);
+    printf("Deadband_upper=%f\n", sys_cfg.Deadband_upper);
+    printf("Deadband_lower=%f\n", sys_cfg.Deadband_lower);
+    printf("V_enter_lower=%f\n", sys_cfg.V_enter_lower);
+    printf("Kp_upper=%f\n", sys_cfg.Kp_upper);
+    printf("Ki_upper=%f\n", sys_cfg.Ki_upper);
+    printf("Kp_lower=%f\n", sys_cfg.Kp_lower);
+    printf("Ki_lower=%f\n", sys_cfg.Ki_lower);
+    printf("P_step_max=%f\n", sys_cfg.P_step_max);
+    printf("P_charge_max=%f\n", sys_cfg.P_charge_max);
+    printf("P_discharge_max=%f\n", sys_cfg.P_discharge_max);
+    printf("SOC_max=%f\n", sys_cfg.SOC_max);
+    printf("SOC_min=%f\n", sys_cfg.SOC_min);
+
+    if (mc_scenarios > 0) {
+        MonteCarloOptions mc_options = {seed, mc_first_scenario, mc_scenarios,
+                                        simulate ? sim_options.duration_s : 86400.0, sim_options.step_s, mc_threads};
+        signal(SIGINT, Handle_StopSignal);
+        signal(SIGTERM, Handle_StopSignal);
+        int ret = Run_MonteCarlo(&sys_cfg, &soc_curve, &mc_options, mc_output);
+        Close_SiteConfig(&site_config, &config_image);
+        return ret;
+    }
+
+    if (sweep) {
+        GainSweepOptions sweep_options;
+        GainSweep_DefaultOptions(&sweep_options, &sys_cfg);
+        for (int i = 0; i < GAIN_SWEEP_PARAM_COUNT; i++) {
+            if (sweep_given[i]) {
+                sweep_options.axes[i] = sweep_axes[i];
+            }
+        }
+        sweep_options.duration_s = simulate ? sim_options.duration_s : 86400.0;
+        sweep_options.step_s = sim_options.step_s;
+        sweep_options.seed = seed;
+        sweep_options.areas = (size_t)area_count;
+        sweep_options.threads = mc_threads;
+        sweep_options.rank = sweep_rank;
+        sweep_options.battery = battery;
+        GridModel grid;
+        if (grid_file) {
+            if (GridModel_Load(&grid, grid_file, (size_t)area_count) != 0) {
+                Close_SiteConfig(&site_config, &config_image);
+                return EXIT_FAILURE;
+            }
+            GridModel_Print(&grid, stdout);
+            sweep_options.grid = &grid;
+        }
+        signal(SIGINT, Handle_StopSignal);
+        signal(SIGTERM, Handle_StopSignal);
+        int ret = Run_GainSweep(&sys_cfg, &soc_curve, &sweep_options, mc_output);
+        if (grid_file) {
+            GridModel_Free(&grid);
+        }
+        Close_SiteConfig(&site_config, &config_image);
+        return ret;
+    }
+
+    if (tune) {
+        GainTunerOptions tune_options;
+        GainTuner_DefaultOptions(&tune_options, &sys_cfg);
+        tune_options.weights = tune_weights;
+        tune_options.scenarios = (uint32_t)tune_scenarios;
+        tune_options.max_iterations = tune_iterations;
+        tune_options.duration_s = simulate ? sim_options.duration_s : 86400.0;
+        tune_options.step_s = sim_options.step_s;
+        tune_options.seed = seed;
+        tune_options.areas = (size_t)area_count;
+        tune_options.threads = mc_threads;
+        tune_options.battery = battery;
+        GridModel grid;
+        if (GridModel_Load(&grid, grid_file, (size_t)area_count) != 0) {
+            Close_SiteConfig(&site_config, &config_image);
+            return EXIT_FAILURE;
+        }
+        GridModel_Print(&grid, stdout);
+        tune_options.grid = &grid;
+        signal(SIGINT, Handle_StopSignal);
+        signal(SIGTERM, Handle_StopSignal);
+        int ret = Run_GainTuner(&sys_cfg, &soc_curve, &tune_options, config_file,
+                                mc_output ? mc_output : TUNED_CONFIG_FILE);
+        GridModel_Free(&grid);
+        Close_SiteConfig(&site_config, &config_image);
+        return ret;
+    }
+
+    // 打开录波轨迹：台区数、仿真步长与时长未指定时取自轨迹
+    if (replay_file) {
+        if (TraceFile_Open(&trace, replay_file) != 0) {
+            Close_SiteConfig(&site_config, &config_image);
+            return EXIT_FAILURE;
+        }
+        replay = &trace;
+        TraceFile_Print(replay, stdout);
+        const TraceFileHeader *header = replay->header;
+        if (!area_given) {
+            area_count = (int)header->area_count;
+        } else if ((uint32_t)area_count > header->area_count) {
+            fprintf(stderr, "错误: 台区数量%d超过轨迹文件的通道数%u\n", area_count, header->area_count);
+            Close_Replay(replay);
+            Close_SiteConfig(&site_config, &config_image);
+            return EXIT_FAILURE;
+        }
+        if (simulate && !step_given) {
+            sim_options.step_s = header->step_s;
+        } else if (simulate && fabs(sim_options.step_s - header->step_s) > 1e-9 * header->step_s) {
+            fprintf(stderr, "错误: 仿真步长%gs与轨迹采样间隔%gs不一致\n", sim_options.step_s, header->step_s);
+            Close_Replay(replay);
+            Close_SiteConfig(&site_config, &config_image);
+            return EXIT_FAILURE;
+        }
+        if (simulate_whole_trace) {
+            sim_options.duration_s = (double)header->sample_count * header->step_s;
+        }
+    }
+
+    printf("=== 台区储能双向PI电压调节模拟 ===\n");
+    if (simulate) {
+        signal(SIGINT, Handle_StopSignal);
+        signal(SIGTERM, Handle_StopSignal);
+        GridModel grid;
+        if (grid_file) {
+            if (GridModel_Load(&grid, grid_file, (size_t)area_count) != 0) {
+                Close_Replay(replay);
+                Close_SiteConfig(&site_config, &config_image);
+                return EXIT_FAILURE;
+            }
+            GridModel_Print(&grid, stdout);
+            sim_options.grid = &grid;
+        }
+        HistorianWriter historian;
+        FILE *historian_fp = NULL;
+        if (historian_file) {
+            historian_fp = fopen(historian_file, "wb");
+            if (!historian_fp || HistorianWriter_Init(&historian, historian_fp) != 0) {
+                fprintf(stderr, "错误: 无法创建历史库文件 %s\n", historian_file);
+                if (historian_fp) {
+                    fclose(historian_fp);
+                }
+                if (grid_file) {
+                    GridModel_Free(&grid);
+                }
+                Close_Replay(replay);
+                Close_SiteConfig(&site_config, &config_image);
+                return EXIT_FAILURE;
+            }
+            sim_options.historian = &historian;
+        }
+        int ret = Run_Simulation(&sys_compiled, area_cfgs, &soc_curve, area_count, fleet_mode, seed, replay, battery,
+                                 &sim_options);
+        if (grid_file) {
+            if (grid.type == GRID_MODEL_RADIAL) {
+                RadialFeeder_PrintStats(&grid.feeder, stdout);
+            }
+            GridModel_Free(&grid);
+        }
+        if (historian_fp) {
+            if (HistorianWriter_Finish(&historian) != 0) {
+                ret = EXIT_FAILURE;
+            }
+            HistorianWriter_PrintStats(&historian, stdout);
+            if (fclose(historian_fp) != 0) {
+                ret = EXIT_FAILURE;
+            }
+        }
+        Close_Replay(replay);
+        Close_SiteConfig(&site_config, &config_image);
+        return ret;
+    }
+
+    // 初始化周期调度器：截止时刻在单调时钟上绝对推进，循环耗时不会累积成漂移
+    PeriodicScheduler scheduler;
+    if (Scheduler_Init(&scheduler, period_ms) != 0) {
+        fprintf(stderr, "程序启动失败：控制周期参数错误。\n");
+        Close_Replay(replay);
+        Close_SiteConfig(&site_config, &config_image);
+        return EXIT_FAILURE;
+    }
+    signal(SIGINT, Handle_StopSignal);
+    signal(SIGTERM, Handle_StopSignal);
+#ifdef SIGUSR1
+    signal(SIGUSR1, Handle_DumpSignal);
+#endif
+
+    // 启动日志线程：指定文件时写二进制记录或历史库，否则普通模式输出文本到控制台
+    // 队列至少能容纳4个周期的全部记录，日志线程偶尔卡顿也不丢记录
+    TelemetryLogger telemetry;
+    TelemetryLogger *logger = NULL;
+    FILE *telemetry_fp = NULL;
+    HistorianWriter historian;
+    if (telemetry_file || historian_file) {
+        const char *filename = telemetry_file ? telemetry_file : historian_file;
+        telemetry_fp = fopen(filename, "wb");
+        if (!telemetry_fp) {
+            fprintf(stderr, "错误: 无法创建日志文件 %s\n", filename);
+            Close_Replay(replay);
+            Close_SiteConfig(&site_config, &config_image);
+            return EXIT_FAILURE;
+        }
+    }
+    if (telemetry_fp || !fleet_mode) {
+        int started;
+        if (historian_file) {
+            started = HistorianWriter_Init(&historian, telemetry_fp) == 0
+                      && TelemetryLogger_StartHistorian(&telemetry, 4 * (size_t)area_count, &historian) == 0;
+        } else {
+            int sink = telemetry_fp ? TELEMETRY_SINK_BINARY : TELEMETRY_SINK_TEXT;
+            started = TelemetryLogger_Start(&telemetry, 4 * (size_t)area_count, sink,
+                                            telemetry_fp ? telemetry_fp : stdout) == 0;
+        }
+        if (!started) {
+            fprintf(stderr, "程序启动失败：日志线程启动失败。\n");
+            if (telemetry_fp) {
+                fclose(telemetry_fp);
+            }
+            Close_Replay(replay);
+            Close_SiteConfig(&site_config, &config_image);
+            return EXIT_FAILURE;
+        }
+        logger = &telemetry;
+    }
+
+    // 可选：启动独立采集线程，采样周期与控制周期相同，样本年龄超过两个周期视为过期
+    AcquisitionThread acquisition;
+    AcquisitionThread *acq = NULL;
+    if (async_acq) {
+        if (Acquisition_Start(&acquisition, (size_t)area_count, period_ms, 2 * period_ms, seed, replay) != 0) {
+            fprintf(stderr, "程序启动失败：采集线程启动失败。\n");
+            Close_Telemetry(logger, telemetry_fp);
+            Close_Replay(replay);
+            Close_SiteConfig(&site_config, &config_image);
+            return EXIT_FAILURE;
+        }
+        acq = &acquisition;
+    }
+
+    // 可选：启动配置热加载线程，启动时的配置为版本1
+    ConfigReloader reloader;
+    ConfigReloader *reload = NULL;
+    uint64_t config_version = 1;
+    if (hot_reload) {
+        if (ConfigReloader_Start(&reloader, config_file, &sys_cfg, &soc_curve) != 0) {
+            fprintf(stderr, "程序启动失败：配置热加载线程启动失败。\n");
+            if (acq) {
+                Acquisition_Stop(acq);
+            }
+            Close_Telemetry(logger, telemetry_fp);
+            Close_Replay(replay);
+            Close_SiteConfig(&site_config, &config_image);
+            return EXIT_FAILURE;
+        }
+        reload = &reloader;
+    }
+
+    if (fleet_mode) {
+        // 批量模式：配置与状态按字段存放为连续数组
+        VoltageFleet fleet;
+        SimulationState *sims = (SimulationState *)calloc((size_t)area_count, sizeof(SimulationState));
+        if (!sims || VoltageFleet_Init(&fleet, (size_t)area_count) != 0) {
+            fprintf(stderr, "错误: 内存分配失败\n");
+            free(sims);
+            if (acq) {
+                Acquisition_Stop(acq);
+            }
+            Close_Reloader(reload);
+            Close_Telemetry(logger, telemetry_fp);
+            Close_Replay(replay);
+            Close_SiteConfig(&site_config, &config_image);
+            return EXIT_FAILURE;
+        }
+        VoltageFleet_SetCurve(&fleet, &soc_curve);
+        for (int i = 0; i < area_count; i++) {
+            VoltageFleet_SetConfig(&fleet, (size_t)i, Area_Config(&sys_compiled, area_cfgs, i));
+            Simulation_Init(&sims[i], seed, (uint64_t)i);
+            Attach_Replay(&sims[i], replay, i);
+            Enable_Battery(&sims[i], battery);
+        }
+
+        FleetLoopStats fleet_stats;
+        memset(&fleet_stats, 0, sizeof(fleet_stats));
+        for (uint32_t cycle = 0; !g_stop_requested; cycle++)
+        {
+            Apply_ConfigReload(reload, &config_version, NULL, &fleet, (size_t)area_count);
+            Fleet_VoltageControlLoop(&fleet, sims, acq, logger, cycle, &fleet_stats);
+            Scheduler_WaitNextPeriod(&scheduler);
+        }
+
+        if (logger) {
+            TelemetryLogger_Stop(logger);
+        }
+        FleetLoopStats_Print(&fleet_stats, fleet.count, stdout);
+        Scheduler_PrintStats(&scheduler, stdout);
+        if (acq) {
+            Acquisition_PrintStats(acq, stdout);
+            Acquisition_Stop(acq);
+        }
+        if (logger) {
+            TelemetryLogger_PrintStats(logger, stdout);
+        }
+        if (reload) {
+            ConfigReloader_PrintStats(reload, stdout);
+            ConfigReloader_Stop(reload);
+        }
+        if (telemetry_fp) {
+            fclose(telemetry_fp);
+        }
+        VoltageFleet_Free(&fleet);
+        free(sims);
+        Close_Replay(replay);
+        Close_SiteConfig(&site_config, &config_image);
+        return 0;
+    }
+
+    // 初始化各台区控制器上下文
+    VoltageController *ctrls = (VoltageController *)calloc((size_t)area_count, sizeof(VoltageController));
+    if (!ctrls) {
+        fprintf(stderr, "错误: 内存分配失败\n");
+        if (acq) {
+            Acquisition_Stop(acq);
+        }
+        Close_Reloader(reload);
+        Close_Telemetry(logger, telemetry_fp);
+        Close_Replay(replay);
+        Close_SiteConfig(&site_config, &config_image);
+        return EXIT_FAILURE;
+    }
+    for (int i = 0; i < area_count; i++) {
+        VoltageController_Init(&ctrls[i], i, Area_Config(&sys_compiled, area_cfgs, i), &soc_curve);
+        Simulation_Init(&ctrls[i].sim, seed, (uint64_t)i);
+        Attach_Replay(&ctrls[i].sim, replay, i);
+        Enable_Battery(&ctrls[i].sim, battery);
+    }
+
+    // 分阶段耗时统计，时间预算为一个控制周期
+    LatencyProbes *probes = new LatencyProbes;
+    LatencyProbes_Init(probes, (int64_t)period_ms * 1000000LL);
+
+    // 进入主控制循环
+    for (uint32_t cycle = 0; !g_stop_requested; cycle++)
+    {
+        Apply_ConfigReload(reload, &config_version, ctrls, NULL, (size_t)area_count);
+        Main_VoltageControlLoop(ctrls, (size_t)area_count, acq, logger, cycle, probes);
+        if (g_dump_requested) {
+            g_dump_requested = 0;
+            if (latency_file) {
+                LatencyProbes_DumpJson(probes, latency_file);
+            } else {
+                LatencyProbes_WriteJson(probes, stderr);
+            }
+        }
+        // 等待下一个控制周期
+        Scheduler_WaitNextPeriod(&scheduler);
+    }
+
+    // 先停日志线程，保证统计信息出现在全部运行记录之后
+    TelemetryLogger_Stop(logger);
+    Scheduler_PrintStats(&scheduler, stdout);
+    if (acq) {
+        Acquisition_PrintStats(acq, stdout);
+        Acquisition_Stop(acq);
+    }
+    TelemetryLogger_PrintStats(logger, stdout);
+    if (reload) {
+        ConfigReloader_PrintStats(reload, stdout);
+        ConfigReloader_Stop(reload);
+    }
+    if (telemetry_fp) {
+        fclose(telemetry_fp);
+    }
+    LatencyProbes_PrintSummary(probes, stdout);
+    if (latency_file) {
+        LatencyProbes_DumpJson(probes, latency_file);
+    }
+    delete probes;
+    free(ctrls);
+    Close_Replay(replay);
+    Close_SiteConfig(&site_config, &config_image);
+    return 0;
+}
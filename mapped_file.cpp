@@ -0,0 +1,104 @@
+/*
+ * 文件：mapped_file.cpp
+ * 功能：文件只读内存映射实现
+ */
+
+#include "mapped_file.h"
+
+#include <cstdio>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+int MappedFile_Open(MappedFile *file, const char *filename) {
+    file->data = NULL;
+    file->size = 0;
+    file->os_file = NULL;
+    file->os_mapping = NULL;
+#if defined(_WIN32)
+    HANDLE handle = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL, NULL);
+    if (handle == INVALID_HANDLE_VALUE) {
+        fprintf(stderr, "错误: 无法打开文件 %s\n", filename);
+        return -1;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(handle, &size)) {
+        fprintf(stderr, "错误: 无法读取文件 %s\n", filename);
+        CloseHandle(handle);
+        return -1;
+    }
+    if (size.QuadPart == 0) {
+        CloseHandle(handle);        // 空文件无法映射，按长度0处理
+        return 0;
+    }
+    HANDLE mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    const void *base = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+    if (!base) {
+        fprintf(stderr, "错误: 无法映射文件 %s\n", filename);
+        if (mapping) {
+            CloseHandle(mapping);
+        }
+        CloseHandle(handle);
+        return -1;
+    }
+    file->size = (size_t)size.QuadPart;
+    file->os_file = handle;
+    file->os_mapping = mapping;
+#else
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "错误: 无法打开文件 %s\n", filename);
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        fprintf(stderr, "错误: 无法读取文件 %s\n", filename);
+        close(fd);
+        return -1;
+    }
+    if (st.st_size == 0) {
+        close(fd);                  // 空文件无法映射，按长度0处理
+        return 0;
+    }
+    void *base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // 映射建立后不再需要文件描述符
+    if (base == MAP_FAILED) {
+        fprintf(stderr, "错误: 无法映射文件 %s\n", filename);
+        return -1;
+    }
+    file->size = (size_t)st.st_size;
+#endif
+    file->data = (const char *)base;
+    return 0;
+}
+
+void MappedFile_AdviseSequential(const MappedFile *file) {
+    if (!file->data) {
+        return;
+    }
+#if !defined(_WIN32)
+    madvise((void *)file->data, file->size, MADV_SEQUENTIAL);
+#endif
+}
+
+void MappedFile_Close(MappedFile *file) {
+    if (!file->data) {
+        return;
+    }
+#if defined(_WIN32)
+    UnmapViewOfFile(file->data);
+    CloseHandle((HANDLE)file->os_mapping);
+    CloseHandle((HANDLE)file->os_file);
+#else
+    munmap((void *)file->data, file->size);
+#endif
+    file->data = NULL;
+    file->size = 0;
+}
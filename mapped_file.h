@@ -0,0 +1,43 @@
+/*
+ * 文件：mapped_file.h
+ * 功能：以只读方式把整个文件映射到内存
+ *
+ * 功能描述：
+ * 1. POSIX下使用mmap，Windows下使用CreateFileMapping/MapViewOfFile
+ * 2. 映射区只读且不以'\0'结尾，解析时须按长度访问
+ */
+
+#ifndef VOLTAGE_CONTROL_MAPPED_FILE_H
+#define VOLTAGE_CONTROL_MAPPED_FILE_H
+
+#include <cstddef>
+
+/* ---------- 已映射的文件 ---------- */
+typedef struct {
+    const char *data;               // 映射区起始，空文件为NULL
+    size_t size;                    // 文件长度 (字节)
+    void *os_file;                  // Windows文件句柄
+    void *os_mapping;               // Windows映射对象句柄
+} MappedFile;
+
+/**
+ * @brief 以只读方式映射整个文件
+ * @param file [输出] 已映射的文件
+ * @param filename 文件名
+ * @return int 成功返回0，失败返回-1(已输出错误信息)
+ */
+int MappedFile_Open(MappedFile *file, const char *filename);
+
+/**
+ * @brief 提示操作系统映射区将被顺序读取(加大预读、及早回收已读过的页)，不支持的平台上不做任何事
+ * @param file 已映射的文件
+ */
+void MappedFile_AdviseSequential(const MappedFile *file);
+
+/**
+ * @brief 解除映射
+ * @param file 已映射的文件
+ */
+void MappedFile_Close(MappedFile *file);
+
+#endif // VOLTAGE_CONTROL_MAPPED_FILE_H
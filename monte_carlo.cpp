@@ -0,0 +1,468 @@
+/*
+ * 文件：monte_carlo.cpp
+ * 功能：并行蒙特卡洛电压越限研究实现
+ */
+
+#include "monte_carlo.h"
+#include "cJSON.h"
+#include "parallel_for.h"
+#include "prng.h"
+#include "simulation.h"
+
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+// 单个场景的结果，全部为整数，累加与顺序无关
+typedef struct {
+    uint64_t cycles;
+    uint64_t mode_cycles[3];
+    uint64_t above_cycles;
+    uint64_t below_cycles;
+    uint64_t soc_limited_cycles;
+    int64_t energy_charge_wh;
+    int64_t energy_discharge_wh;
+    float V_min;
+    float V_max;
+} MonteCarloResult;
+
+static const char *RANGE_NAMES[] = {
+    "V_base", "V_amplitude", "V_period_s", "initial_soc", "perturbation_scale", "Kp_scale", "Ki_scale"
+};
+#define RANGE_COUNT 7
+
+// 按RANGE_NAMES顺序访问各取值区间
+static MonteCarloRange *Ranges_At(MonteCarloRanges *ranges, int i) {
+    MonteCarloRange *items[RANGE_COUNT] = {
+        &ranges->V_base, &ranges->V_amplitude, &ranges->V_period_s, &ranges->initial_soc,
+        &ranges->perturbation_scale, &ranges->Kp_scale, &ranges->Ki_scale
+    };
+    return items[i];
+}
+
+static float Range_Sample(const MonteCarloRange *range, Prng *rng) {
+    return range->lo + (range->hi - range->lo) * Prng_Uniform(rng);
+}
+
+void MonteCarlo_DefaultRanges(MonteCarloRanges *ranges) {
+    ranges->V_base = {215.0f, 225.0f};
+    ranges->V_amplitude = {15.0f, 35.0f};
+    ranges->V_period_s = {20.0f, 600.0f};
+    ranges->initial_soc = {0.2f, 0.9f};
+    ranges->perturbation_scale = {0.0f, 2.0f};
+    ranges->Kp_scale = {0.5f, 2.0f};
+    ranges->Ki_scale = {0.5f, 2.0f};
+}
+
+void MonteCarlo_MakeScenario(uint64_t seed, const MonteCarloRanges *ranges, uint64_t index,
+                             MonteCarloScenario *scenario) {
+    // 场景参数用流2*index，模拟数据源用流2*index+1，两者互不相关
+    Prng rng;
+    Prng_Seed(&rng, seed, 2 * index);
+    scenario->index = index;
+    scenario->V_base = Range_Sample(&ranges->V_base, &rng);
+    scenario->V_amplitude = Range_Sample(&ranges->V_amplitude, &rng);
+    scenario->V_period_s = Range_Sample(&ranges->V_period_s, &rng);
+    scenario->initial_soc = Range_Sample(&ranges->initial_soc, &rng);
+    scenario->perturbation_scale = Range_Sample(&ranges->perturbation_scale, &rng);
+    scenario->Kp_scale = Range_Sample(&ranges->Kp_scale, &rng);
+    scenario->Ki_scale = Range_Sample(&ranges->Ki_scale, &rng);
+}
+
+// 运行一个场景
+static int MonteCarlo_RunScenario(const SystemConfig_Cfg *base_cfg, const SOC_DeratingCurve *curve,
+                                  const MonteCarloRanges *ranges, const MonteCarloOptions *options,
+                                  uint64_t index, const volatile sig_atomic_t *stop_flag,
+                                  MonteCarloResult *result) {
+    MonteCarloScenario scenario;
+    MonteCarlo_MakeScenario(options->seed, ranges, index, &scenario);
+
+    SystemConfig_Cfg cfg = *base_cfg;
+    cfg.Kp_upper *= scenario.Kp_scale;
+    cfg.Kp_lower *= scenario.Kp_scale;
+    cfg.Ki_upper *= scenario.Ki_scale;
+    cfg.Ki_lower *= scenario.Ki_scale;
+
+    CompiledConfig compiled;
+    CompiledConfig_Build(&compiled, &cfg, curve);
+    VoltageController ctrl;
+    VoltageController_Init(&ctrl, 0, &compiled, curve);
+    Simulation_Init(&ctrl.sim, options->seed, 2 * index + 1);
+    ctrl.sim.V_base = scenario.V_base;
+    ctrl.sim.V_amplitude = scenario.V_amplitude;
+    ctrl.sim.V_period_s = scenario.V_period_s;
+    ctrl.sim.simulated_soc = scenario.initial_soc;
+    ctrl.sim.perturbation_scale = scenario.perturbation_scale;
+
+    SimulationOptions sim_options = {options->duration_s, options->step_s, NULL, NULL};
+    SimulationSummary summary;
+    if (Simulation_RunControllers(&ctrl, 1, &sim_options, stop_flag, &summary) != 0) {
+        return -1;
+    }
+
+    result->cycles = summary.cycles;
+    for (int m = 0; m < 3; m++) {
+        result->mode_cycles[m] = summary.mode_cycles[m];
+    }
+    result->above_cycles = (uint64_t)llround(summary.time_above_upper_s / options->step_s);
+    result->below_cycles = (uint64_t)llround(summary.time_below_lower_s / options->step_s);
+    result->soc_limited_cycles = summary.soc_limited_cycles;
+    result->energy_charge_wh = llround(summary.energy_charge_kwh * 1000.0);
+    result->energy_discharge_wh = llround(summary.energy_discharge_kwh * 1000.0);
+    result->V_min = summary.V_min;
+    result->V_max = summary.V_max;
+    return 0;
+}
+
+static void Aggregate_Init(MonteCarloAggregate *aggregate, const MonteCarloRanges *ranges,
+                           const MonteCarloOptions *options) {
+    memset(aggregate, 0, sizeof(*aggregate));
+    aggregate->seed = options->seed;
+    aggregate->duration_s = options->duration_s;
+    aggregate->step_s = options->step_s;
+    aggregate->cycles_per_scenario = (uint64_t)ceil(options->duration_s / options->step_s - 1e-9);
+    aggregate->ranges = *ranges;
+    aggregate->first_scenario = options->first_scenario;
+    aggregate->V_min = FLT_MAX;
+    aggregate->V_max = -FLT_MAX;
+}
+
+static void Aggregate_Add(MonteCarloAggregate *aggregate, uint64_t index, const MonteCarloResult *result) {
+    aggregate->scenarios++;
+    aggregate->cycles += result->cycles;
+    for (int m = 0; m < 3; m++) {
+        aggregate->mode_cycles[m] += result->mode_cycles[m];
+    }
+    aggregate->above_cycles += result->above_cycles;
+    aggregate->below_cycles += result->below_cycles;
+    aggregate->soc_limited_cycles += result->soc_limited_cycles;
+    aggregate->energy_charge_wh += result->energy_charge_wh;
+    aggregate->energy_discharge_wh += result->energy_discharge_wh;
+    if (result->V_min < aggregate->V_min) aggregate->V_min = result->V_min;
+    if (result->V_max > aggregate->V_max) aggregate->V_max = result->V_max;
+
+    uint64_t violation = result->above_cycles + result->below_cycles;
+    if (violation > 0) {
+        aggregate->violated_scenarios++;
+    }
+    uint64_t bin = result->cycles ? violation * MONTE_CARLO_HIST_BINS / result->cycles : 0;
+    if (bin >= MONTE_CARLO_HIST_BINS) {
+        bin = MONTE_CARLO_HIST_BINS - 1;
+    }
+    aggregate->violation_hist[bin]++;
+
+    if (aggregate->scenarios == 1 || violation > aggregate->worst_violation_cycles
+        || (violation == aggregate->worst_violation_cycles && index < aggregate->worst_scenario)) {
+        aggregate->worst_scenario = index;
+        aggregate->worst_violation_cycles = violation;
+    }
+}
+
+int MonteCarlo_Run(const SystemConfig_Cfg *cfg, const SOC_DeratingCurve *curve, const MonteCarloRanges *ranges,
+                   const MonteCarloOptions *options, const volatile sig_atomic_t *stop_flag,
+                   MonteCarloAggregate *aggregate) {
+    if (options->scenarios == 0 || !(options->step_s > 0.0) || !(options->duration_s >= options->step_s)) {
+        fprintf(stderr, "错误: 蒙特卡洛参数非法 (场景数=%llu, 时长=%gs, 步长=%gs)\n",
+                (unsigned long long)options->scenarios, options->duration_s, options->step_s);
+        return -1;
+    }
+
+    MonteCarloResult *results = (MonteCarloResult *)calloc((size_t)options->scenarios, sizeof(MonteCarloResult));
+    int *failed = (int *)calloc((size_t)options->scenarios, sizeof(int));
+    if (!results || !failed) {
+        fprintf(stderr, "错误: 内存分配失败\n");
+        free(results);
+        free(failed);
+        return -1;
+    }
+
+    // 每个场景只写自己的结果槽，全部完成后按编号顺序汇总
+    ParallelFor((size_t)options->scenarios, options->threads, [&](size_t i) {
+        if (stop_flag && *stop_flag) {
+            failed[i] = 1;
+            return;
+        }
+        uint64_t index = options->first_scenario + i;
+        failed[i] = MonteCarlo_RunScenario(cfg, curve, ranges, options, index, stop_flag, &results[i]) != 0;
+    });
+
+    int ret = 0;
+    if (stop_flag && *stop_flag) {
+        fprintf(stderr, "错误: 蒙特卡洛研究被中断，结果不完整，未输出\n");
+        ret = -1;
+    }
+    Aggregate_Init(aggregate, ranges, options);
+    for (uint64_t i = 0; ret == 0 && i < options->scenarios; i++) {
+        if (failed[i]) {
+            ret = -1;
+            break;
+        }
+        Aggregate_Add(aggregate, options->first_scenario + i, &results[i]);
+    }
+
+    free(results);
+    free(failed);
+    return ret;
+}
+
+int MonteCarloAggregate_Merge(MonteCarloAggregate *dst, const MonteCarloAggregate *src) {
+    if (dst->seed != src->seed || dst->duration_s != src->duration_s || dst->step_s != src->step_s
+        || dst->cycles_per_scenario != src->cycles_per_scenario
+        || memcmp(&dst->ranges, &src->ranges, sizeof(dst->ranges)) != 0) {
+        fprintf(stderr, "错误: 研究参数(种子、时长、步长或取值区间)不一致，无法合并\n");
+        return -1;
+    }
+    if (dst->first_scenario + dst->scenarios == src->first_scenario) {
+        // src紧接在dst之后
+    } else if (src->first_scenario + src->scenarios == dst->first_scenario) {
+        dst->first_scenario = src->first_scenario;
+    } else {
+        fprintf(stderr, "错误: 场景区间[%llu, %llu)与[%llu, %llu)不相邻，无法合并\n",
+                (unsigned long long)dst->first_scenario,
+                (unsigned long long)(dst->first_scenario + dst->scenarios),
+                (unsigned long long)src->first_scenario,
+                (unsigned long long)(src->first_scenario + src->scenarios));
+        return -1;
+    }
+
+    dst->scenarios += src->scenarios;
+    dst->cycles += src->cycles;
+    for (int m = 0; m < 3; m++) {
+        dst->mode_cycles[m] += src->mode_cycles[m];
+    }
+    dst->above_cycles += src->above_cycles;
+    dst->below_cycles += src->below_cycles;
+    dst->soc_limited_cycles += src->soc_limited_cycles;
+    dst->energy_charge_wh += src->energy_charge_wh;
+    dst->energy_discharge_wh += src->energy_discharge_wh;
+    dst->violated_scenarios += src->violated_scenarios;
+    for (int b = 0; b < MONTE_CARLO_HIST_BINS; b++) {
+        dst->violation_hist[b] += src->violation_hist[b];
+    }
+    if (src->V_min < dst->V_min) dst->V_min = src->V_min;
+    if (src->V_max > dst->V_max) dst->V_max = src->V_max;
+    if (src->worst_violation_cycles > dst->worst_violation_cycles
+        || (src->worst_violation_cycles == dst->worst_violation_cycles && src->worst_scenario < dst->worst_scenario)) {
+        dst->worst_scenario = src->worst_scenario;
+        dst->worst_violation_cycles = src->worst_violation_cycles;
+    }
+    return 0;
+}
+
+void MonteCarloAggregate_WriteJson(const MonteCarloAggregate *aggregate, FILE *fp) {
+    MonteCarloRanges ranges = aggregate->ranges;
+    double cycles = aggregate->cycles > 0 ? (double)aggregate->cycles : 1.0;
+
+    fprintf(fp, "{\n");
+    fprintf(fp, "  \"format\": \"%s\",\n", MONTE_CARLO_FORMAT);
+    fprintf(fp, "  \"version\": %d,\n", MONTE_CARLO_VERSION);
+    fprintf(fp, "  \"seed\": \"%llu\",\n", (unsigned long long)aggregate->seed);
+    fprintf(fp, "  \"duration_s\": %.17g,\n", aggregate->duration_s);
+    fprintf(fp, "  \"step_s\": %.17g,\n", aggregate->step_s);
+    fprintf(fp, "  \"cycles_per_scenario\": %llu,\n", (unsigned long long)aggregate->cycles_per_scenario);
+    fprintf(fp, "  \"first_scenario\": %llu,\n", (unsigned long long)aggregate->first_scenario);
+    fprintf(fp, "  \"scenarios\": %llu,\n", (unsigned long long)aggregate->scenarios);
+
+    fprintf(fp, "  \"ranges\": {");
+    for (int i = 0; i < RANGE_COUNT; i++) {
+        const MonteCarloRange *r = Ranges_At(&ranges, i);
+        fprintf(fp, "%s\"%s\": [%.9g, %.9g]", i ? ", " : "", RANGE_NAMES[i], r->lo, r->hi);
+    }
+    fprintf(fp, "},\n");
+
+    fprintf(fp, "  \"totals\": {\n");
+    fprintf(fp, "    \"cycles\": %llu,\n", (unsigned long long)aggregate->cycles);
+    fprintf(fp, "    \"mode_cycles\": [%llu, %llu, %llu],\n", (unsigned long long)aggregate->mode_cycles[0],
+            (unsigned long long)aggregate->mode_cycles[1], (unsigned long long)aggregate->mode_cycles[2]);
+    fprintf(fp, "    \"above_cycles\": %llu,\n", (unsigned long long)aggregate->above_cycles);
+    fprintf(fp, "    \"below_cycles\": %llu,\n", (unsigned long long)aggregate->below_cycles);
+    fprintf(fp, "    \"soc_limited_cycles\": %llu,\n", (unsigned long long)aggregate->soc_limited_cycles);
+    fprintf(fp, "    \"energy_charge_wh\": %lld,\n", (long long)aggregate->energy_charge_wh);
+    fprintf(fp, "    \"energy_discharge_wh\": %lld,\n", (long long)aggregate->energy_discharge_wh);
+    fprintf(fp, "    \"violated_scenarios\": %llu,\n", (unsigned long long)aggregate->violated_scenarios);
+    fprintf(fp, "    \"V_min\": %.9g,\n", aggregate->V_min);
+    fprintf(fp, "    \"V_max\": %.9g\n", aggregate->V_max);
+    fprintf(fp, "  },\n");
+
+    fprintf(fp, "  \"violation_histogram\": [");
+    for (int b = 0; b < MONTE_CARLO_HIST_BINS; b++) {
+        fprintf(fp, "%s%llu", b ? ", " : "", (unsigned long long)aggregate->violation_hist[b]);
+    }
+    fprintf(fp, "],\n");
+
+    fprintf(fp, "  \"worst\": {\"scenario\": %llu, \"violation_cycles\": %llu},\n",
+            (unsigned long long)aggregate->worst_scenario, (unsigned long long)aggregate->worst_violation_cycles);
+
+    // 以下派生指标只供阅读，读取时忽略
+    fprintf(fp, "  \"derived\": {\n");
+    fprintf(fp, "    \"time_above_fraction\": %.6f,\n", (double)aggregate->above_cycles / cycles);
+    fprintf(fp, "    \"time_below_fraction\": %.6f,\n", (double)aggregate->below_cycles / cycles);
+    fprintf(fp, "    \"time_above_hours\": %.3f,\n", (double)aggregate->above_cycles * aggregate->step_s / 3600.0);
+    fprintf(fp, "    \"time_below_hours\": %.3f,\n", (double)aggregate->below_cycles * aggregate->step_s / 3600.0);
+    fprintf(fp, "    \"energy_throughput_kwh\": %.3f,\n",
+            (double)(aggregate->energy_charge_wh + aggregate->energy_discharge_wh) / 1000.0);
+    fprintf(fp, "    \"soc_limited_fraction\": %.6f\n", (double)aggregate->soc_limited_cycles / cycles);
+    fprintf(fp, "  }\n");
+    fprintf(fp, "}\n");
+}
+
+static int Json_ReadUint(const cJSON *obj, const char *key, uint64_t *value) {
+    const cJSON *item = cJSON_GetObjectItemCaseSensitive(obj, key);
+    if (!cJSON_IsNumber(item) || item->valuedouble < 0) {
+        fprintf(stderr, "错误: 蒙特卡洛结果缺少字段 %s\n", key);
+        return -1;
+    }
+    *value = (uint64_t)item->valuedouble;
+    return 0;
+}
+
+static int Json_ReadInt(const cJSON *obj, const char *key, int64_t *value) {
+    const cJSON *item = cJSON_GetObjectItemCaseSensitive(obj, key);
+    if (!cJSON_IsNumber(item)) {
+        fprintf(stderr, "错误: 蒙特卡洛结果缺少字段 %s\n", key);
+        return -1;
+    }
+    *value = (int64_t)item->valuedouble;
+    return 0;
+}
+
+static int Json_ReadDouble(const cJSON *obj, const char *key, double *value) {
+    const cJSON *item = cJSON_GetObjectItemCaseSensitive(obj, key);
+    if (!cJSON_IsNumber(item)) {
+        fprintf(stderr, "错误: 蒙特卡洛结果缺少字段 %s\n", key);
+        return -1;
+    }
+    *value = item->valuedouble;
+    return 0;
+}
+
+// 读取长度为n的数值数组
+static int Json_ReadArray(const cJSON *obj, const char *key, double *values, int n) {
+    const cJSON *array = cJSON_GetObjectItemCaseSensitive(obj, key);
+    if (!cJSON_IsArray(array) || cJSON_GetArraySize(array) != n) {
+        fprintf(stderr, "错误: 蒙特卡洛结果字段 %s 应为长度%d的数组\n", key, n);
+        return -1;
+    }
+    for (int i = 0; i < n; i++) {
+        const cJSON *item = cJSON_GetArrayItem(array, i);
+        if (!cJSON_IsNumber(item)) {
+            fprintf(stderr, "错误: 蒙特卡洛结果字段 %s 含非数值元素\n", key);
+            return -1;
+        }
+        values[i] = item->valuedouble;
+    }
+    return 0;
+}
+
+static int Aggregate_FromJson(const cJSON *root, MonteCarloAggregate *aggregate) {
+    const cJSON *format = cJSON_GetObjectItemCaseSensitive(root, "format");
+    const cJSON *version = cJSON_GetObjectItemCaseSensitive(root, "version");
+    if (!cJSON_IsString(format) || strcmp(format->valuestring, MONTE_CARLO_FORMAT) != 0
+        || !cJSON_IsNumber(version) || version->valueint != MONTE_CARLO_VERSION) {
+        fprintf(stderr, "错误: 不是版本%d的蒙特卡洛结果文件\n", MONTE_CARLO_VERSION);
+        return -1;
+    }
+    const cJSON *seed = cJSON_GetObjectItemCaseSensitive(root, "seed");
+    if (!cJSON_IsString(seed)) {
+        fprintf(stderr, "错误: 蒙特卡洛结果缺少字段 seed\n");
+        return -1;
+    }
+
+    memset(aggregate, 0, sizeof(*aggregate));
+    aggregate->seed = strtoull(seed->valuestring, NULL, 10);
+    if (Json_ReadDouble(root, "duration_s", &aggregate->duration_s) != 0
+        || Json_ReadDouble(root, "step_s", &aggregate->step_s) != 0
+        || Json_ReadUint(root, "cycles_per_scenario", &aggregate->cycles_per_scenario) != 0
+        || Json_ReadUint(root, "first_scenario", &aggregate->first_scenario) != 0
+        || Json_ReadUint(root, "scenarios", &aggregate->scenarios) != 0) {
+        return -1;
+    }
+
+    const cJSON *ranges = cJSON_GetObjectItemCaseSensitive(root, "ranges");
+    for (int i = 0; i < RANGE_COUNT; i++) {
+        double bounds[2];
+        if (Json_ReadArray(ranges, RANGE_NAMES[i], bounds, 2) != 0) {
+            return -1;
+        }
+        MonteCarloRange *r = Ranges_At(&aggregate->ranges, i);
+        r->lo = (float)bounds[0];
+        r->hi = (float)bounds[1];
+    }
+
+    const cJSON *totals = cJSON_GetObjectItemCaseSensitive(root, "totals");
+    double modes[3];
+    double V_min;
+    double V_max;
+    if (Json_ReadUint(totals, "cycles", &aggregate->cycles) != 0
+        || Json_ReadArray(totals, "mode_cycles", modes, 3) != 0
+        || Json_ReadUint(totals, "above_cycles", &aggregate->above_cycles) != 0
+        || Json_ReadUint(totals, "below_cycles", &aggregate->below_cycles) != 0
+        || Json_ReadUint(totals, "soc_limited_cycles", &aggregate->soc_limited_cycles) != 0
+        || Json_ReadInt(totals, "energy_charge_wh", &aggregate->energy_charge_wh) != 0
+        || Json_ReadInt(totals, "energy_discharge_wh", &aggregate->energy_discharge_wh) != 0
+        || Json_ReadUint(totals, "violated_scenarios", &aggregate->violated_scenarios) != 0
+        || Json_ReadDouble(totals, "V_min", &V_min) != 0
+        || Json_ReadDouble(totals, "V_max", &V_max) != 0) {
+        return -1;
+    }
+    for (int m = 0; m < 3; m++) {
+        aggregate->mode_cycles[m] = (uint64_t)modes[m];
+    }
+    aggregate->V_min = (float)V_min;
+    aggregate->V_max = (float)V_max;
+
+    double hist[MONTE_CARLO_HIST_BINS];
+    if (Json_ReadArray(root, "violation_histogram", hist, MONTE_CARLO_HIST_BINS) != 0) {
+        return -1;
+    }
+    for (int b = 0; b < MONTE_CARLO_HIST_BINS; b++) {
+        aggregate->violation_hist[b] = (uint64_t)hist[b];
+    }
+
+    const cJSON *worst = cJSON_GetObjectItemCaseSensitive(root, "worst");
+    if (Json_ReadUint(worst, "scenario", &aggregate->worst_scenario) != 0
+        || Json_ReadUint(worst, "violation_cycles", &aggregate->worst_violation_cycles) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+int MonteCarloAggregate_ReadJson(const char *filename, MonteCarloAggregate *aggregate) {
+    char *content = Read_TextFile(filename, "蒙特卡洛结果文件");
+    if (!content) {
+        return -1;
+    }
+
+    cJSON *root = cJSON_Parse(content);
+    free(content);
+    if (!root) {
+        fprintf(stderr, "错误: 蒙特卡洛结果文件 %s 不是合法的JSON\n", filename);
+        return -1;
+    }
+    int ret = Aggregate_FromJson(root, aggregate);
+    cJSON_Delete(root);
+    if (ret != 0) {
+        fprintf(stderr, "错误: 无法读取蒙特卡洛结果文件 %s\n", filename);
+    }
+    return ret;
+}
+
+void MonteCarloAggregate_Print(const MonteCarloAggregate *aggregate, FILE *fp) {
+    double cycles = aggregate->cycles > 0 ? (double)aggregate->cycles : 1.0;
+    fprintf(fp, "蒙特卡洛汇总: 场景[%llu, %llu), 每场景%.0fh/%llu周期, 总周期=%llu, 种子=%llu\n",
+            (unsigned long long)aggregate->first_scenario,
+            (unsigned long long)(aggregate->first_scenario + aggregate->scenarios),
+            aggregate->duration_s / 3600.0, (unsigned long long)aggregate->cycles_per_scenario,
+            (unsigned long long)aggregate->cycles, (unsigned long long)aggregate->seed);
+    fprintf(fp, "  电压越限: 高于上限死区=%.3f%%, 低于下限死区=%.3f%%, 出现越限的场景=%llu/%llu, 电压范围=%.2f~%.2fV\n",
+            100.0 * (double)aggregate->above_cycles / cycles, 100.0 * (double)aggregate->below_cycles / cycles,
+            (unsigned long long)aggregate->violated_scenarios, (unsigned long long)aggregate->scenarios,
+            aggregate->V_min, aggregate->V_max);
+    fprintf(fp, "  能量: 充电=%.1fkWh, 放电=%.1fkWh, SOC限值生效=%.3f%%\n",
+            (double)aggregate->energy_charge_wh / 1000.0, (double)aggregate->energy_discharge_wh / 1000.0,
+            100.0 * (double)aggregate->soc_limited_cycles / cycles);
+    fprintf(fp, "  最差场景: #%llu, 越限时间占比=%.2f%%\n", (unsigned long long)aggregate->worst_scenario,
+            aggregate->cycles_per_scenario
+                ? 100.0 * (double)aggregate->worst_violation_cycles / (double)aggregate->cycles_per_scenario : 0.0);
+}
@@ -0,0 +1,156 @@
+/*
+ * 文件：monte_carlo.h
+ * 功能：并行蒙特卡洛电压越限研究
+ *
+ * 功能描述：
+ * 1. 按种子生成大量随机场景(电压基准/幅值/周期、初始SOC、扰动幅度、PI增益倍数)，
+ *    每个场景在虚拟时钟上超实时仿真，多核并行执行
+ * 2. 场景i的参数与随机流只由(种子, i)决定，结果与线程数、执行顺序无关
+ * 3. 汇总量全部为整数(周期数、Wh)，不同批次(场景编号区间相邻)的结果可精确合并，
+ *    合并顺序不影响结果
+ * 4. 汇总结果以JSON读写
+ */
+
+#ifndef VOLTAGE_CONTROL_MONTE_CARLO_H
+#define VOLTAGE_CONTROL_MONTE_CARLO_H
+
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include "voltage_control.h"
+
+#define MONTE_CARLO_FORMAT "voltage_control_monte_carlo"
+#define MONTE_CARLO_VERSION 1
+#define MONTE_CARLO_HIST_BINS 20        // 场景越限时间占比直方图分桶数(每桶5%)
+
+/* ---------- 参数取值区间(均匀分布) ---------- */
+typedef struct {
+    float lo;
+    float hi;
+} MonteCarloRange;
+
+/* ---------- 场景参数取值区间 ---------- */
+typedef struct {
+    MonteCarloRange V_base;             // 电压基准 (V)
+    MonteCarloRange V_amplitude;        // 电压波动幅值 (V)
+    MonteCarloRange V_period_s;         // 电压波动周期 (s)
+    MonteCarloRange initial_soc;        // 初始SOC
+    MonteCarloRange perturbation_scale; // SOC随机扰动幅度倍数
+    MonteCarloRange Kp_scale;           // 比例增益倍数(过压、欠压同时缩放)
+    MonteCarloRange Ki_scale;           // 积分增益倍数(过压、欠压同时缩放)
+} MonteCarloRanges;
+
+/* ---------- 研究参数 ---------- */
+typedef struct {
+    uint64_t seed;                      // 随机种子
+    uint64_t first_scenario;            // 本批次第一个场景编号
+    uint64_t scenarios;                 // 本批次场景数
+    double duration_s;                  // 每个场景的仿真时长 (s)
+    double step_s;                      // 仿真步长 (s)
+    int threads;                        // 工作线程数，小于1时使用全部硬件线程
+} MonteCarloOptions;
+
+/* ---------- 单个场景参数 ---------- */
+typedef struct {
+    uint64_t index;                     // 场景编号
+    float V_base;
+    float V_amplitude;
+    float V_period_s;
+    float initial_soc;
+    float perturbation_scale;
+    float Kp_scale;
+    float Ki_scale;
+} MonteCarloScenario;
+
+/* ---------- 汇总结果 ---------- */
+typedef struct {
+    // 研究参数，合并时必须一致
+    uint64_t seed;
+    double duration_s;
+    double step_s;
+    uint64_t cycles_per_scenario;
+    MonteCarloRanges ranges;
+
+    // 覆盖的场景编号区间 [first_scenario, first_scenario + scenarios)
+    uint64_t first_scenario;
+    uint64_t scenarios;
+
+    // 全部场景累计
+    uint64_t cycles;                    // 总周期数
+    uint64_t mode_cycles[3];            // 正常/过压/欠压周期数
+    uint64_t above_cycles;              // 电压高于V_ref_upper + Deadband_upper的周期数
+    uint64_t below_cycles;              // 电压低于V_ref_lower - Deadband_lower的周期数
+    uint64_t soc_limited_cycles;        // SOC降额限值生效的周期数
+    int64_t energy_charge_wh;           // 充电能量 (Wh，每个场景四舍五入后累加)
+    int64_t energy_discharge_wh;        // 放电能量 (Wh)
+    uint64_t violated_scenarios;        // 出现过越限的场景数
+    uint64_t violation_hist[MONTE_CARLO_HIST_BINS]; // 按越限时间占比统计的场景数
+    float V_min;
+    float V_max;
+
+    // 越限时间最长的场景(相同时取编号小者)
+    uint64_t worst_scenario;
+    uint64_t worst_violation_cycles;
+} MonteCarloAggregate;
+
+/**
+ * @brief 默认场景参数取值区间
+ * @param ranges [输出] 取值区间
+ */
+void MonteCarlo_DefaultRanges(MonteCarloRanges *ranges);
+
+/**
+ * @brief 由种子和场景编号生成场景参数(与线程、批次无关)
+ * @param seed 随机种子
+ * @param ranges 取值区间
+ * @param index 场景编号
+ * @param scenario [输出] 场景参数
+ */
+void MonteCarlo_MakeScenario(uint64_t seed, const MonteCarloRanges *ranges, uint64_t index,
+                             MonteCarloScenario *scenario);
+
+/**
+ * @brief 并行运行一批场景并汇总
+ * @param cfg 基准配置参数(PI增益按场景倍数缩放)
+ * @param curve SOC降额曲线
+ * @param ranges 场景参数取值区间
+ * @param options 研究参数
+ * @param stop_flag 外部停止标志，置位后尽快结束并返回失败，可为NULL
+ * @param aggregate [输出] 汇总结果
+ * @return int 成功返回0，参数错误、内存不足或被中断返回-1
+ */
+int MonteCarlo_Run(const SystemConfig_Cfg *cfg, const SOC_DeratingCurve *curve, const MonteCarloRanges *ranges,
+                   const MonteCarloOptions *options, const volatile sig_atomic_t *stop_flag,
+                   MonteCarloAggregate *aggregate);
+
+/**
+ * @brief 把src合并到dst，两者研究参数必须一致且场景编号区间相邻
+ * @param dst 汇总结果
+ * @param src 待合并的汇总结果
+ * @return int 成功返回0，不可合并返回-1
+ */
+int MonteCarloAggregate_Merge(MonteCarloAggregate *dst, const MonteCarloAggregate *src);
+
+/**
+ * @brief 以JSON格式输出汇总结果(含便于阅读的派生指标)
+ * @param aggregate 汇总结果
+ * @param fp 输出流
+ */
+void MonteCarloAggregate_WriteJson(const MonteCarloAggregate *aggregate, FILE *fp);
+
+/**
+ * @brief 从JSON文件读取汇总结果
+ * @param filename 文件名
+ * @param aggregate [输出] 汇总结果
+ * @return int 成功返回0，失败返回-1
+ */
+int MonteCarloAggregate_ReadJson(const char *filename, MonteCarloAggregate *aggregate);
+
+/**
+ * @brief 输出汇总结果摘要
+ * @param aggregate 汇总结果
+ * @param fp 输出流
+ */
+void MonteCarloAggregate_Print(const MonteCarloAggregate *aggregate, FILE *fp);
+
+#endif // VOLTAGE_CONTROL_MONTE_CARLO_H
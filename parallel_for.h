@@ -0,0 +1,65 @@
+/*
+ * 文件：parallel_for.h
+ * 功能：多核并行执行独立任务
+ *
+ * 功能描述：
+ * 1. 把下标0~count-1的独立任务分给多个工作线程，线程通过原子计数器动态领取任务，
+ *    各任务耗时不均时也能保持负载均衡
+ * 2. 每个任务只写自己下标对应的结果，汇总由调用者在全部完成后按下标顺序进行，
+ *    因此结果与线程数、调度顺序无关
+ */
+
+#ifndef VOLTAGE_CONTROL_PARALLEL_FOR_H
+#define VOLTAGE_CONTROL_PARALLEL_FOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief 默认工作线程数(硬件线程数，无法获取时为1)
+ * @return int 线程数
+ */
+inline int ParallelFor_DefaultThreads(void) {
+    unsigned int n = std::thread::hardware_concurrency();
+    return n > 0 ? (int)n : 1;
+}
+
+/**
+ * @brief 并行执行fn(0) ~ fn(count-1)，全部完成后返回
+ * @param count 任务数
+ * @param threads 工作线程数，小于1时使用ParallelFor_DefaultThreads()；调用线程也参与执行
+ * @param fn 任务函数，形如void fn(size_t index)，不同下标可能在不同线程上同时执行
+ */
+template <typename Fn>
+void ParallelFor(size_t count, int threads, Fn fn) {
+    if (threads < 1) {
+        threads = ParallelFor_DefaultThreads();
+    }
+    if ((size_t)threads > count) {
+        threads = (int)count;
+    }
+
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (;;) {
+            size_t index = next.fetch_add(1, std::memory_order_relaxed);
+            if (index >= count) {
+                break;
+            }
+            fn(index);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; t++) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (size_t t = 0; t < pool.size(); t++) {
+        pool[t].join();
+    }
+}
+
+#endif // VOLTAGE_CONTROL_PARALLEL_FOR_H
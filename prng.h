@@ -0,0 +1,70 @@
+/*
+ * 文件：prng.h
+ * 功能：可设定种子的轻量伪随机数发生器(PCG32)
+ *
+ * 功能描述：
+ * 1. 状态只有两个64位整数，每个实例独立，不依赖任何全局状态，可在多线程中各自使用
+ * 2. 同一(种子, 流编号)产生的序列在任何平台、任何线程数下完全相同
+ * 3. 不同流编号产生互不相关的序列，便于按台区编号为每个台区分配独立的随机流
+ */
+
+#ifndef VOLTAGE_CONTROL_PRNG_H
+#define VOLTAGE_CONTROL_PRNG_H
+
+#include <cstdint>
+
+#define PRNG_MULTIPLIER 6364136223846793005ULL
+
+/* ---------- PCG32状态 ---------- */
+typedef struct {
+    uint64_t state;             // 内部状态
+    uint64_t inc;               // 流增量(必须为奇数)，由流编号决定
+} Prng;
+
+/**
+ * @brief 产生下一个32位随机数
+ * @param rng 随机数发生器
+ * @return uint32_t 随机数
+ */
+inline uint32_t Prng_Next(Prng *rng) {
+    uint64_t old = rng->state;
+    rng->state = old * PRNG_MULTIPLIER + rng->inc;
+    uint32_t xorshifted = (uint32_t)(((old >> 18) ^ old) >> 27);
+    uint32_t rot = (uint32_t)(old >> 59);
+    return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+}
+
+/**
+ * @brief 设定种子与流编号
+ * @param rng 随机数发生器
+ * @param seed 种子
+ * @param stream 流编号，不同编号的序列互不相关
+ */
+inline void Prng_Seed(Prng *rng, uint64_t seed, uint64_t stream) {
+    rng->state = 0;
+    rng->inc = (stream << 1) | 1u;
+    Prng_Next(rng);
+    rng->state += seed;
+    Prng_Next(rng);
+}
+
+/**
+ * @brief 产生[0, bound)内的随机整数(乘法取高位，偏差小于bound/2^32，仿真用途可忽略)
+ * @param rng 随机数发生器
+ * @param bound 上界(不含)，必须大于0
+ * @return uint32_t 随机整数
+ */
+inline uint32_t Prng_Below(Prng *rng, uint32_t bound) {
+    return (uint32_t)(((uint64_t)Prng_Next(rng) * bound) >> 32);
+}
+
+/**
+ * @brief 产生[0, 1)内均匀分布的随机浮点数(24位精度)
+ * @param rng 随机数发生器
+ * @return float 随机数
+ */
+inline float Prng_Uniform(Prng *rng) {
+    return (float)(Prng_Next(rng) >> 8) * (1.0f / 16777216.0f);
+}
+
+#endif // VOLTAGE_CONTROL_PRNG_H
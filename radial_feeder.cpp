@@ -0,0 +1,332 @@
+/*
+ * 文件：radial_feeder.cpp
+ * 功能：辐射状低压馈线潮流求解实现
+ */
+
+#include "radial_feeder.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#define RADIAL_FLOAT_ARRAYS 10      // 每条母线占用的float数组个数
+
+// 一行馈线数据
+typedef struct {
+    unsigned long bus;
+    unsigned long parent;
+    double values[4];               // R_ohm, X_ohm, load_kw, pv_kw
+} FeederRow;
+
+// 解析一行 bus,parent,R_ohm,X_ohm,load_kw,pv_kw，格式错误返回-1
+static int Feeder_ParseLine(const char *line, FeederRow *row) {
+    char *end;
+    row->bus = strtoul(line, &end, 10);
+    if (end == line || *end != ',') {
+        return -1;
+    }
+    const char *p = end + 1;
+    row->parent = strtoul(p, &end, 10);
+    if (end == p || *end != ',') {
+        return -1;
+    }
+    for (int i = 0; i < 4; i++) {
+        p = end + 1;
+        row->values[i] = strtod(p, &end);
+        if (end == p || (i < 3 && *end != ',')) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// 读入全部数据行，返回行数组(调用者free)与行数
+static FeederRow *Feeder_ReadRows(const char *filename, size_t *row_count) {
+    FILE *fp = fopen(filename, "r");
+    if (!fp) {
+        fprintf(stderr, "错误: 无法打开馈线文件 %s\n", filename);
+        return NULL;
+    }
+
+    size_t capacity = 256;
+    size_t count = 0;
+    FeederRow *rows = (FeederRow *)malloc(capacity * sizeof(FeederRow));
+    char line[256];
+    long line_num = 0;
+    int ret = rows ? 0 : -1;
+    if (!rows) {
+        fprintf(stderr, "错误: 内存分配失败\n");
+    }
+
+    while (ret == 0 && fgets(line, sizeof(line), fp)) {
+        line_num++;
+        if (line[0] == '\n' || line[0] == '\r' || line[0] == '#') {
+            continue;
+        }
+        FeederRow row;
+        if (Feeder_ParseLine(line, &row) != 0) {
+            if (count == 0) {
+                continue; // 表头
+            }
+            fprintf(stderr, "错误: 馈线文件第%ld行格式错误，应为 bus,parent,R_ohm,X_ohm,load_kw,pv_kw\n", line_num);
+            ret = -1;
+            break;
+        }
+        if (!(row.values[0] >= 0.0 && row.values[1] >= 0.0)) {
+            fprintf(stderr, "错误: 馈线文件第%ld行支路阻抗为负\n", line_num);
+            ret = -1;
+            break;
+        }
+        if (count == capacity) {
+            capacity *= 2;
+            FeederRow *grown = (FeederRow *)realloc(rows, capacity * sizeof(FeederRow));
+            if (!grown) {
+                fprintf(stderr, "错误: 内存分配失败\n");
+                ret = -1;
+                break;
+            }
+            rows = grown;
+        }
+        rows[count++] = row;
+    }
+    fclose(fp);
+
+    if (ret == 0 && count == 0) {
+        fprintf(stderr, "错误: 馈线文件 %s 中没有数据行\n", filename);
+        ret = -1;
+    }
+    if (ret != 0) {
+        free(rows);
+        return NULL;
+    }
+    *row_count = count;
+    return rows;
+}
+
+// 分配各数组
+static int RadialFeeder_Alloc(RadialFeeder *feeder, size_t n) {
+    float *f = (float *)calloc(n * RADIAL_FLOAT_ARRAYS, sizeof(float));
+    int32_t *k = (int32_t *)calloc(3 * n + 1, sizeof(int32_t));
+    if (!f || !k) {
+        fprintf(stderr, "错误: 内存分配失败\n");
+        free(f);
+        free(k);
+        return -1;
+    }
+    feeder->block = f;
+    feeder->R_ohm = f;      f += n;
+    feeder->X_ohm = f;      f += n;
+    feeder->load_kw = f;    f += n;
+    feeder->pv_kw = f;      f += n;
+    feeder->P_w = f;        f += n;
+    feeder->Q_var = f;      f += n;
+    feeder->V_re = f;       f += n;
+    feeder->V_im = f;       f += n;
+    feeder->I_re = f;       f += n;
+    feeder->I_im = f;
+    feeder->index_block = k;
+    feeder->parent = k;                 k += n;
+    feeder->bus_id = (uint32_t *)k;     k += n;
+    feeder->index_of_id = k;
+    feeder->bus_count = n;
+    return 0;
+}
+
+int RadialFeeder_LoadCsv(RadialFeeder *feeder, const char *filename, float V_source) {
+    memset(feeder, 0, sizeof(*feeder));
+    size_t n = 0;
+    FeederRow *rows = Feeder_ReadRows(filename, &n);
+    if (!rows) {
+        return -1;
+    }
+
+    // 按父母线编号把各行排成子母线表：父编号p的子母线为 child_row[child_start[p] .. child_start[p+1])
+    int32_t *child_start = (int32_t *)calloc(n + 2, sizeof(int32_t));
+    int32_t *child_row = (int32_t *)malloc(n * sizeof(int32_t));
+    uint8_t *seen = (uint8_t *)calloc(n + 1, 1);
+    if (!child_start || !child_row || !seen || RadialFeeder_Alloc(feeder, n) != 0) {
+        if (!child_start || !child_row || !seen) {
+            fprintf(stderr, "错误: 内存分配失败\n");
+        }
+        free(child_start);
+        free(child_row);
+        free(seen);
+        free(rows);
+        return -1;
+    }
+    int ret = 0;
+    for (size_t r = 0; r < n && ret == 0; r++) {
+        unsigned long id = rows[r].bus;
+        if (id == 0 || id > n || rows[r].parent > n || rows[r].parent == id) {
+            fprintf(stderr, "错误: 馈线母线%lu的编号或父母线%lu非法(编号须为1~%zu)\n", id, rows[r].parent, n);
+            ret = -1;
+        } else if (seen[id]) {
+            fprintf(stderr, "错误: 馈线母线%lu重复出现\n", id);
+            ret = -1;
+        } else {
+            seen[id] = 1;
+            child_start[rows[r].parent + 1]++;
+        }
+    }
+    for (size_t id = 1; id <= n + 1; id++) {
+        child_start[id] += child_start[id - 1];
+    }
+    for (size_t r = 0; r < n && ret == 0; r++) {
+        child_row[child_start[rows[r].parent]++] = (int32_t)r;
+    }
+    for (size_t id = n + 1; id > 0; id--) {
+        child_start[id] = child_start[id - 1]; // 填表时各起点已后移一段，恢复
+    }
+    child_start[0] = 0;
+
+    // 从电源母线出发逐层展开，拓扑序下标即访问顺序，父母线总在子母线之前；
+    // 有环或不连通的母线不会被访问到。拓扑序数组本身充当队列
+    size_t ordered = 0;
+    for (size_t id = 0; id <= n; id++) {
+        feeder->index_of_id[id] = -1;
+    }
+    for (size_t head = 0; ret == 0 && head <= ordered; head++) {
+        uint32_t id = head == 0 ? 0 : feeder->bus_id[head - 1];
+        int32_t parent_index = head == 0 ? -1 : (int32_t)(head - 1);
+        for (int32_t c = child_start[id]; c < child_start[id + 1]; c++) {
+            const FeederRow *row = &rows[child_row[c]];
+            size_t index = ordered++;
+            feeder->parent[index] = parent_index;
+            feeder->bus_id[index] = (uint32_t)row->bus;
+            feeder->index_of_id[row->bus] = (int32_t)index;
+            feeder->R_ohm[index] = (float)row->values[0];
+            feeder->X_ohm[index] = (float)row->values[1];
+            feeder->load_kw[index] = (float)row->values[2];
+            feeder->pv_kw[index] = (float)row->values[3];
+        }
+    }
+    if (ret == 0 && ordered != n) {
+        fprintf(stderr, "错误: 馈线有%zu条母线未连通到电源母线(存在环或孤立部分)\n", n - ordered);
+        ret = -1;
+    }
+    free(child_start);
+    free(child_row);
+    free(seen);
+    free(rows);
+    if (ret != 0) {
+        RadialFeeder_Free(feeder);
+        return -1;
+    }
+
+    feeder->V_source = V_source;
+    for (size_t i = 0; i < n; i++) {
+        feeder->V_re[i] = V_source;
+    }
+    return 0;
+}
+
+int RadialFeeder_Clone(RadialFeeder *dst, const RadialFeeder *src) {
+    memset(dst, 0, sizeof(*dst));
+    size_t n = src->bus_count;
+    if (RadialFeeder_Alloc(dst, n) != 0) {
+        return -1;
+    }
+    memcpy(dst->block, src->block, n * RADIAL_FLOAT_ARRAYS * sizeof(float));
+    memcpy(dst->index_block, src->index_block, (3 * n + 1) * sizeof(int32_t));
+    dst->V_source = src->V_source;
+    return 0;
+}
+
+void RadialFeeder_Free(RadialFeeder *feeder) {
+    free(feeder->block);
+    free(feeder->index_block);
+    memset(feeder, 0, sizeof(*feeder));
+}
+
+int32_t RadialFeeder_BusIndex(const RadialFeeder *feeder, uint32_t bus_id) {
+    if (bus_id == 0 || bus_id > feeder->bus_count) {
+        return -1;
+    }
+    return feeder->index_of_id[bus_id];
+}
+
+int RadialFeeder_Solve(RadialFeeder *feeder, float load_pu, float pv_pu, float load_tan_phi,
+                       const uint32_t *storage_bus, const float *P_storage, size_t storage_count) {
+    size_t n = feeder->bus_count;
+    const int32_t *parent = feeder->parent;
+    float *V_re = feeder->V_re;
+    float *V_im = feeder->V_im;
+    float *I_re = feeder->I_re;
+    float *I_im = feeder->I_im;
+
+    // 各母线消耗功率：负荷 - 光伏 + 储能充电
+    for (size_t i = 0; i < n; i++) {
+        float P_load = feeder->load_kw[i] * load_pu;
+        feeder->P_w[i] = (P_load - feeder->pv_kw[i] * pv_pu) * 1000.0f;
+        feeder->Q_var[i] = P_load * load_tan_phi * 1000.0f;
+    }
+    for (size_t k = 0; k < storage_count; k++) {
+        feeder->P_w[storage_bus[k]] += P_storage[k] * 1000.0f;
+    }
+
+    int iteration = 0;
+    float max_change_sq = 0.0f;
+    float tolerance_sq = RADIAL_TOLERANCE_V * RADIAL_TOLERANCE_V;
+    do {
+        iteration++;
+
+        // 回代：负荷电流 I = conj(S / V)，逆拓扑序把子支路电流累加到父支路
+        for (size_t i = 0; i < n; i++) {
+            float inv = 1.0f / (V_re[i] * V_re[i] + V_im[i] * V_im[i]);
+            I_re[i] = (feeder->P_w[i] * V_re[i] + feeder->Q_var[i] * V_im[i]) * inv;
+            I_im[i] = (feeder->P_w[i] * V_im[i] - feeder->Q_var[i] * V_re[i]) * inv;
+        }
+        for (size_t i = n; i-- > 0;) {
+            if (parent[i] >= 0) {
+                I_re[parent[i]] += I_re[i];
+                I_im[parent[i]] += I_im[i];
+            }
+        }
+
+        // 前推：V = V_parent - Z * I
+        max_change_sq = 0.0f;
+        for (size_t i = 0; i < n; i++) {
+            float up_re = parent[i] >= 0 ? V_re[parent[i]] : feeder->V_source;
+            float up_im = parent[i] >= 0 ? V_im[parent[i]] : 0.0f;
+            float re = up_re - (feeder->R_ohm[i] * I_re[i] - feeder->X_ohm[i] * I_im[i]);
+            float im = up_im - (feeder->R_ohm[i] * I_im[i] + feeder->X_ohm[i] * I_re[i]);
+            float d_re = re - V_re[i];
+            float d_im = im - V_im[i];
+            float change_sq = d_re * d_re + d_im * d_im;
+            max_change_sq = change_sq > max_change_sq ? change_sq : max_change_sq;
+            V_re[i] = re;
+            V_im[i] = im;
+        }
+    } while (max_change_sq > tolerance_sq && iteration < RADIAL_MAX_ITERATIONS);
+
+    feeder->solves++;
+    feeder->iterations_total += (uint64_t)iteration;
+    if (iteration > feeder->iterations_max) {
+        feeder->iterations_max = iteration;
+    }
+    if (max_change_sq > tolerance_sq) {
+        feeder->nonconverged++;
+    }
+    return iteration;
+}
+
+void RadialFeeder_PrintStats(const RadialFeeder *feeder, FILE *fp) {
+    double load_total = 0.0;
+    double pv_total = 0.0;
+    float V_min = feeder->V_source;
+    float V_max = feeder->V_source;
+    for (size_t i = 0; i < feeder->bus_count; i++) {
+        load_total += feeder->load_kw[i];
+        pv_total += feeder->pv_kw[i];
+        float V = RadialFeeder_Magnitude(feeder, i);
+        V_min = V < V_min ? V : V_min;
+        V_max = V > V_max ? V : V_max;
+    }
+    fprintf(fp, "辐射状馈线: 母线数=%zu, 负荷峰值合计=%.1fkW, 光伏峰值合计=%.1fkW, 当前电压范围=%.2f~%.2fV\n",
+            feeder->bus_count, load_total, pv_total, V_min, V_max);
+    if (feeder->solves > 0) {
+        fprintf(fp, "  潮流求解: 次数=%llu, 平均迭代=%.2f, 最大迭代=%d, 未收敛=%llu\n",
+                (unsigned long long)feeder->solves, (double)feeder->iterations_total / (double)feeder->solves,
+                feeder->iterations_max, (unsigned long long)feeder->nonconverged);
+    }
+}
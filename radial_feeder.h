@@ -0,0 +1,118 @@
+/*
+ * 文件：radial_feeder.h
+ * 功能：辐射状低压馈线潮流求解(前推回代法)
+ *
+ * 功能描述：
+ * 1. 从CSV读入馈线拓扑与各母线负荷/光伏，加载时把母线按拓扑序(父母线在前)重新编号，
+ *    之后每步求解只是两次顺序遍历，不再做任何拓扑分析
+ * 2. 回代：由各母线注入功率与当前电压求负荷电流，逆拓扑序累加得到各支路电流；
+ *    前推：按拓扑序由父母线电压减去支路压降得到子母线电压；迭代至电压变化小于容差
+ * 3. 以上一步的解作为初值(热启动)，仿真中相邻步变化很小，通常两三次迭代即收敛
+ * 4. 求解过程不分配内存，各量按字段存放为连续数组
+ */
+
+#ifndef VOLTAGE_CONTROL_RADIAL_FEEDER_H
+#define VOLTAGE_CONTROL_RADIAL_FEEDER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cmath>
+
+#define RADIAL_MAX_ITERATIONS 20        // 每步最大迭代次数
+#define RADIAL_TOLERANCE_V 1e-3f        // 收敛容差：两次迭代间各母线电压变化的最大模值 (V)
+
+/* ---------- 辐射状馈线 ---------- */
+typedef struct {
+    size_t bus_count;               // 母线数量(不含电源母线0)
+    int32_t *parent;                // 父母线的拓扑序下标，-1表示直接接在电源母线上
+    float *R_ohm;                   // 本母线与父母线之间支路的电阻 (Ω)
+    float *X_ohm;                   // 支路电抗 (Ω)
+    float *load_kw;                 // 负荷峰值 (kW)
+    float *pv_kw;                   // 光伏峰值 (kW)
+    float *P_w;                     // 本步消耗有功功率 (W)，负值为净发电
+    float *Q_var;                   // 本步消耗无功功率 (var)
+    float *V_re;                    // 母线电压实部 (V)，同时作为下一步的初值
+    float *V_im;                    // 母线电压虚部 (V)
+    float *I_re;                    // 支路电流实部 (A)，求解时的中间结果
+    float *I_im;                    // 支路电流虚部 (A)
+    uint32_t *bus_id;               // 拓扑序下标 -> 文件中的母线编号
+    int32_t *index_of_id;           // 母线编号 -> 拓扑序下标，长度bus_count+1
+    float V_source;                 // 电源母线电压 (V)
+    uint64_t solves;                // 求解次数
+    uint64_t iterations_total;      // 累计迭代次数
+    uint64_t nonconverged;          // 达到最大迭代次数仍未收敛的次数
+    int iterations_max;             // 单步最大迭代次数
+    void *block;                    // float数组共用的内存
+    void *index_block;              // 整数数组共用的内存
+} RadialFeeder;
+
+/**
+ * @brief 从CSV文件加载馈线
+ *
+ * 每行 bus,parent,R_ohm,X_ohm,load_kw,pv_kw：母线编号为1~N且各出现一次，
+ * parent为0表示接在电源母线(配变低压侧)上；首行可为表头，#开头的行为注释。
+ * 拓扑须为以电源母线为根的树(无环、全部连通)。
+ * @param feeder [输出] 馈线
+ * @param filename CSV文件路径
+ * @param V_source 电源母线电压 (V)
+ * @return int 成功返回0，失败返回-1(已输出错误信息)
+ */
+int RadialFeeder_LoadCsv(RadialFeeder *feeder, const char *filename, float V_source);
+
+/**
+ * @brief 复制馈线(含当前电压，求解统计清零)，供多个线程各自独立求解
+ * @param dst [输出] 副本
+ * @param src 馈线
+ * @return int 成功返回0，内存不足返回-1
+ */
+int RadialFeeder_Clone(RadialFeeder *dst, const RadialFeeder *src);
+
+/**
+ * @brief 释放馈线
+ * @param feeder 馈线
+ */
+void RadialFeeder_Free(RadialFeeder *feeder);
+
+/**
+ * @brief 母线编号换算为拓扑序下标
+ * @param feeder 馈线
+ * @param bus_id 母线编号
+ * @return int32_t 拓扑序下标，编号不存在返回-1
+ */
+int32_t RadialFeeder_BusIndex(const RadialFeeder *feeder, uint32_t bus_id);
+
+/**
+ * @brief 求解一步潮流
+ * @param feeder 馈线
+ * @param load_pu 负荷标幺值(乘各母线负荷峰值)
+ * @param pv_pu 光伏标幺值(乘各母线光伏峰值)
+ * @param load_tan_phi 负荷无功/有功之比
+ * @param storage_bus 各储能所在母线的拓扑序下标
+ * @param P_storage 各储能功率 (kW)，正为充电
+ * @param storage_count 储能数量
+ * @return int 本步迭代次数
+ */
+int RadialFeeder_Solve(RadialFeeder *feeder, float load_pu, float pv_pu, float load_tan_phi,
+                       const uint32_t *storage_bus, const float *P_storage, size_t storage_count);
+
+/**
+ * @brief 第index个母线(拓扑序)的电压幅值
+ * @param feeder 馈线
+ * @param index 拓扑序下标
+ * @return float 电压幅值 (V)
+ */
+inline float RadialFeeder_Magnitude(const RadialFeeder *feeder, size_t index) {
+    float re = feeder->V_re[index];
+    float im = feeder->V_im[index];
+    return sqrtf(re * re + im * im);
+}
+
+/**
+ * @brief 输出馈线摘要与求解统计
+ * @param feeder 馈线
+ * @param fp 输出流
+ */
+void RadialFeeder_PrintStats(const RadialFeeder *feeder, FILE *fp);
+
+#endif // VOLTAGE_CONTROL_RADIAL_FEEDER_H
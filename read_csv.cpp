@@ -0,0 +1,97 @@
+/*
+ * 文件：read_csv.cpp
+ * 功能：从CSV文件加载配置
+ * 作者：HMQ
+ * 日期：2025/9/20
+ *
+ * 功能描述：
+ * 1. 每行一个"键,值"，空行与以#开头的注释行跳过
+ * 2. 键名按字段表(见config_schema.h)查找，未知键只给出警告
+ * 3. 值不是数值(含数值后有多余字符)或超出范围、同一键出现多次、缺少参数、参数之间关系不合理时返回失败
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "voltage_control.h"
+#include "config_schema.h"
+
+/**
+ * @brief 从CSV文件中加载配置
+ * @param filename CSV文件名
+ * @param cfg [输出] 配置参数
+ * @return int 成功返回0，失败返回-1
+ */
+int load_configuration_from_csv(const char *filename, SystemConfig_Cfg *cfg) {
+    FILE *fp = fopen(filename, "r");
+    if (!fp) {
+        fprintf(stderr, "错误: 无法打开CSV文件 %s\n", filename);
+        return -1;
+    }
+
+    SystemConfig_Cfg loaded;
+    memset(&loaded, 0, sizeof(loaded));
+    unsigned char seen[CONFIG_SCHEMA_FIELD_COUNT] = {0};
+    char line[256];
+    int line_num = 0;
+    int ret = 0;
+
+    while (fgets(line, sizeof(line), fp)) {
+        line_num++;
+
+        // 跳过空行和注释行（以#开头的行）
+        if (line[0] == '\n' || line[0] == '#' || line[0] == '\r') {
+            continue;
+        }
+
+        // 移除行尾的换行符
+        line[strcspn(line, "\n\r")] = '\0';
+
+        // 分割键值对(不用strtok：热加载线程与主线程可能同时解析)，与strtok一样跳过空字段
+        char *key = line + strspn(line, ",");
+        char *key_end = key + strcspn(key, ",");
+        char *value_str = NULL;
+        if (*key_end) {
+            *key_end = '\0';
+            value_str = key_end + 1 + strspn(key_end + 1, ",");
+            value_str[strcspn(value_str, ",")] = '\0';
+        }
+
+        if (*key && value_str && *value_str) {
+            // 根据键名设置对应的配置参数
+            const ConfigSchemaField *field = ConfigSchema_Find(key, strlen(key));
+            if (!field) {
+                fprintf(stderr, "警告: 第%d行未知的配置项: %s\n", line_num, key);
+                continue;
+            }
+            if (seen[field - CONFIG_SCHEMA]) {
+                fprintf(stderr, "错误: 配置文件%s第%d行%s重复\n", filename, line_num, key);
+                ret = -1;
+                continue;
+            }
+            // 数值后只允许空白，"12abc"这样的值按格式错误处理
+            char *end;
+            double value = strtod(value_str, &end);
+            end += strspn(end, " \t");
+            if (end == value_str || *end != '\0') {
+                fprintf(stderr, "错误: 配置文件%s第%d行%s应为数值\n", filename, line_num, key);
+                ret = -1;
+                continue;
+            }
+            if (ConfigSchema_Set(&loaded, field, value, filename) != 0) {
+                ret = -1;
+                continue;
+            }
+            seen[field - CONFIG_SCHEMA] = 1;
+        } else {
+            fprintf(stderr, "警告: 第%d行格式错误: %s\n", line_num, line);
+        }
+    }
+
+    fclose(fp);
+    if (ret != 0 || ConfigSchema_CheckComplete(seen, filename) != 0 || ConfigSchema_Validate(&loaded, filename) != 0) {
+        return -1;
+    }
+    *cfg = loaded;
+    return 0;
+}
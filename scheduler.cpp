@@ -0,0 +1,135 @@
+/*
+ * 文件：scheduler.cpp
+ * 功能：基于绝对单调截止时刻的周期调度器实现
+ */
+
+#include "scheduler.h"
+
+#include <cerrno>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#define NS_PER_SEC 1000000000LL
+#define NS_PER_MS  1000000LL
+
+int64_t Monotonic_NowNs(void) {
+#if defined(_WIN32)
+    static LARGE_INTEGER freq = {};
+    LARGE_INTEGER counter;
+    if (freq.QuadPart == 0) {
+        QueryPerformanceFrequency(&freq);
+    }
+    QueryPerformanceCounter(&counter);
+    // 拆分整数部分和余数部分，避免乘法溢出
+    return (counter.QuadPart / freq.QuadPart) * NS_PER_SEC
+           + (counter.QuadPart % freq.QuadPart) * NS_PER_SEC / freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * NS_PER_SEC + ts.tv_nsec;
+#endif
+}
+
+// 休眠到单调时钟的绝对时刻deadline_ns
+static void Sleep_UntilNs(int64_t deadline_ns) {
+#if defined(_WIN32)
+    // Windows没有单调时钟上的绝对定时休眠：先粗粒度Sleep，剩余不足2ms的部分让出CPU等待
+    for (;;) {
+        int64_t remaining = deadline_ns - Monotonic_NowNs();
+        if (remaining <= 0) {
+            break;
+        }
+        if (remaining > 2 * NS_PER_MS) {
+            Sleep((DWORD)((remaining - NS_PER_MS) / NS_PER_MS));
+        } else {
+            SwitchToThread();
+        }
+    }
+#elif defined(__linux__)
+    struct timespec ts;
+    ts.tv_sec = (time_t)(deadline_ns / NS_PER_SEC);
+    ts.tv_nsec = (long)(deadline_ns % NS_PER_SEC);
+    // 绝对时刻休眠被信号打断后可以原样重试，不会产生累积误差
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+    }
+#else
+    // 其他POSIX平台：按剩余时间做相对休眠，截止时刻本身仍是绝对的
+    for (;;) {
+        int64_t remaining = deadline_ns - Monotonic_NowNs();
+        if (remaining <= 0) {
+            break;
+        }
+        struct timespec ts;
+        ts.tv_sec = (time_t)(remaining / NS_PER_SEC);
+        ts.tv_nsec = (long)(remaining % NS_PER_SEC);
+        nanosleep(&ts, NULL);
+    }
+#endif
+}
+
+int Scheduler_Init(PeriodicScheduler *sched, int period_ms) {
+    if (period_ms < SCHEDULER_MIN_PERIOD_MS) {
+        fprintf(stderr, "错误: 控制周期%dms小于最小值%dms\n", period_ms, SCHEDULER_MIN_PERIOD_MS);
+        return -1;
+    }
+
+    sched->period_ns = (int64_t)period_ms * NS_PER_MS;
+    sched->next_deadline_ns = Monotonic_NowNs() + sched->period_ns;
+    sched->cycles = 0;
+    sched->overruns = 0;
+    sched->skipped_periods = 0;
+    sched->jitter_last_ns = 0;
+    sched->jitter_max_ns = 0;
+    sched->jitter_sum_ns = 0;
+    return 0;
+}
+
+int Scheduler_WaitNextPeriod(PeriodicScheduler *sched) {
+    int64_t now = Monotonic_NowNs();
+    int overrun = 0;
+
+    // 1. 循环体已经越过截止时刻：记为超时，按整周期向后对齐以保持相位
+    if (now >= sched->next_deadline_ns) {
+        int64_t missed = (now - sched->next_deadline_ns) / sched->period_ns + 1;
+        sched->overruns++;
+        sched->skipped_periods += (uint64_t)(missed - 1);
+        sched->next_deadline_ns += missed * sched->period_ns;
+        overrun = 1;
+    }
+
+    // 2. 休眠到绝对截止时刻
+    Sleep_UntilNs(sched->next_deadline_ns);
+
+    // 3. 统计唤醒抖动
+    int64_t jitter = Monotonic_NowNs() - sched->next_deadline_ns;
+    sched->jitter_last_ns = jitter;
+    sched->jitter_sum_ns += jitter;
+    if (jitter > sched->jitter_max_ns) {
+        sched->jitter_max_ns = jitter;
+    }
+
+    // 4. 下一个截止时刻只在绝对时间轴上推进，与循环体耗时无关
+    sched->next_deadline_ns += sched->period_ns;
+    sched->cycles++;
+    return overrun;
+}
+
+void Scheduler_PrintStats(const PeriodicScheduler *sched, FILE *fp) {
+    double jitter_avg_us = 0.0;
+    if (sched->cycles > 0) {
+        jitter_avg_us = (double)sched->jitter_sum_ns / (double)sched->cycles / 1000.0;
+    }
+    fprintf(fp, "调度统计: 周期=%.1fms, 已运行周期=%llu, 超时次数=%llu, 跳过周期=%llu, "
+                "抖动(最近/平均/最大)=%.1f/%.1f/%.1fus\n",
+            (double)sched->period_ns / NS_PER_MS,
+            (unsigned long long)sched->cycles,
+            (unsigned long long)sched->overruns,
+            (unsigned long long)sched->skipped_periods,
+            (double)sched->jitter_last_ns / 1000.0,
+            jitter_avg_us,
+            (double)sched->jitter_max_ns / 1000.0);
+}
@@ -0,0 +1,65 @@
+/*
+ * 文件：scheduler.h
+ * 功能：基于绝对单调截止时刻的周期调度器
+ *
+ * 功能描述：
+ * 1. 以单调时钟上的绝对截止时刻推进周期，循环体自身的执行时间不会累积成漂移
+ * 2. 控制周期可配置，最小10ms
+ * 3. 统计超时(overrun)次数、跳过的周期数以及唤醒抖动(jitter)
+ * 4. Linux下使用clock_nanosleep(TIMER_ABSTIME)，Windows/其他POSIX平台自动降级
+ */
+
+#ifndef VOLTAGE_CONTROL_SCHEDULER_H
+#define VOLTAGE_CONTROL_SCHEDULER_H
+
+#include <cstdint>
+#include <cstdio>
+
+#define SCHEDULER_MIN_PERIOD_MS 10      // 允许的最小控制周期 (ms)
+
+/* ---------- 周期调度器状态 ---------- */
+typedef struct {
+    int64_t period_ns;          // 控制周期 (ns)
+    int64_t next_deadline_ns;   // 下一次唤醒的绝对时刻 (单调时钟, ns)
+
+    uint64_t cycles;            // 已完成的周期数
+    uint64_t overruns;          // 循环体执行超过截止时刻的次数
+    uint64_t skipped_periods;   // 因超时而整体跳过的周期数
+
+    int64_t jitter_last_ns;     // 最近一次唤醒抖动 (实际唤醒时刻 - 截止时刻)
+    int64_t jitter_max_ns;      // 最大唤醒抖动
+    int64_t jitter_sum_ns;      // 唤醒抖动累计值，用于计算平均值
+} PeriodicScheduler;
+
+/**
+ * @brief 读取单调时钟
+ * @return int64_t 单调时钟当前值 (ns)
+ */
+int64_t Monotonic_NowNs(void);
+
+/**
+ * @brief 初始化调度器，第一个截止时刻为当前时刻加一个周期
+ * @param sched 调度器
+ * @param period_ms 控制周期 (ms)，不得小于SCHEDULER_MIN_PERIOD_MS
+ * @return int 成功返回0，周期非法返回-1
+ */
+int Scheduler_Init(PeriodicScheduler *sched, int period_ms);
+
+/**
+ * @brief 休眠直到下一个截止时刻，并推进截止时刻
+ *
+ * 若调用时已经错过截止时刻，记为一次超时，截止时刻按整周期向后对齐，
+ * 不会为了追赶而连续执行多个周期。
+ * @param sched 调度器
+ * @return int 按时唤醒返回0，本周期超时返回1
+ */
+int Scheduler_WaitNextPeriod(PeriodicScheduler *sched);
+
+/**
+ * @brief 输出调度统计信息
+ * @param sched 调度器
+ * @param fp 输出流
+ */
+void Scheduler_PrintStats(const PeriodicScheduler *sched, FILE *fp);
+
+#endif // VOLTAGE_CONTROL_SCHEDULER_H
@@ -0,0 +1,422 @@
+/*
+ * 文件：simulation.cpp
+ * 功能：基于虚拟时钟的超实时仿真实现
+ */
+
+#include "simulation.h"
+#include "scheduler.h"
+#include "historian.h"
+#include "grid_model.h"
+
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+// 仿真过程中的计数，结束时按步长换算为时长与能量
+typedef struct {
+    uint64_t mode_cycles[3];
+    uint64_t above_cycles;
+    uint64_t below_cycles;
+    uint64_t outside_ref_cycles;
+    uint64_t soc_limited_cycles;
+    double P_charge_sum;        // 正功率指令累计 (kW)
+    double P_discharge_sum;     // 负功率指令绝对值累计 (kW)
+    float V_min;
+    float V_max;
+    float SOC_min;
+    float SOC_max;
+    float P_cmd_abs_max;
+    uint64_t episodes;          // 已稳定的越限事件数
+    uint64_t unsettled_episodes;// 仿真结束时仍未稳定的越限事件数
+    uint64_t settle_cycles_sum; // 已稳定事件的调节周期数累计
+    uint64_t settle_cycles_max;
+    uint64_t unsettled_cycles_sum;  // 未稳定事件从开始到仿真结束的周期数累计
+    float overshoot_max;        // 最大超调 (V)
+} SimulationAccumulator;
+
+// 单个台区的越限事件跟踪状态
+typedef struct {
+    int direction;              // 当前事件方向：0无事件，1过压，-1欠压
+    uint64_t start_cycle;       // 事件开始(电压越出死区)的周期
+    uint64_t inside_since;      // 电压最近一次回到死区内的周期
+    int inside;                 // 电压当前是否在死区内
+    float prev_P_cmd;           // 上一周期的功率指令，即本周期电压所响应的功率
+} ResponseTrack;
+
+static void Accumulator_Init(SimulationAccumulator *acc) {
+    memset(acc, 0, sizeof(*acc));
+    acc->V_min = FLT_MAX;
+    acc->V_max = -FLT_MAX;
+    acc->SOC_min = FLT_MAX;
+    acc->SOC_max = -FLT_MAX;
+}
+
+// 跟踪一个台区一个周期的动态响应：
+// 电压越出死区即开始一个越限事件，回到死区内并连续保持hold_cycles个周期视为稳定，
+// 调节时间为事件开始到最后一次回到死区内的时长；
+// 超调为储能仍按事件方向出力时，电压越过死区边沿进入死区的深度(控制器"拉过头"的幅度)
+static inline void Response_Add(SimulationAccumulator *acc, ResponseTrack *track, uint64_t cycle,
+                                float V_meas, float P_cmd, float upper_edge, float lower_edge,
+                                uint64_t hold_cycles) {
+    int direction = V_meas > upper_edge ? 1 : (V_meas < lower_edge ? -1 : 0);
+    if (track->direction > 0 && track->prev_P_cmd > 0.0f && V_meas < upper_edge) {
+        float overshoot = upper_edge - V_meas;
+        if (overshoot > acc->overshoot_max) acc->overshoot_max = overshoot;
+    } else if (track->direction < 0 && track->prev_P_cmd < 0.0f && V_meas > lower_edge) {
+        float overshoot = V_meas - lower_edge;
+        if (overshoot > acc->overshoot_max) acc->overshoot_max = overshoot;
+    }
+    track->prev_P_cmd = P_cmd;
+
+    if (direction != 0) {
+        if (track->direction == 0) {
+            track->direction = direction;
+            track->start_cycle = cycle;
+        }
+        track->inside = 0;
+        return;
+    }
+    if (track->direction == 0) {
+        return;
+    }
+    if (!track->inside) {
+        track->inside = 1;
+        track->inside_since = cycle;
+    }
+    if (cycle + 1 - track->inside_since >= hold_cycles) {
+        uint64_t settle = track->inside_since - track->start_cycle;
+        acc->episodes++;
+        acc->settle_cycles_sum += settle;
+        if (settle > acc->settle_cycles_max) acc->settle_cycles_max = settle;
+        track->direction = 0;
+    }
+}
+
+// 分配各台区的跟踪状态，调节时间判据换算为周期数
+static ResponseTrack *Response_Alloc(size_t count, double step_s, uint64_t *hold_cycles) {
+    ResponseTrack *tracks = (ResponseTrack *)calloc(count, sizeof(ResponseTrack));
+    if (!tracks) {
+        fprintf(stderr, "错误: 内存分配失败\n");
+    }
+    *hold_cycles = (uint64_t)ceil(SIMULATION_SETTLE_HOLD_S / step_s - 1e-9);
+    if (*hold_cycles < 1) {
+        *hold_cycles = 1;
+    }
+    return tracks;
+}
+
+// 统计仿真结束时(共cycles个周期)仍未稳定的事件并释放跟踪状态
+static void Response_Finish(SimulationAccumulator *acc, ResponseTrack *tracks, size_t count, uint64_t cycles) {
+    for (size_t i = 0; i < count; i++) {
+        if (tracks[i].direction != 0) {
+            acc->unsettled_episodes++;
+            acc->unsettled_cycles_sum += cycles - tracks[i].start_cycle;
+        }
+    }
+    free(tracks);
+}
+
+// 记录一个台区一个周期的结果
+static inline void Accumulator_Add(SimulationAccumulator *acc, int mode, float V_meas, float SOC, float P_cmd,
+                                   float upper_edge, float lower_edge, float upper_ref, float lower_ref,
+                                   float charge_limit, float charge_max,
+                                   float discharge_limit, float discharge_max) {
+    if (mode >= 0 && mode < 3) {
+        acc->mode_cycles[mode]++;
+    }
+    acc->above_cycles += V_meas > upper_edge;
+    acc->below_cycles += V_meas < lower_edge;
+    acc->outside_ref_cycles += V_meas > upper_ref || V_meas < lower_ref;
+
+    // 指令达到SOC降额限值(且该限值严于PCS额定功率)即视为SOC限值生效
+    if ((mode == 1 && charge_limit < charge_max && P_cmd >= charge_limit)
+        || (mode == 2 && discharge_limit < discharge_max && -P_cmd >= discharge_limit)) {
+        acc->soc_limited_cycles++;
+    }
+
+    if (P_cmd > 0.0f) {
+        acc->P_charge_sum += P_cmd;
+    } else {
+        acc->P_discharge_sum -= P_cmd;
+    }
+
+    if (V_meas < acc->V_min) acc->V_min = V_meas;
+    if (V_meas > acc->V_max) acc->V_max = V_meas;
+    if (SOC < acc->SOC_min) acc->SOC_min = SOC;
+    if (SOC > acc->SOC_max) acc->SOC_max = SOC;
+    float P_abs = fabsf(P_cmd);
+    if (P_abs > acc->P_cmd_abs_max) acc->P_cmd_abs_max = P_abs;
+}
+
+static void Accumulator_Finish(const SimulationAccumulator *acc, size_t areas, uint64_t cycles, double step_s,
+                               double wall_s, SimulationSummary *summary) {
+    summary->areas = areas;
+    summary->cycles = cycles;
+    summary->simulated_s = (double)cycles * step_s;
+    summary->wall_s = wall_s;
+    for (int m = 0; m < 3; m++) {
+        summary->mode_cycles[m] = acc->mode_cycles[m];
+    }
+    summary->time_above_upper_s = (double)acc->above_cycles * step_s;
+    summary->time_below_lower_s = (double)acc->below_cycles * step_s;
+    summary->time_outside_ref_s = (double)acc->outside_ref_cycles * step_s;
+    summary->energy_charge_kwh = acc->P_charge_sum * step_s / 3600.0;
+    summary->energy_discharge_kwh = acc->P_discharge_sum * step_s / 3600.0;
+    summary->soc_limited_cycles = acc->soc_limited_cycles;
+    summary->V_min = cycles ? acc->V_min : 0.0f;
+    summary->V_max = cycles ? acc->V_max : 0.0f;
+    summary->SOC_min = cycles ? acc->SOC_min : 0.0f;
+    summary->SOC_max = cycles ? acc->SOC_max : 0.0f;
+    summary->P_cmd_abs_max = acc->P_cmd_abs_max;
+    summary->episodes = acc->episodes;
+    summary->unsettled_episodes = acc->unsettled_episodes;
+    summary->settling_mean_s = acc->episodes ? (double)acc->settle_cycles_sum * step_s / (double)acc->episodes : 0.0;
+    summary->settling_max_s = (double)acc->settle_cycles_max * step_s;
+    summary->unsettled_elapsed_s = (double)acc->unsettled_cycles_sum * step_s;
+    summary->overshoot_max_V = acc->overshoot_max;
+}
+
+// 检查参数并换算为虚拟时钟步长与终止时刻
+static int Simulation_Prepare(const SimulationOptions *options, size_t count,
+                              VirtualClock *clock, int64_t *end_ns) {
+    if (count == 0 || !(options->step_s > 0.0) || !(options->duration_s >= options->step_s)) {
+        fprintf(stderr, "错误: 仿真参数非法 (台区数=%zu, 时长=%gs, 步长=%gs)\n",
+                count, options->duration_s, options->step_s);
+        return -1;
+    }
+    int64_t step_ns = (int64_t)llround(options->step_s * 1e9);
+    if (step_ns <= 0) {
+        fprintf(stderr, "错误: 仿真步长%gs过小\n", options->step_s);
+        return -1;
+    }
+    if (options->grid && options->grid->count < count) {
+        fprintf(stderr, "错误: 电网模型只有%zu个台区，少于仿真台区数%zu\n", options->grid->count, count);
+        return -1;
+    }
+    VirtualClock_Init(clock, step_ns);
+    *end_ns = (int64_t)llround(options->duration_s * 1e9);
+    return 0;
+}
+
+void VirtualClock_Init(VirtualClock *clock, int64_t step_ns) {
+    clock->now_ns = 0;
+    clock->step_ns = step_ns;
+}
+
+int Simulation_ParseDuration(const char *text, double *seconds) {
+    char *end = NULL;
+    double value = strtod(text, &end);
+    if (end == text || !(value > 0.0)) {
+        fprintf(stderr, "错误: 无法解析时长 %s\n", text);
+        return -1;
+    }
+
+    double scale;
+    if (*end == '\0' || strcmp(end, "s") == 0) {
+        scale = 1.0;
+    } else if (strcmp(end, "ms") == 0) {
+        scale = 1e-3;
+    } else if (strcmp(end, "m") == 0) {
+        scale = 60.0;
+    } else if (strcmp(end, "h") == 0) {
+        scale = 3600.0;
+    } else if (strcmp(end, "d") == 0) {
+        scale = 86400.0;
+    } else if (strcmp(end, "y") == 0) {
+        scale = 365.0 * 86400.0;
+    } else {
+        fprintf(stderr, "错误: 时长单位%s无效，可用ms/s/m/h/d/y\n", end);
+        return -1;
+    }
+    *seconds = value * scale;
+    return 0;
+}
+
+int Simulation_RunControllers(VoltageController *ctrls, size_t count, const SimulationOptions *options,
+                              const volatile sig_atomic_t *stop_flag, SimulationSummary *summary) {
+    VirtualClock clock;
+    int64_t end_ns;
+    GridModel *grid = options->grid;
+    if (Simulation_Prepare(options, count, &clock, &end_ns) != 0) {
+        return -1;
+    }
+    for (size_t i = 0; i < count; i++) {
+        ctrls[i].sim.step_s = (float)options->step_s;
+    }
+    uint64_t hold_cycles;
+    ResponseTrack *tracks = Response_Alloc(count, options->step_s, &hold_cycles);
+    if (!tracks) {
+        return -1;
+    }
+
+    SimulationAccumulator acc;
+    Accumulator_Init(&acc);
+    uint64_t cycles = 0;
+    int64_t wall_start = Monotonic_NowNs();
+
+    while (clock.now_ns < end_ns && !(stop_flag && *stop_flag)) {
+        if (grid) {
+            for (size_t i = 0; i < count; i++) {
+                grid->P_storage[i] = ctrls[i].sim.P_actual;
+            }
+            GridModel_Solve(grid, (double)clock.now_ns / 1e9);
+        }
+        for (size_t i = 0; i < count; i++) {
+            VoltageController *ctrl = &ctrls[i];
+            VoltageController_Step(ctrl);
+            const CompiledConfig *cfg = &ctrl->cfg;
+            Accumulator_Add(&acc, ctrl->state.Ctrl_Mode, ctrl->status.V_meas, ctrl->status.SOC, ctrl->P_cmd,
+                            cfg->V_upper_edge, cfg->V_lower_edge,
+                            cfg->params.V_ref_upper, cfg->params.V_ref_lower, ctrl->status.P_soc_charge_limit,
+                            cfg->P_charge_max, ctrl->status.P_soc_discharge_limit, cfg->P_discharge_max);
+            Response_Add(&acc, &tracks[i], cycles, ctrl->status.V_meas, ctrl->P_cmd,
+                         cfg->V_upper_edge, cfg->V_lower_edge, hold_cycles);
+            if (options->historian) {
+                TelemetryRecord record;
+                TelemetryRecord_FromController(&record, ctrl, (uint32_t)cycles, clock.now_ns);
+                HistorianWriter_Append(options->historian, &record);
+            }
+        }
+        VirtualClock_Advance(&clock);
+        cycles++;
+    }
+
+    double wall_s = (double)(Monotonic_NowNs() - wall_start) / 1e9;
+    Response_Finish(&acc, tracks, count, cycles);
+    Accumulator_Finish(&acc, count, cycles, options->step_s, wall_s, summary);
+    return 0;
+}
+
+int Simulation_RunFleet(VoltageFleet *fleet, SimulationState *sims, const SimulationOptions *options,
+                        const volatile sig_atomic_t *stop_flag, SimulationSummary *summary) {
+    VirtualClock clock;
+    int64_t end_ns;
+    GridModel *grid = options->grid;
+    if (Simulation_Prepare(options, fleet->count, &clock, &end_ns) != 0) {
+        return -1;
+    }
+    for (size_t i = 0; i < fleet->count; i++) {
+        sims[i].step_s = (float)options->step_s;
+    }
+
+    uint64_t hold_cycles;
+    ResponseTrack *tracks = Response_Alloc(fleet->count, options->step_s, &hold_cycles);
+    if (!tracks) {
+        return -1;
+    }
+
+    // 启用电池模型时整批积分SOC，结果覆盖模拟数据源给出的SOC与功率
+    BatteryBank bank = {};
+    int battery = sims[0].battery_enabled;
+    if (battery) {
+        if (BatteryBank_Init(&bank, fleet->count) != 0) {
+            free(tracks);
+            return -1;
+        }
+        for (size_t i = 0; i < fleet->count; i++) {
+            BatteryBank_Set(&bank, i, &sims[i].battery, sims[i].battery_soc, sims[i].P_actual);
+        }
+    }
+
+    SimulationAccumulator acc;
+    Accumulator_Init(&acc);
+    SystemStatus_RealTime status = {};
+    uint64_t cycles = 0;
+    int64_t wall_start = Monotonic_NowNs();
+
+    while (clock.now_ns < end_ns && !(stop_flag && *stop_flag)) {
+        if (grid) {
+            for (size_t i = 0; i < fleet->count; i++) {
+                grid->P_storage[i] = battery ? bank.P_actual[i] : sims[i].P_actual;
+            }
+            GridModel_Solve(grid, (double)clock.now_ns / 1e9);
+        }
+        for (size_t i = 0; i < fleet->count; i++) {
+            Simulate_RealTimeData(&sims[i], &status);
+            VoltageFleet_SetMeasurement(fleet, i, &status);
+        }
+        if (battery) {
+            for (size_t i = 0; i < fleet->count; i++) {
+                fleet->SOC[i] = (float)bank.soc[i];
+            }
+            memcpy(fleet->P_meas, bank.P_actual, fleet->count * sizeof(float));
+        }
+        VoltageFleet_Step(fleet);
+        if (battery) {
+            BatteryBank_Step(&bank, fleet->P_cmd, (float)options->step_s);
+        } else if (grid) {
+            for (size_t i = 0; i < fleet->count; i++) {
+                Simulation_ApplyCommand(&sims[i], fleet->P_cmd[i]);
+            }
+        }
+        for (size_t i = 0; i < fleet->count; i++) {
+            Accumulator_Add(&acc, fleet->Ctrl_Mode[i], fleet->V_meas[i], fleet->SOC[i], fleet->P_cmd[i],
+                            fleet->V_upper_edge[i], fleet->V_lower_edge[i], fleet->V_ref_upper[i], fleet->V_ref_lower[i],
+                            fleet->P_soc_charge_limit[i], fleet->P_charge_max[i],
+                            fleet->P_soc_discharge_limit[i], fleet->P_discharge_max[i]);
+            Response_Add(&acc, &tracks[i], cycles, fleet->V_meas[i], fleet->P_cmd[i],
+                         fleet->V_upper_edge[i], fleet->V_lower_edge[i], hold_cycles);
+            if (options->historian) {
+                TelemetryRecord record;
+                TelemetryRecord_FromFleet(&record, fleet, i, (uint32_t)cycles, clock.now_ns);
+                HistorianWriter_Append(options->historian, &record);
+            }
+        }
+        VirtualClock_Advance(&clock);
+        cycles++;
+    }
+
+    double wall_s = (double)(Monotonic_NowNs() - wall_start) / 1e9;
+    if (battery) {
+        for (size_t i = 0; i < fleet->count; i++) {
+            sims[i].battery_soc = bank.soc[i];
+            sims[i].simulated_soc = (float)bank.soc[i];
+            sims[i].P_actual = bank.P_actual[i];
+        }
+        BatteryBank_Free(&bank);
+    }
+    Response_Finish(&acc, tracks, fleet->count, cycles);
+    Accumulator_Finish(&acc, fleet->count, cycles, options->step_s, wall_s, summary);
+    return 0;
+}
+
+double SimulationSummary_SettlingScore(const SimulationSummary *summary) {
+    uint64_t total = summary->episodes + summary->unsettled_episodes;
+    if (total == 0) {
+        return 0.0;
+    }
+    return (summary->settling_mean_s * (double)summary->episodes + summary->unsettled_elapsed_s) / (double)total;
+}
+
+void SimulationSummary_Print(const SimulationSummary *summary, FILE *fp) {
+    double area_cycles = (double)summary->cycles * (double)summary->areas;
+    double area_time = summary->simulated_s * (double)summary->areas;
+    if (area_cycles <= 0.0) {
+        fprintf(fp, "仿真汇总: 未完成任何周期\n");
+        return;
+    }
+
+    fprintf(fp, "仿真汇总: 台区数=%zu, 周期数=%llu, 仿真时长=%.1fh, 实际耗时=%.3fs, 加速比=%.0fx\n",
+            summary->areas, (unsigned long long)summary->cycles, summary->simulated_s / 3600.0,
+            summary->wall_s, summary->wall_s > 0.0 ? summary->simulated_s / summary->wall_s : 0.0);
+    fprintf(fp, "  控制模式占比: 正常=%.2f%%, 过压=%.2f%%, 欠压=%.2f%%\n",
+            100.0 * (double)summary->mode_cycles[0] / area_cycles,
+            100.0 * (double)summary->mode_cycles[1] / area_cycles,
+            100.0 * (double)summary->mode_cycles[2] / area_cycles);
+    fprintf(fp, "  电压越限时长: 高于上限死区=%.1fh(%.2f%%), 低于下限死区=%.1fh(%.2f%%), 超出设定值=%.1fh(%.2f%%), "
+                "电压范围=%.2f~%.2fV\n",
+            summary->time_above_upper_s / 3600.0, 100.0 * summary->time_above_upper_s / area_time,
+            summary->time_below_lower_s / 3600.0, 100.0 * summary->time_below_lower_s / area_time,
+            summary->time_outside_ref_s / 3600.0, 100.0 * summary->time_outside_ref_s / area_time,
+            summary->V_min, summary->V_max);
+    fprintf(fp, "  能量: 充电=%.2fkWh, 放电=%.2fkWh, 最大功率指令=%.2fkW\n",
+            summary->energy_charge_kwh, summary->energy_discharge_kwh, summary->P_cmd_abs_max);
+    fprintf(fp, "  SOC: 范围=%.1f%%~%.1f%%, SOC限值生效周期=%llu\n",
+            summary->SOC_min * 100.0f, summary->SOC_max * 100.0f,
+            (unsigned long long)summary->soc_limited_cycles);
+    fprintf(fp, "  动态响应: 已稳定越限事件=%llu, 未稳定=%llu, 平均调节时间=%.1fs(未稳定事件计到仿真结束), "
+                "已稳定事件最长调节时间=%.1fs, 最大超调=%.2fV\n",
+            (unsigned long long)summary->episodes, (unsigned long long)summary->unsettled_episodes,
+            SimulationSummary_SettlingScore(summary), summary->settling_max_s, summary->overshoot_max_V);
+}
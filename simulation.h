@@ -0,0 +1,136 @@
+/*
+ * 文件：simulation.h
+ * 功能：基于虚拟时钟的超实时仿真
+ *
+ * 功能描述：
+ * 1. 仿真时间由虚拟时钟按固定步长推进，不等待真实时间，
+ *    一年的1s步长仿真(约3150万个周期)以CPU允许的最快速度运行
+ * 2. 支持逐台区控制器与结构数组批量引擎两种计算方式
+ * 3. 仿真结束后输出汇总：电压越限时长、充放电能量、SOC限值生效次数、
+ *    各控制模式占比、越限事件的调节时间与超调以及仿真速度
+ * 4. 可选地把每个台区每个周期的运行数据写入列式历史库
+ * 5. 可选地接入电网模型：每周期按各储能上一周期的功率求解台区电压，构成闭环
+ */
+
+#ifndef VOLTAGE_CONTROL_SIMULATION_H
+#define VOLTAGE_CONTROL_SIMULATION_H
+
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include "voltage_control.h"
+#include "fleet.h"
+
+#define SIMULATION_SETTLE_HOLD_S 30.0     // 越限事件的稳定判据：电压回到死区内并连续保持的时长 (s)
+
+/* ---------- 虚拟时钟 ---------- */
+typedef struct {
+    int64_t now_ns;             // 当前仿真时刻 (ns)，从0开始
+    int64_t step_ns;            // 每个控制周期推进的时长 (ns)
+} VirtualClock;
+
+struct HistorianWriter;
+struct GridModel;
+
+/* ---------- 仿真参数 ---------- */
+typedef struct {
+    double duration_s;          // 仿真总时长 (s)
+    double step_s;              // 仿真步长，即控制周期 (s)
+    HistorianWriter *historian; // 逐台区逐周期写入的历史库(时间戳为虚拟时钟)，NULL表示不记录
+    GridModel *grid;            // 电网模型，各台区数据源须已挂接；每周期按上一周期储能功率求解电压，NULL表示开环
+} SimulationOptions;
+
+/* ---------- 仿真汇总(全部台区累计) ---------- */
+typedef struct {
+    size_t areas;                       // 台区数量
+    uint64_t cycles;                    // 已仿真的控制周期数
+    double simulated_s;                 // 已仿真的时长 (s)
+    double wall_s;                      // 实际耗时 (s)
+    uint64_t mode_cycles[3];            // 各控制模式的台区周期数: 正常/过压/欠压
+    double time_above_upper_s;          // 电压高于上限死区的台区时长 (s)
+    double time_below_lower_s;          // 电压低于下限死区的台区时长 (s)
+    double time_outside_ref_s;          // 电压高于V_ref_upper或低于V_ref_lower(不计死区)的台区时长 (s)
+    double energy_charge_kwh;           // 充电能量 (按P_cmd积分, kWh)
+    double energy_discharge_kwh;        // 放电能量 (按P_cmd积分, kWh)
+    uint64_t soc_limited_cycles;        // 功率指令被SOC降额限值截断的台区周期数
+    float V_min;                        // 电压最小值
+    float V_max;                        // 电压最大值
+    float SOC_min;                      // SOC最小值
+    float SOC_max;                      // SOC最大值
+    float P_cmd_abs_max;                // 功率指令绝对值最大值
+    uint64_t episodes;                  // 已稳定的越限事件数(电压越出死区到回到死区内并保持SIMULATION_SETTLE_HOLD_S)
+    uint64_t unsettled_episodes;        // 仿真结束时仍未稳定的越限事件数
+    double settling_mean_s;             // 已稳定事件的平均调节时间 (s)
+    double settling_max_s;              // 已稳定事件的最长调节时间 (s)
+    double unsettled_elapsed_s;         // 未稳定事件从开始到仿真结束的时长累计 (s)
+    float overshoot_max_V;              // 最大超调：储能仍在出力时电压越过死区边沿进入死区的最大深度 (V)
+} SimulationSummary;
+
+/**
+ * @brief 初始化虚拟时钟
+ * @param clock 虚拟时钟
+ * @param step_ns 步长 (ns)
+ */
+void VirtualClock_Init(VirtualClock *clock, int64_t step_ns);
+
+/**
+ * @brief 虚拟时钟前进一个步长
+ * @param clock 虚拟时钟
+ * @return int64_t 前进后的仿真时刻 (ns)
+ */
+inline int64_t VirtualClock_Advance(VirtualClock *clock) {
+    clock->now_ns += clock->step_ns;
+    return clock->now_ns;
+}
+
+/**
+ * @brief 解析时长字符串，支持后缀ms/s/m/h/d/y，无后缀按秒计，如"0.5"、"15m"、"365d"、"1y"
+ * @param text 时长字符串
+ * @param seconds [输出] 时长 (s)
+ * @return int 成功返回0，格式错误或非正数返回-1
+ */
+int Simulation_ParseDuration(const char *text, double *seconds);
+
+/**
+ * @brief 用逐台区控制器运行超实时仿真
+ * @param ctrls 已初始化的控制器上下文数组
+ * @param count 台区数量
+ * @param options 仿真参数
+ * @param stop_flag 外部停止标志(如SIGINT)，置位后提前结束，可为NULL
+ * @param summary [输出] 仿真汇总
+ * @return int 成功返回0，参数错误返回-1
+ */
+int Simulation_RunControllers(VoltageController *ctrls, size_t count, const SimulationOptions *options,
+                              const volatile sig_atomic_t *stop_flag, SimulationSummary *summary);
+
+/**
+ * @brief 用结构数组批量引擎运行超实时仿真
+ * @param fleet 已完成配置的批量引擎
+ * @param sims 各台区模拟数据源状态(已初始化)；sims[0]启用了电池模型时全部台区按结构数组批量积分SOC，
+ *             各台区须都已启用电池模型
+ * @param options 仿真参数
+ * @param stop_flag 外部停止标志，可为NULL
+ * @param summary [输出] 仿真汇总
+ * @return int 成功返回0，参数错误返回-1
+ */
+int Simulation_RunFleet(VoltageFleet *fleet, SimulationState *sims, const SimulationOptions *options,
+                        const volatile sig_atomic_t *stop_flag, SimulationSummary *summary);
+
+/**
+ * @brief 计入未稳定事件的平均调节时间，增益扫描排序与整定代价共用
+ *
+ * 未稳定事件按从开始到仿真结束的时长计，始终不稳定的参数不会因为没有已稳定事件而得到0。
+ * @param summary 仿真汇总
+ * @return double 平均调节时间 (s)，没有任何越限事件时为0
+ */
+double SimulationSummary_SettlingScore(const SimulationSummary *summary);
+
+/**
+ * @brief 输出仿真汇总
+ * @param summary 仿真汇总
+ * @param fp 输出流
+ */
+void SimulationSummary_Print(const SimulationSummary *summary, FILE *fp);
+
+#endif // VOLTAGE_CONTROL_SIMULATION_H
@@ -0,0 +1,390 @@
+/*
+ * 文件：soc_limits.cpp
+ * 功能：基于SOC的充放电降额系数计算实现 —— SIMD批量内核与预编译插值表
+ *
+ * 说明：
+ * 过渡区内 x ∈ [0,1]，令 t = x - 0.5 ∈ [-0.5,0.5]，则
+ *   充电系数 0.5*(1 + cos(πx)) = 0.5 - 0.5*sin(πt)
+ *   放电系数 0.5*(1 - cos(πx)) = 0.5 + 0.5*sin(πt)
+ * sin(πt)在|πt| ≤ π/2上用11阶奇次泰勒多项式近似，截断误差 < 6e-8，
+ * 加上单精度舍入后总误差远小于SOC_DERATING_MAX_ERROR。
+ * x由SOC到限值的距离直接算出(相近两数相减无舍入)，不经过单精度拐点 SOC_max - 宽度：
+ * 拐点的舍入误差除以过渡宽度后被放大，宽度0.01时误差可达1.5e-6。
+ */
+
+#include "soc_limits.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SOC_LIMITS_USE_SSE2 1
+#endif
+
+// sin(πt)的多项式系数：π^k / k! (奇次项，符号交替)
+#define SINPI_C1   3.14159265358979f
+#define SINPI_C3  -5.16771278004997f
+#define SINPI_C5   2.55016403987735f
+#define SINPI_C7  -0.599264529320792f
+#define SINPI_C9   0.0821458866111282f
+#define SINPI_C11 -0.00737043094571435f
+
+// 标量多项式：sin(πt)，t ∈ [-0.5,0.5]
+static inline float SinPi_Poly(float t) {
+    float t2 = t * t;
+    float p = SINPI_C11;
+    p = p * t2 + SINPI_C9;
+    p = p * t2 + SINPI_C7;
+    p = p * t2 + SINPI_C5;
+    p = p * t2 + SINPI_C3;
+    p = p * t2 + SINPI_C1;
+    return p * t;
+}
+
+static inline float Clamp_Half(float t) {
+    t = t < -0.5f ? -0.5f : t;
+    return t > 0.5f ? 0.5f : t;
+}
+
+// 标量路径：用于不支持SIMD的平台以及向量化后剩余的尾部元素
+static void SOC_DeratingFactors_Scalar(size_t begin, size_t n,
+                                       const float *soc, const float *soc_max, const float *soc_min,
+                                       const float *charge_knee, const float *discharge_knee,
+                                       float charge_width, float discharge_width,
+                                       float *charge_factor, float *discharge_factor) {
+    const float inv_charge_width = 1.0f / charge_width;
+    const float inv_discharge_width = 1.0f / discharge_width;
+
+    for (size_t i = begin; i < n; i++) {
+        float s = soc[i];
+
+        float tc = Clamp_Half(0.5f - (soc_max[i] - s) * inv_charge_width);
+        float fc = 0.5f - 0.5f * SinPi_Poly(tc);
+        fc = s <= charge_knee[i] ? 1.0f : fc;
+        charge_factor[i] = s >= soc_max[i] ? 0.0f : fc;
+
+        float td = Clamp_Half((s - soc_min[i]) * inv_discharge_width - 0.5f);
+        float fd = 0.5f + 0.5f * SinPi_Poly(td);
+        fd = s >= discharge_knee[i] ? 1.0f : fd;
+        discharge_factor[i] = s <= soc_min[i] ? 0.0f : fd;
+    }
+}
+
+#if defined(__AVX2__)
+
+static inline __m256 SinPi_Poly8(__m256 t) {
+    __m256 t2 = _mm256_mul_ps(t, t);
+    __m256 p = _mm256_set1_ps(SINPI_C11);
+    p = _mm256_add_ps(_mm256_mul_ps(p, t2), _mm256_set1_ps(SINPI_C9));
+    p = _mm256_add_ps(_mm256_mul_ps(p, t2), _mm256_set1_ps(SINPI_C7));
+    p = _mm256_add_ps(_mm256_mul_ps(p, t2), _mm256_set1_ps(SINPI_C5));
+    p = _mm256_add_ps(_mm256_mul_ps(p, t2), _mm256_set1_ps(SINPI_C3));
+    p = _mm256_add_ps(_mm256_mul_ps(p, t2), _mm256_set1_ps(SINPI_C1));
+    return _mm256_mul_ps(p, t);
+}
+
+static size_t SOC_DeratingFactors_Simd(size_t n,
+                                       const float *soc, const float *soc_max, const float *soc_min,
+                                       const float *charge_knee, const float *discharge_knee,
+                                       float charge_width, float discharge_width,
+                                       float *charge_factor, float *discharge_factor) {
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 neg_half = _mm256_set1_ps(-0.5f);
+    const __m256 inv_w_c = _mm256_set1_ps(1.0f / charge_width);
+    const __m256 inv_w_d = _mm256_set1_ps(1.0f / discharge_width);
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m256 s = _mm256_loadu_ps(soc + i);
+        __m256 s_max = _mm256_loadu_ps(soc_max + i);
+        __m256 s_min = _mm256_loadu_ps(soc_min + i);
+
+        // 充电系数
+        __m256 knee_c = _mm256_loadu_ps(charge_knee + i);
+        __m256 tc = _mm256_sub_ps(half, _mm256_mul_ps(_mm256_sub_ps(s_max, s), inv_w_c));
+        tc = _mm256_min_ps(_mm256_max_ps(tc, neg_half), half);
+        __m256 fc = _mm256_sub_ps(half, _mm256_mul_ps(half, SinPi_Poly8(tc)));
+        fc = _mm256_blendv_ps(fc, one, _mm256_cmp_ps(s, knee_c, _CMP_LE_OQ));
+        fc = _mm256_blendv_ps(fc, zero, _mm256_cmp_ps(s, s_max, _CMP_GE_OQ));
+        _mm256_storeu_ps(charge_factor + i, fc);
+
+        // 放电系数
+        __m256 knee_d = _mm256_loadu_ps(discharge_knee + i);
+        __m256 td = _mm256_sub_ps(_mm256_mul_ps(_mm256_sub_ps(s, s_min), inv_w_d), half);
+        td = _mm256_min_ps(_mm256_max_ps(td, neg_half), half);
+        __m256 fd = _mm256_add_ps(half, _mm256_mul_ps(half, SinPi_Poly8(td)));
+        fd = _mm256_blendv_ps(fd, one, _mm256_cmp_ps(s, knee_d, _CMP_GE_OQ));
+        fd = _mm256_blendv_ps(fd, zero, _mm256_cmp_ps(s, s_min, _CMP_LE_OQ));
+        _mm256_storeu_ps(discharge_factor + i, fd);
+    }
+    return i;
+}
+
+#elif defined(SOC_LIMITS_USE_SSE2)
+
+static inline __m128 SinPi_Poly4(__m128 t) {
+    __m128 t2 = _mm_mul_ps(t, t);
+    __m128 p = _mm_set1_ps(SINPI_C11);
+    p = _mm_add_ps(_mm_mul_ps(p, t2), _mm_set1_ps(SINPI_C9));
+    p = _mm_add_ps(_mm_mul_ps(p, t2), _mm_set1_ps(SINPI_C7));
+    p = _mm_add_ps(_mm_mul_ps(p, t2), _mm_set1_ps(SINPI_C5));
+    p = _mm_add_ps(_mm_mul_ps(p, t2), _mm_set1_ps(SINPI_C3));
+    p = _mm_add_ps(_mm_mul_ps(p, t2), _mm_set1_ps(SINPI_C1));
+    return _mm_mul_ps(p, t);
+}
+
+// SSE2没有blendv，用与/与非/或组合实现按掩码选择
+static inline __m128 Select4(__m128 mask, __m128 if_true, __m128 if_false) {
+    return _mm_or_ps(_mm_and_ps(mask, if_true), _mm_andnot_ps(mask, if_false));
+}
+
+static size_t SOC_DeratingFactors_Simd(size_t n,
+                                       const float *soc, const float *soc_max, const float *soc_min,
+                                       const float *charge_knee, const float *discharge_knee,
+                                       float charge_width, float discharge_width,
+                                       float *charge_factor, float *discharge_factor) {
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 neg_half = _mm_set1_ps(-0.5f);
+    const __m128 inv_w_c = _mm_set1_ps(1.0f / charge_width);
+    const __m128 inv_w_d = _mm_set1_ps(1.0f / discharge_width);
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        __m128 s = _mm_loadu_ps(soc + i);
+        __m128 s_max = _mm_loadu_ps(soc_max + i);
+        __m128 s_min = _mm_loadu_ps(soc_min + i);
+
+        // 充电系数
+        __m128 knee_c = _mm_loadu_ps(charge_knee + i);
+        __m128 tc = _mm_sub_ps(half, _mm_mul_ps(_mm_sub_ps(s_max, s), inv_w_c));
+        tc = _mm_min_ps(_mm_max_ps(tc, neg_half), half);
+        __m128 fc = _mm_sub_ps(half, _mm_mul_ps(half, SinPi_Poly4(tc)));
+        fc = Select4(_mm_cmple_ps(s, knee_c), one, fc);
+        fc = Select4(_mm_cmpge_ps(s, s_max), zero, fc);
+        _mm_storeu_ps(charge_factor + i, fc);
+
+        // 放电系数
+        __m128 knee_d = _mm_loadu_ps(discharge_knee + i);
+        __m128 td = _mm_sub_ps(_mm_mul_ps(_mm_sub_ps(s, s_min), inv_w_d), half);
+        td = _mm_min_ps(_mm_max_ps(td, neg_half), half);
+        __m128 fd = _mm_add_ps(half, _mm_mul_ps(half, SinPi_Poly4(td)));
+        fd = Select4(_mm_cmpge_ps(s, knee_d), one, fd);
+        fd = Select4(_mm_cmple_ps(s, s_min), zero, fd);
+        _mm_storeu_ps(discharge_factor + i, fd);
+    }
+    return i;
+}
+
+#endif
+
+void SOC_DeratingFactors_Batch(size_t n,
+                               const float *soc,
+                               const float *soc_max,
+                               const float *soc_min,
+                               const float *charge_knee,
+                               const float *discharge_knee,
+                               float charge_width,
+                               float discharge_width,
+                               float *charge_factor,
+                               float *discharge_factor) {
+    size_t done = 0;
+#if defined(__AVX2__) || defined(SOC_LIMITS_USE_SSE2)
+    done = SOC_DeratingFactors_Simd(n, soc, soc_max, soc_min, charge_knee, discharge_knee,
+                                    charge_width, discharge_width, charge_factor, discharge_factor);
+#endif
+    SOC_DeratingFactors_Scalar(done, n, soc, soc_max, soc_min, charge_knee, discharge_knee,
+                               charge_width, discharge_width, charge_factor, discharge_factor);
+}
+
+int SOC_DeratingCurve_Build(SOC_DeratingCurve *curve, int shape,
+                            float charge_width, float discharge_width,
+                            const float *bp_x, const float *bp_y, int bp_count) {
+    if (!(charge_width > 0.0f && charge_width < 1.0f) || !(discharge_width > 0.0f && discharge_width < 1.0f)) {
+        fprintf(stderr, "错误: SOC过渡区间宽度必须在(0,1)之间\n");
+        return -1;
+    }
+
+    // 自定义折线：横坐标从0严格递增到1，纵坐标在[0,1]之间且r(0)=0、r(1)=1，与平台区连续
+    if (shape == SOC_CURVE_BREAKPOINTS) {
+        if (!bp_x || !bp_y || bp_count < 2 || bp_count > SOC_CURVE_MAX_BREAKPOINTS) {
+            fprintf(stderr, "错误: 降额曲线折点数必须在2~%d之间\n", SOC_CURVE_MAX_BREAKPOINTS);
+            return -1;
+        }
+        if (bp_x[0] != 0.0f || bp_x[bp_count - 1] != 1.0f) {
+            fprintf(stderr, "错误: 降额曲线折点横坐标必须从0开始、到1结束\n");
+            return -1;
+        }
+        if (bp_y[0] != 0.0f || bp_y[bp_count - 1] != 1.0f) {
+            fprintf(stderr, "错误: 降额曲线首个折点的系数必须为0、最后一个折点的系数必须为1(当前%g、%g)\n",
+                    bp_y[0], bp_y[bp_count - 1]);
+            return -1;
+        }
+        for (int i = 0; i < bp_count; i++) {
+            if (i > 0 && !(bp_x[i] > bp_x[i - 1])) {
+                fprintf(stderr, "错误: 降额曲线第%d个折点横坐标未严格递增\n", i + 1);
+                return -1;
+            }
+            if (!(bp_y[i] >= 0.0f && bp_y[i] <= 1.0f)) {
+                fprintf(stderr, "错误: 降额曲线第%d个折点纵坐标超出[0,1]\n", i + 1);
+                return -1;
+            }
+        }
+    } else if (shape != SOC_CURVE_COSINE && shape != SOC_CURVE_LINEAR) {
+        fprintf(stderr, "错误: 未知的降额曲线形状%d\n", shape);
+        return -1;
+    }
+
+    curve->shape = shape;
+    curve->charge_width = charge_width;
+    curve->discharge_width = discharge_width;
+    curve->charge_scale = SOC_CURVE_TABLE_SEGMENTS / charge_width;
+    curve->discharge_scale = SOC_CURVE_TABLE_SEGMENTS / discharge_width;
+
+    // 在 d = k / SOC_CURVE_TABLE_SEGMENTS 处对曲线采样
+    int seg = 0;
+    for (int k = 0; k <= SOC_CURVE_TABLE_SEGMENTS; k++) {
+        double d = (double)k / SOC_CURVE_TABLE_SEGMENTS;
+        double r;
+        if (shape == SOC_CURVE_COSINE) {
+            r = 0.5 * (1.0 - cos(M_PI * d));
+        } else if (shape == SOC_CURVE_LINEAR) {
+            r = d;
+        } else {
+            while (seg < bp_count - 2 && d > bp_x[seg + 1]) {
+                seg++;
+            }
+            double t = (d - bp_x[seg]) / (bp_x[seg + 1] - bp_x[seg]);
+            r = bp_y[seg] + t * (bp_y[seg + 1] - bp_y[seg]);
+        }
+        curve->table[k] = (float)r;
+    }
+    return 0;
+}
+
+void SOC_DeratingCurve_Default(SOC_DeratingCurve *curve) {
+    SOC_DeratingCurve_Build(curve, SOC_CURVE_COSINE, SOC_CURVE_DEFAULT_WIDTH, SOC_CURVE_DEFAULT_WIDTH,
+                            NULL, NULL, 0);
+}
+
+int SOC_DeratingCurve_ParseShape(const char *name) {
+    if (strcmp(name, "cosine") == 0) {
+        return SOC_CURVE_COSINE;
+    } else if (strcmp(name, "linear") == 0) {
+        return SOC_CURVE_LINEAR;
+    } else if (strcmp(name, "breakpoints") == 0) {
+        return SOC_CURVE_BREAKPOINTS;
+    }
+    return -1;
+}
+
+// 查表 + 线性插值，u为表内坐标 [0, SOC_CURVE_TABLE_SEGMENTS]
+static inline float Curve_Lookup(const float *table, float u) {
+    u = u < 0.0f ? 0.0f : u;
+    u = u > (float)SOC_CURVE_TABLE_SEGMENTS ? (float)SOC_CURVE_TABLE_SEGMENTS : u;
+    int k = (int)u;
+    k = k >= SOC_CURVE_TABLE_SEGMENTS ? SOC_CURVE_TABLE_SEGMENTS - 1 : k;
+    float frac = u - (float)k;
+    return table[k] + frac * (table[k + 1] - table[k]);
+}
+
+void SOC_DeratingCurve_Eval(const SOC_DeratingCurve *curve, float soc, float soc_max, float soc_min,
+                            float *charge_factor, float *discharge_factor) {
+    SOC_DeratingCurve_EvalKnees(curve, soc, soc_max, soc_min, soc_max - curve->charge_width,
+                                soc_min + curve->discharge_width, charge_factor, discharge_factor);
+}
+
+void SOC_DeratingCurve_EvalKnees(const SOC_DeratingCurve *curve, float soc, float soc_max, float soc_min,
+                                 float charge_knee, float discharge_knee,
+                                 float *charge_factor, float *discharge_factor) {
+    // 平台区判断与原分段实现保持一致，只有过渡区内查表
+    float fc = Curve_Lookup(curve->table, (soc_max - soc) * curve->charge_scale);
+    fc = soc <= charge_knee ? 1.0f : fc;
+    *charge_factor = soc >= soc_max ? 0.0f : fc;
+
+    float fd = Curve_Lookup(curve->table, (soc - soc_min) * curve->discharge_scale);
+    fd = soc >= discharge_knee ? 1.0f : fd;
+    *discharge_factor = soc <= soc_min ? 0.0f : fd;
+}
+
+void SOC_DeratingCurve_EvalBatch(const SOC_DeratingCurve *curve, size_t n,
+                                 const float *soc, const float *soc_max, const float *soc_min,
+                                 const float *charge_knee, const float *discharge_knee,
+                                 float *charge_factor, float *discharge_factor) {
+    // 余弦形状有解析的SIMD多项式实现，比逐个查表(需要gather)更快也更精确
+    if (curve->shape == SOC_CURVE_COSINE) {
+        SOC_DeratingFactors_Batch(n, soc, soc_max, soc_min, charge_knee, discharge_knee,
+                                  curve->charge_width, curve->discharge_width, charge_factor, discharge_factor);
+        return;
+    }
+    for (size_t i = 0; i < n; i++) {
+        SOC_DeratingCurve_EvalKnees(curve, soc[i], soc_max[i], soc_min[i], charge_knee[i], discharge_knee[i],
+                                    &charge_factor[i], &discharge_factor[i]);
+    }
+}
+
+const char *SOC_DeratingFactors_Isa(void) {
+#if defined(__AVX2__)
+    return "avx2";
+#elif defined(SOC_LIMITS_USE_SSE2)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+// 双精度余弦参考曲线 r(d)，d超出[0,1]的部分为平台区
+static double Reference_Cosine(double d) {
+    if (d <= 0.0) {
+        return 0.0;
+    }
+    return d >= 1.0 ? 1.0 : 0.5 * (1.0 - cos(M_PI * d));
+}
+
+int SOC_Derating_SelfCheck(float soc_max, float soc_min, float charge_width, float discharge_width,
+                           double *simd_error, double *table_error) {
+    SOC_DeratingCurve table_curve;
+    if (SOC_DeratingCurve_Build(&table_curve, SOC_CURVE_COSINE, charge_width, discharge_width, NULL, NULL, 0) != 0) {
+        return -1;
+    }
+
+    // 从低于下限到高于上限密集采样，两个过渡区内各有数万个点
+    enum { BATCH = 1024, SAMPLES = 1 << 20 };
+    float soc[BATCH], max_arr[BATCH], min_arr[BATCH], knee_c[BATCH], knee_d[BATCH], fc[BATCH], fd[BATCH];
+    for (int i = 0; i < BATCH; i++) {
+        max_arr[i] = soc_max;
+        min_arr[i] = soc_min;
+        knee_c[i] = soc_max - charge_width;
+        knee_d[i] = soc_min + discharge_width;
+    }
+    const double lo = (double)soc_min - 0.01;
+    const double step = ((double)soc_max + 0.01 - lo) / SAMPLES;
+    double simd_max = 0.0;
+    double table_max = 0.0;
+    for (int begin = 0; begin < SAMPLES; begin += BATCH) {
+        for (int i = 0; i < BATCH; i++) {
+            soc[i] = (float)(lo + step * (begin + i));
+        }
+        SOC_DeratingFactors_Batch(BATCH, soc, max_arr, min_arr, knee_c, knee_d, charge_width, discharge_width, fc, fd);
+        for (int i = 0; i < BATCH; i++) {
+            double rc = Reference_Cosine(((double)soc_max - soc[i]) / charge_width);
+            double rd = Reference_Cosine(((double)soc[i] - soc_min) / discharge_width);
+            simd_max = fmax(simd_max, fmax(fabs(fc[i] - rc), fabs(fd[i] - rd)));
+
+            float tc, td;
+            SOC_DeratingCurve_Eval(&table_curve, soc[i], soc_max, soc_min, &tc, &td);
+            table_max = fmax(table_max, fmax(fabs(tc - rc), fabs(td - rd)));
+        }
+    }
+
+    *simd_error = simd_max;
+    *table_error = table_max;
+    return simd_max <= SOC_DERATING_MAX_ERROR && table_max <= SOC_CURVE_TABLE_MAX_ERROR ? 0 : -1;
+}
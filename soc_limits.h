@@ -0,0 +1,169 @@
+/*
+ * 文件：soc_limits.h
+ * 功能：基于SOC的充放电降额系数计算 —— SIMD批量内核与预编译插值表
+ *
+ * 功能描述：
+ * 1. 对一组SOC值同时计算充电/放电降额系数，曲线与Calculate_SOC_Power_Limits相同
+ * 2. 过渡区内的余弦用单精度多项式近似，平台区(系数恰为0或1)保持精确
+ * 3. 编译期选择实现：AVX2(8路) > SSE2(4路) > 标量，尾部元素统一走标量路径
+ * 4. 降额曲线在加载配置时预先编译成定长插值表，支持余弦、线性与自定义折线三种形状，
+ *    单次计算只需一次查表加一次线性插值
+ *
+ * 精度：
+ * 与双精度cos相比，SIMD内核降额系数的最大绝对误差不超过SOC_DERATING_MAX_ERROR，
+ * 以125kW额定功率计，功率限值误差不超过0.07W；余弦插值表的误差不超过SOC_CURVE_TABLE_MAX_ERROR。
+ * 两者均由SOC_Derating_SelfCheck核对，基准测试启动时执行。
+ */
+
+#ifndef VOLTAGE_CONTROL_SOC_LIMITS_H
+#define VOLTAGE_CONTROL_SOC_LIMITS_H
+
+#include <cstddef>
+
+#define SOC_DERATING_MAX_ERROR 5e-7f    // 降额系数相对标量参考实现的最大绝对误差
+
+#define SOC_CURVE_TABLE_SEGMENTS 256    // 插值表分段数
+#define SOC_CURVE_TABLE_MAX_ERROR 1e-5f // 余弦插值表相对双精度余弦的最大绝对误差
+#define SOC_CURVE_MAX_BREAKPOINTS 16    // 自定义折线最多支持的折点数
+#define SOC_CURVE_DEFAULT_WIDTH 0.05f   // 默认过渡区间宽度
+
+/* ---------- 降额曲线形状 ---------- */
+typedef enum {
+    SOC_CURVE_COSINE = 0,       // 余弦S形过渡(默认)
+    SOC_CURVE_LINEAR = 1,       // 线性过渡
+    SOC_CURVE_BREAKPOINTS = 2   // 用户自定义折线
+} SOC_CurveShape;
+
+/* ---------- 预编译的SOC降额曲线 ---------- */
+// 插值表描述归一化曲线 r(d)，d为SOC距离限值的距离与过渡宽度之比：
+//   充电系数 = r((SOC_max - SOC) / 充电过渡宽度)
+//   放电系数 = r((SOC - SOC_min) / 放电过渡宽度)
+// r(0) = 0，r(1) = 1，d超出[0,1]的部分为平台区
+typedef struct {
+    int shape;                      // 曲线形状 SOC_CurveShape
+    float charge_width;             // 充电过渡区间宽度
+    float discharge_width;          // 放电过渡区间宽度
+    float charge_scale;             // SOC_CURVE_TABLE_SEGMENTS / charge_width
+    float discharge_scale;          // SOC_CURVE_TABLE_SEGMENTS / discharge_width
+    float table[SOC_CURVE_TABLE_SEGMENTS + 1];  // r(d)在d = k / SOC_CURVE_TABLE_SEGMENTS处的取值
+} SOC_DeratingCurve;
+
+/**
+ * @brief 批量计算基于SOC的充放电降额系数
+ *
+ * 充电系数在[SOC_max - charge_width, SOC_max]内由1平滑降到0，
+ * 放电系数在[SOC_min, SOC_min + discharge_width]内由0平滑升到1。
+ * @param n 元素个数
+ * @param soc 当前SOC数组
+ * @param soc_max SOC安全上限数组
+ * @param soc_min SOC安全下限数组
+ * @param charge_knee 充电平台区拐点数组，soc_max - charge_width(见CompiledConfig)
+ * @param discharge_knee 放电平台区拐点数组，soc_min + discharge_width
+ * @param charge_width 充电过渡区间宽度
+ * @param discharge_width 放电过渡区间宽度
+ * @param charge_factor [输出] 充电降额系数(0~1)
+ * @param discharge_factor [输出] 放电降额系数(0~1)
+ */
+void SOC_DeratingFactors_Batch(size_t n,
+                               const float *soc,
+                               const float *soc_max,
+                               const float *soc_min,
+                               const float *charge_knee,
+                               const float *discharge_knee,
+                               float charge_width,
+                               float discharge_width,
+                               float *charge_factor,
+                               float *discharge_factor);
+
+/**
+ * @brief 编译降额曲线插值表
+ * @param curve [输出] 降额曲线
+ * @param shape 曲线形状 SOC_CurveShape
+ * @param charge_width 充电过渡区间宽度 (0, 1)
+ * @param discharge_width 放电过渡区间宽度 (0, 1)
+ * @param bp_x 自定义折点横坐标(归一化距离d)，须从0严格递增到1；其他形状传NULL
+ * @param bp_y 自定义折点纵坐标(降额系数)，取值[0,1]，首个为0、最后一个为1；其他形状传NULL
+ * @param bp_count 折点个数，2 ~ SOC_CURVE_MAX_BREAKPOINTS
+ * @return int 成功返回0，参数非法返回-1
+ */
+int SOC_DeratingCurve_Build(SOC_DeratingCurve *curve, int shape,
+                            float charge_width, float discharge_width,
+                            const float *bp_x, const float *bp_y, int bp_count);
+
+/**
+ * @brief 编译默认降额曲线：余弦形状，过渡宽度SOC_CURVE_DEFAULT_WIDTH
+ * @param curve [输出] 降额曲线
+ */
+void SOC_DeratingCurve_Default(SOC_DeratingCurve *curve);
+
+/**
+ * @brief 按曲线形状名称("cosine"/"linear"/"breakpoints")查找形状
+ * @param name 形状名称
+ * @return int 形状SOC_CurveShape，未知名称返回-1
+ */
+int SOC_DeratingCurve_ParseShape(const char *name);
+
+/**
+ * @brief 查表计算单个SOC的充放电降额系数
+ * @param curve 降额曲线
+ * @param soc 当前SOC
+ * @param soc_max SOC安全上限
+ * @param soc_min SOC安全下限
+ * @param charge_factor [输出] 充电降额系数
+ * @param discharge_factor [输出] 放电降额系数
+ */
+void SOC_DeratingCurve_Eval(const SOC_DeratingCurve *curve, float soc, float soc_max, float soc_min,
+                            float *charge_factor, float *discharge_factor);
+
+/**
+ * @brief 同SOC_DeratingCurve_Eval，平台区拐点由调用者预先算好(见CompiledConfig)
+ * @param curve 降额曲线
+ * @param soc 当前SOC
+ * @param soc_max SOC安全上限
+ * @param soc_min SOC安全下限
+ * @param charge_knee soc_max - curve->charge_width
+ * @param discharge_knee soc_min + curve->discharge_width
+ * @param charge_factor [输出] 充电降额系数
+ * @param discharge_factor [输出] 放电降额系数
+ */
+void SOC_DeratingCurve_EvalKnees(const SOC_DeratingCurve *curve, float soc, float soc_max, float soc_min,
+                                 float charge_knee, float discharge_knee,
+                                 float *charge_factor, float *discharge_factor);
+
+/**
+ * @brief 批量计算降额系数：余弦形状走SIMD多项式内核，其余形状逐个查表
+ * @param curve 降额曲线
+ * @param n 元素个数
+ * @param soc 当前SOC数组
+ * @param soc_max SOC安全上限数组
+ * @param soc_min SOC安全下限数组
+ * @param charge_knee 充电平台区拐点数组，soc_max - curve->charge_width(见CompiledConfig)
+ * @param discharge_knee 放电平台区拐点数组，soc_min + curve->discharge_width
+ * @param charge_factor [输出] 充电降额系数
+ * @param discharge_factor [输出] 放电降额系数
+ */
+void SOC_DeratingCurve_EvalBatch(const SOC_DeratingCurve *curve, size_t n,
+                                 const float *soc, const float *soc_max, const float *soc_min,
+                                 const float *charge_knee, const float *discharge_knee,
+                                 float *charge_factor, float *discharge_factor);
+
+/**
+ * @brief 精度自检：在两个过渡区内密集采样，比较SIMD内核与余弦插值表相对双精度余弦的最大绝对误差
+ * @param soc_max SOC安全上限
+ * @param soc_min SOC安全下限
+ * @param charge_width 充电过渡区间宽度
+ * @param discharge_width 放电过渡区间宽度
+ * @param simd_error [输出] SIMD内核的最大绝对误差
+ * @param table_error [输出] 插值表的最大绝对误差
+ * @return int 分别不超过SOC_DERATING_MAX_ERROR与SOC_CURVE_TABLE_MAX_ERROR返回0，否则返回-1
+ */
+int SOC_Derating_SelfCheck(float soc_max, float soc_min, float charge_width, float discharge_width,
+                           double *simd_error, double *table_error);
+
+/**
+ * @brief 当前编译启用的SIMD实现名称
+ * @return const char* "avx2"、"sse2"或"scalar"
+ */
+const char *SOC_DeratingFactors_Isa(void);
+
+#endif // VOLTAGE_CONTROL_SOC_LIMITS_H
@@ -0,0 +1,112 @@
+/*
+ * 文件：spsc_ring.h
+ * 功能：无锁单生产者/单消费者(SPSC)环形队列
+ *
+ * 功能描述：
+ * 1. 容量为2的幂，读写位置为单调递增的64位计数，下标通过掩码取得
+ * 2. 生产者只写head、消费者只写tail，两者分处不同缓存行，避免伪共享
+ * 3. 入队/出队均不加锁、不分配内存、不进入内核，可在实时控制线程中使用
+ */
+
+#ifndef VOLTAGE_CONTROL_SPSC_RING_H
+#define VOLTAGE_CONTROL_SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#define SPSC_CACHE_LINE 64
+
+/* ---------- SPSC环形队列 ---------- */
+template <typename T>
+struct SpscRing {
+    T *slots;                                           // 元素存储区
+    size_t mask;                                        // 容量 - 1
+    alignas(SPSC_CACHE_LINE) std::atomic<uint64_t> head; // 生产者写入计数
+    alignas(SPSC_CACHE_LINE) std::atomic<uint64_t> tail; // 消费者读取计数
+};
+
+/**
+ * @brief 初始化环形队列
+ * @param ring 环形队列
+ * @param capacity 容量，必须为2的幂
+ * @return int 成功返回0，失败返回-1
+ */
+template <typename T>
+int SpscRing_Init(SpscRing<T> *ring, size_t capacity) {
+    if (capacity < 2 || (capacity & (capacity - 1)) != 0) {
+        fprintf(stderr, "错误: 环形队列容量%zu不是2的幂\n", capacity);
+        return -1;
+    }
+    ring->slots = (T *)calloc(capacity, sizeof(T));
+    if (!ring->slots) {
+        fprintf(stderr, "错误: 内存分配失败\n");
+        return -1;
+    }
+    ring->mask = capacity - 1;
+    ring->head.store(0, std::memory_order_relaxed);
+    ring->tail.store(0, std::memory_order_relaxed);
+    return 0;
+}
+
+/**
+ * @brief 释放环形队列
+ * @param ring 环形队列
+ */
+template <typename T>
+void SpscRing_Free(SpscRing<T> *ring) {
+    free(ring->slots);
+    ring->slots = NULL;
+}
+
+/**
+ * @brief 生产者入队，队列满时不覆盖旧数据
+ * @param ring 环形队列
+ * @param item 待入队元素
+ * @return bool 成功返回true，队列已满返回false
+ */
+template <typename T>
+bool SpscRing_Push(SpscRing<T> *ring, const T *item) {
+    uint64_t head = ring->head.load(std::memory_order_relaxed);
+    uint64_t tail = ring->tail.load(std::memory_order_acquire);
+    if (head - tail > ring->mask) {
+        return false;
+    }
+    ring->slots[head & ring->mask] = *item;
+    ring->head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+/**
+ * @brief 消费者出队
+ * @param ring 环形队列
+ * @param item [输出] 出队元素
+ * @return bool 成功返回true，队列为空返回false
+ */
+template <typename T>
+bool SpscRing_Pop(SpscRing<T> *ring, T *item) {
+    uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+    uint64_t head = ring->head.load(std::memory_order_acquire);
+    if (tail == head) {
+        return false;
+    }
+    *item = ring->slots[tail & ring->mask];
+    ring->tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+/**
+ * @brief 当前队列中的元素个数(仅作统计参考，读取时可能已变化)
+ * @param ring 环形队列
+ * @return size_t 元素个数
+ */
+template <typename T>
+size_t SpscRing_Size(const SpscRing<T> *ring) {
+    uint64_t head = ring->head.load(std::memory_order_acquire);
+    uint64_t tail = ring->tail.load(std::memory_order_acquire);
+    return (size_t)(head - tail);
+}
+
+#endif // VOLTAGE_CONTROL_SPSC_RING_H
@@ -0,0 +1,210 @@
+/*
+ * 文件：telemetry_log.cpp
+ * 功能：异步二进制遥测日志实现
+ */
+
+#include "telemetry_log.h"
+#include "historian.h"
+
+#include <chrono>
+#include <cstring>
+
+#define TELEMETRY_BATCH 1024            // 后台线程每批处理的记录数
+#define TELEMETRY_TEXT_BUF (256 * 1024) // 文本格式化缓冲区大小
+
+static const char *TELEMETRY_SEPARATOR = "******************************************************\n";
+
+// 后台线程状态：格式化缓冲区与上一条记录所属周期
+typedef struct {
+    TelemetryRecord batch[TELEMETRY_BATCH];
+    char text[TELEMETRY_TEXT_BUF];
+    size_t text_len;
+    int has_cycle;
+    uint32_t last_cycle;
+} TelemetryWriter;
+
+static void Writer_FlushText(TelemetryLogger *logger, TelemetryWriter *w) {
+    if (w->text_len > 0) {
+        fwrite(w->text, 1, w->text_len, logger->out);
+        w->text_len = 0;
+    }
+}
+
+static void Writer_AppendText(TelemetryLogger *logger, TelemetryWriter *w, const char *str, size_t len) {
+    if (w->text_len + len > sizeof(w->text)) {
+        Writer_FlushText(logger, w);
+    }
+    memcpy(w->text + w->text_len, str, len);
+    w->text_len += len;
+}
+
+// 输出一批记录：文本方式在周期切换处插入分隔线，二进制方式整批写入，历史库方式逐条追加
+static void Writer_Emit(TelemetryLogger *logger, TelemetryWriter *w, size_t count) {
+    if (logger->sink == TELEMETRY_SINK_BINARY) {
+        fwrite(w->batch, sizeof(TelemetryRecord), count, logger->out);
+        return;
+    }
+    if (logger->sink == TELEMETRY_SINK_HISTORIAN) {
+        for (size_t i = 0; i < count; i++) {
+            HistorianWriter_Append(logger->historian, &w->batch[i]);
+        }
+        return;
+    }
+
+    char line[512];
+    for (size_t i = 0; i < count; i++) {
+        const TelemetryRecord *rec = &w->batch[i];
+        if (w->has_cycle && rec->cycle != w->last_cycle) {
+            Writer_AppendText(logger, w, TELEMETRY_SEPARATOR, strlen(TELEMETRY_SEPARATOR));
+        }
+        w->has_cycle = 1;
+        w->last_cycle = rec->cycle;
+
+        int len = TelemetryRecord_Format(rec, line, sizeof(line));
+        if (len > 0) {
+            Writer_AppendText(logger, w, line, (size_t)len < sizeof(line) ? (size_t)len : sizeof(line) - 1);
+        }
+    }
+    Writer_FlushText(logger, w);
+}
+
+static void TelemetryLogger_ThreadMain(TelemetryLogger *logger) {
+    TelemetryWriter *w = new TelemetryWriter;
+    w->text_len = 0;
+    w->has_cycle = 0;
+    w->last_cycle = 0;
+
+    for (;;) {
+        // 停止标志须在取数之前读取，保证停止前写入的记录全部输出
+        int running = logger->running.load(std::memory_order_acquire);
+
+        size_t count = 0;
+        while (count < TELEMETRY_BATCH && SpscRing_Pop(&logger->ring, &w->batch[count])) {
+            count++;
+        }
+
+        if (count > 0) {
+            Writer_Emit(logger, w, count);
+            logger->written.fetch_add(count, std::memory_order_relaxed);
+            if (count == TELEMETRY_BATCH) {
+                continue; // 队列中可能还有积压，立即处理下一批
+            }
+            fflush(logger->out);
+        }
+
+        if (!running) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(TELEMETRY_IDLE_SLEEP_MS));
+    }
+
+    if (logger->sink == TELEMETRY_SINK_TEXT && w->has_cycle) {
+        fputs(TELEMETRY_SEPARATOR, logger->out);
+    }
+    if (logger->sink == TELEMETRY_SINK_HISTORIAN) {
+        HistorianWriter_Finish(logger->historian); // 写出各台区未满的数据块
+    }
+    fflush(logger->out);
+    delete w;
+}
+
+static int TelemetryLogger_StartSink(TelemetryLogger *logger, size_t capacity, int sink, FILE *out,
+                                     HistorianWriter *historian) {
+    size_t ring_capacity = TELEMETRY_MIN_CAPACITY;
+    while (ring_capacity < capacity) {
+        ring_capacity <<= 1;
+    }
+    if (SpscRing_Init(&logger->ring, ring_capacity) != 0) {
+        return -1;
+    }
+
+    logger->out = out;
+    logger->sink = sink;
+    logger->historian = historian;
+    logger->dropped.store(0, std::memory_order_relaxed);
+    logger->written.store(0, std::memory_order_relaxed);
+
+    if (sink == TELEMETRY_SINK_BINARY) {
+        TelemetryFileHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, TELEMETRY_MAGIC, sizeof(header.magic));
+        header.record_size = sizeof(TelemetryRecord);
+        if (fwrite(&header, sizeof(header), 1, out) != 1) {
+            fprintf(stderr, "错误: 写入遥测日志文件头失败\n");
+            SpscRing_Free(&logger->ring);
+            return -1;
+        }
+    }
+
+    logger->running.store(1, std::memory_order_release);
+    logger->thread = std::thread(TelemetryLogger_ThreadMain, logger);
+    return 0;
+}
+
+int TelemetryLogger_Start(TelemetryLogger *logger, size_t capacity, int sink, FILE *out) {
+    if (sink == TELEMETRY_SINK_HISTORIAN) {
+        fprintf(stderr, "错误: 历史库方式须使用TelemetryLogger_StartHistorian启动\n");
+        return -1;
+    }
+    return TelemetryLogger_StartSink(logger, capacity, sink, out, NULL);
+}
+
+int TelemetryLogger_StartHistorian(TelemetryLogger *logger, size_t capacity, HistorianWriter *historian) {
+    return TelemetryLogger_StartSink(logger, capacity, TELEMETRY_SINK_HISTORIAN, historian->out, historian);
+}
+
+void TelemetryLogger_Stop(TelemetryLogger *logger) {
+    logger->running.store(0, std::memory_order_release);
+    if (logger->thread.joinable()) {
+        logger->thread.join();
+    }
+    SpscRing_Free(&logger->ring);
+}
+
+void TelemetryRecord_FromController(TelemetryRecord *record, const VoltageController *ctrl,
+                                    uint32_t cycle, int64_t timestamp_ns) {
+    record->timestamp_ns = timestamp_ns;
+    record->cycle = cycle;
+    record->area_id = ctrl->area_id;
+    record->V_meas = ctrl->status.V_meas;
+    record->SOC = ctrl->status.SOC;
+    record->P_meas = ctrl->status.P_meas;
+    record->P_soc_charge_limit = ctrl->status.P_soc_charge_limit;
+    record->P_soc_discharge_limit = ctrl->status.P_soc_discharge_limit;
+    record->P_cmd = ctrl->P_cmd;
+    record->Ctrl_Mode = ctrl->state.Ctrl_Mode;
+    record->reserved = 0;
+}
+
+void TelemetryRecord_FromFleet(TelemetryRecord *record, const VoltageFleet *fleet, size_t index,
+                               uint32_t cycle, int64_t timestamp_ns) {
+    record->timestamp_ns = timestamp_ns;
+    record->cycle = cycle;
+    record->area_id = (int32_t)index;
+    record->V_meas = fleet->V_meas[index];
+    record->SOC = fleet->SOC[index];
+    record->P_meas = fleet->P_meas[index];
+    record->P_soc_charge_limit = fleet->P_soc_charge_limit[index];
+    record->P_soc_discharge_limit = fleet->P_soc_discharge_limit[index];
+    record->P_cmd = fleet->P_cmd[index];
+    record->Ctrl_Mode = fleet->Ctrl_Mode[index];
+    record->reserved = 0;
+}
+
+int TelemetryRecord_Format(const TelemetryRecord *record, char *buf, size_t size) {
+    return snprintf(buf, size,
+                    "[台区%d] 模拟数据: V_meas=%.2fV, SOC=%.1f%%, P_meas=%.2fkW, P_soc_charge_limit=%.2fkW, P_soc_discharge_limit=%.2fkW\n"
+                    "[台区%d] 控制模式状态=%d,有功功率指令=%f\n",
+                    record->area_id, record->V_meas, record->SOC * 100, record->P_meas,
+                    record->P_soc_charge_limit, record->P_soc_discharge_limit,
+                    record->area_id, record->Ctrl_Mode, record->P_cmd);
+}
+
+void TelemetryLogger_PrintStats(const TelemetryLogger *logger, FILE *fp) {
+    fprintf(fp, "日志统计: 已输出记录=%llu, 队列满丢弃=%llu\n",
+            (unsigned long long)logger->written.load(std::memory_order_relaxed),
+            (unsigned long long)logger->dropped.load(std::memory_order_relaxed));
+    if (logger->historian) {
+        HistorianWriter_PrintStats(logger->historian, fp);
+    }
+}
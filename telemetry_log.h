@@ -0,0 +1,146 @@
+/*
+ * 文件：telemetry_log.h
+ * 功能：异步二进制遥测日志
+ *
+ * 功能描述：
+ * 1. 控制线程把定长二进制记录写入预分配的SPSC环形队列，
+ *    热路径上没有堆分配、没有格式化、没有系统调用
+ * 2. 后台线程成批取出记录，格式化为文本、原样写入二进制文件或写入列式历史库
+ * 3. 队列满时丢弃新记录并计数，日志输出永远不会拖慢控制周期
+ */
+
+#ifndef VOLTAGE_CONTROL_TELEMETRY_LOG_H
+#define VOLTAGE_CONTROL_TELEMETRY_LOG_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include "spsc_ring.h"
+#include "voltage_control.h"
+#include "fleet.h"
+
+#define TELEMETRY_MAGIC "VCTLOG1"           // 二进制日志文件头魔数(含结尾'\0'共8字节)
+#define TELEMETRY_MIN_CAPACITY (1u << 16)   // 记录队列最小容量
+#define TELEMETRY_IDLE_SLEEP_MS 10          // 队列为空时后台线程的休眠时间
+
+/* ---------- 遥测记录(48字节定长) ---------- */
+typedef struct {
+    int64_t timestamp_ns;           // 记录时刻 (单调时钟, ns)
+    uint32_t cycle;                 // 控制周期序号
+    int32_t area_id;                // 台区编号
+    float V_meas;                   // 电压测量值 (V)
+    float SOC;                      // SOC (0~1)
+    float P_meas;                   // PCS当前功率 (kW)
+    float P_soc_charge_limit;       // SOC充电功率限值 (kW)
+    float P_soc_discharge_limit;    // SOC放电功率限值 (kW)
+    float P_cmd;                    // 有功功率指令 (kW)
+    int32_t Ctrl_Mode;              // 控制模式
+    uint32_t reserved;              // 保留，补齐到8字节对齐
+} TelemetryRecord;
+
+/* ---------- 二进制日志文件头 ---------- */
+typedef struct {
+    char magic[8];                  // TELEMETRY_MAGIC
+    uint32_t record_size;           // sizeof(TelemetryRecord)
+    uint32_t reserved;
+} TelemetryFileHeader;
+
+/* ---------- 日志输出方式 ---------- */
+typedef enum {
+    TELEMETRY_SINK_TEXT = 0,        // 格式化为文本
+    TELEMETRY_SINK_BINARY = 1,      // 原样写入二进制记录
+    TELEMETRY_SINK_HISTORIAN = 2    // 写入列式历史库(见historian.h)
+} TelemetrySink;
+
+struct HistorianWriter;
+
+/* ---------- 异步日志器 ---------- */
+struct TelemetryLogger {
+    SpscRing<TelemetryRecord> ring;     // 控制线程 -> 日志线程
+    FILE *out;                          // 输出流
+    int sink;                           // 输出方式 TelemetrySink
+    HistorianWriter *historian;         // 历史库写入器(调用者所有)，仅TELEMETRY_SINK_HISTORIAN时使用
+    std::atomic<int> running;           // 日志线程运行标志
+    std::atomic<uint64_t> dropped;      // 队列满被丢弃的记录数 (控制线程写)
+    std::atomic<uint64_t> written;      // 已输出的记录数 (日志线程写)
+    std::thread thread;
+};
+
+/**
+ * @brief 启动日志线程
+ * @param logger 日志器
+ * @param capacity 记录队列容量，向上取整到2的幂且不小于TELEMETRY_MIN_CAPACITY
+ * @param sink 输出方式 TelemetrySink，历史库方式须使用TelemetryLogger_StartHistorian
+ * @param out 输出流，二进制方式须以"wb"打开；由调用者负责关闭
+ * @return int 成功返回0，失败返回-1
+ */
+int TelemetryLogger_Start(TelemetryLogger *logger, size_t capacity, int sink, FILE *out);
+
+/**
+ * @brief 启动日志线程，记录写入列式历史库
+ *
+ * 日志线程运行期间独占historian，停止时写出各台区未满的数据块(HistorianWriter_Finish)，
+ * 之后historian中的写入统计仍然可用。
+ * @param logger 日志器
+ * @param capacity 记录队列容量，规则同TelemetryLogger_Start
+ * @param historian 已初始化的历史库写入器，由调用者所有并负责关闭其输出流
+ * @return int 成功返回0，失败返回-1
+ */
+int TelemetryLogger_StartHistorian(TelemetryLogger *logger, size_t capacity, HistorianWriter *historian);
+
+/**
+ * @brief 停止日志线程，输出队列中剩余的全部记录后返回
+ * @param logger 日志器
+ */
+void TelemetryLogger_Stop(TelemetryLogger *logger);
+
+/**
+ * @brief 控制线程写入一条记录(无锁、无分配、无系统调用)
+ * @param logger 日志器
+ * @param record 记录
+ */
+inline void TelemetryLogger_Log(TelemetryLogger *logger, const TelemetryRecord *record) {
+    if (!SpscRing_Push(&logger->ring, record)) {
+        logger->dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief 由控制器上下文填充一条遥测记录
+ * @param record [输出] 记录
+ * @param ctrl 控制器上下文
+ * @param cycle 控制周期序号
+ * @param timestamp_ns 记录时刻
+ */
+void TelemetryRecord_FromController(TelemetryRecord *record, const VoltageController *ctrl,
+                                    uint32_t cycle, int64_t timestamp_ns);
+
+/**
+ * @brief 由批量引擎中第index个台区填充一条遥测记录
+ * @param record [输出] 记录
+ * @param fleet 批量引擎
+ * @param index 台区下标(同时作为台区编号)
+ * @param cycle 控制周期序号
+ * @param timestamp_ns 记录时刻
+ */
+void TelemetryRecord_FromFleet(TelemetryRecord *record, const VoltageFleet *fleet, size_t index,
+                               uint32_t cycle, int64_t timestamp_ns);
+
+/**
+ * @brief 把一条记录格式化为与原控制台输出相同的两行文本
+ * @param record 记录
+ * @param buf 输出缓冲区
+ * @param size 缓冲区大小
+ * @return int 写入的字符数(不含结尾'\0')，与snprintf语义相同
+ */
+int TelemetryRecord_Format(const TelemetryRecord *record, char *buf, size_t size);
+
+/**
+ * @brief 输出日志统计信息
+ * @param logger 日志器
+ * @param fp 输出流
+ */
+void TelemetryLogger_PrintStats(const TelemetryLogger *logger, FILE *fp);
+
+#endif // VOLTAGE_CONTROL_TELEMETRY_LOG_H
@@ -0,0 +1,249 @@
+/*
+ * 文件：trace_replay.cpp
+ * 功能：现场录波数据的内存映射回放与CSV转换实现
+ */
+
+#include "trace_replay.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#define TRACE_IO_BUFFER_SIZE (1 << 20)  // CSV转换时输入/输出缓冲区大小
+
+// 映射整个文件，成功后trace->header指向映射区起始
+static int TraceFile_Map(TraceFile *trace, const char *filename) {
+    trace->header = NULL;
+    trace->samples = NULL;
+    if (MappedFile_Open(&trace->file, filename) != 0) {
+        return -1;
+    }
+    if (trace->file.size < sizeof(TraceFileHeader)) {
+        fprintf(stderr, "错误: 轨迹文件 %s 长度不足\n", filename);
+        MappedFile_Close(&trace->file);
+        return -1;
+    }
+    // 顺序回放：让内核加大预读并及早回收已读过的页
+    MappedFile_AdviseSequential(&trace->file);
+    trace->header = (const TraceFileHeader *)trace->file.data;
+    trace->samples = (const TraceSample *)(trace->file.data + sizeof(TraceFileHeader));
+    return 0;
+}
+
+int TraceFile_Open(TraceFile *trace, const char *filename) {
+    if (TraceFile_Map(trace, filename) != 0) {
+        return -1;
+    }
+
+    const TraceFileHeader *header = trace->header;
+    if (memcmp(header->magic, TRACE_FILE_MAGIC, sizeof(header->magic)) != 0
+        || header->version != TRACE_FILE_VERSION) {
+        fprintf(stderr, "错误: %s 不是版本%d的轨迹文件\n", filename, TRACE_FILE_VERSION);
+        TraceFile_Close(trace);
+        return -1;
+    }
+    if (header->area_count == 0 || header->sample_count == 0 || !(header->step_s > 0.0)
+        || !std::isfinite(header->step_s)) {
+        fprintf(stderr, "错误: 轨迹文件 %s 文件头非法 (台区数=%u, 采样数=%llu, 采样间隔=%g)\n", filename,
+                header->area_count, (unsigned long long)header->sample_count, header->step_s);
+        TraceFile_Close(trace);
+        return -1;
+    }
+
+    // 样本区长度必须与文件头一致，先按除法检查避免乘法溢出
+    uint64_t payload = (uint64_t)trace->file.size - sizeof(TraceFileHeader);
+    uint64_t per_sample = (uint64_t)header->area_count * sizeof(TraceSample);
+    if (header->sample_count > payload / per_sample || header->sample_count * per_sample != payload) {
+        fprintf(stderr, "错误: 轨迹文件 %s 长度(%zu字节)与文件头不符，可能被截断\n", filename, trace->file.size);
+        TraceFile_Close(trace);
+        return -1;
+    }
+    return 0;
+}
+
+void TraceFile_Close(TraceFile *trace) {
+    MappedFile_Close(&trace->file);
+    trace->header = NULL;
+    trace->samples = NULL;
+}
+
+void TraceFile_Print(const TraceFile *trace, FILE *fp) {
+    const TraceFileHeader *header = trace->header;
+    fprintf(fp, "轨迹文件: 台区数=%u, 采样数=%llu, 采样间隔=%gs, 时长=%.1fh, 起始时间戳=%.3f, 大小=%.1fMB\n",
+            header->area_count, (unsigned long long)header->sample_count, header->step_s,
+            (double)header->sample_count * header->step_s / 3600.0, header->start_time_s,
+            (double)trace->file.size / (1024.0 * 1024.0));
+}
+
+int TraceReplay_Attach(SimulationState *sim, const TraceFile *trace, uint32_t area) {
+    if (area >= trace->header->area_count) {
+        fprintf(stderr, "错误: 轨迹文件只有%u个台区，无法回放第%u个\n", trace->header->area_count, area);
+        return -1;
+    }
+    sim->trace = trace;
+    sim->trace_area = area;
+    sim->trace_pos = 0;
+    return 0;
+}
+
+// 解析一行 time_s,area,V_meas,SOC,P_meas，格式错误返回-1
+static int Trace_ParseCsvLine(const char *line, double *time_s, unsigned long *area, TraceSample *sample) {
+    char *end;
+    double values[3];
+
+    *time_s = strtod(line, &end);
+    if (end == line || *end != ',') {
+        return -1;
+    }
+    const char *p = end + 1;
+    *area = strtoul(p, &end, 10);
+    if (end == p || *end != ',') {
+        return -1;
+    }
+    for (int i = 0; i < 3; i++) {
+        p = end + 1;
+        values[i] = strtod(p, &end);
+        if (end == p || (i < 2 && *end != ',')) {
+            return -1;
+        }
+    }
+    while (*end == ' ' || *end == '\t' || *end == '\r' || *end == '\n') {
+        end++;
+    }
+    if (*end != '\0') {
+        return -1;
+    }
+    sample->V_meas = (float)values[0];
+    sample->SOC = (float)values[1];
+    sample->P_meas = (float)values[2];
+    return 0;
+}
+
+// 检查上一个采样时刻的台区是否齐全，必要时确定台区数
+static int Trace_FinishGroup(uint32_t *areas, uint32_t group_areas, uint64_t *samples, long long line_num) {
+    if (*areas == 0) {
+        *areas = group_areas;
+    } else if (group_areas != *areas) {
+        fprintf(stderr, "错误: CSV第%lld行之前的采样时刻只有%u个台区，应为%u个\n", line_num, group_areas, *areas);
+        return -1;
+    }
+    (*samples)++;
+    return 0;
+}
+
+int TraceFile_ConvertCsv(const char *csv_filename, const char *trace_filename) {
+    FILE *in = fopen(csv_filename, "r");
+    if (!in) {
+        fprintf(stderr, "错误: 无法打开CSV文件 %s\n", csv_filename);
+        return -1;
+    }
+    FILE *out = fopen(trace_filename, "wb");
+    if (!out) {
+        fprintf(stderr, "错误: 无法创建轨迹文件 %s\n", trace_filename);
+        fclose(in);
+        return -1;
+    }
+    setvbuf(in, NULL, _IOFBF, TRACE_IO_BUFFER_SIZE);
+    setvbuf(out, NULL, _IOFBF, TRACE_IO_BUFFER_SIZE);
+
+    // 先写占位文件头，样本数与采样间隔在全部样本写完后回填
+    TraceFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TRACE_FILE_MAGIC, sizeof(header.magic));
+    header.version = TRACE_FILE_VERSION;
+    fwrite(&header, sizeof(header), 1, out);
+
+    char line[512];
+    long long line_num = 0;
+    int data_seen = 0;
+    uint32_t areas = 0;             // 台区数，第一个采样时刻结束后确定
+    uint32_t group_areas = 0;       // 当前采样时刻已读到的台区数
+    uint64_t samples = 0;           // 已完成的采样时刻数
+    double group_time = 0.0;
+    int ret = 0;
+
+    while (ret == 0 && fgets(line, sizeof(line), in)) {
+        line_num++;
+        if (line[0] == '\n' || line[0] == '\r' || line[0] == '#') {
+            continue;
+        }
+
+        double time_s;
+        unsigned long area;
+        TraceSample sample;
+        if (Trace_ParseCsvLine(line, &time_s, &area, &sample) != 0) {
+            if (!data_seen) {
+                continue; // 表头
+            }
+            fprintf(stderr, "错误: CSV第%lld行格式错误，应为 time_s,area,V_meas,SOC,P_meas\n", line_num);
+            ret = -1;
+            break;
+        }
+
+        if (area == 0) {
+            // 新的采样时刻
+            if (data_seen && Trace_FinishGroup(&areas, group_areas, &samples, line_num) != 0) {
+                ret = -1;
+                break;
+            }
+            if (samples == 0) {
+                header.start_time_s = time_s;
+            } else if (samples == 1) {
+                header.step_s = time_s - header.start_time_s;
+                if (!(header.step_s > 0.0)) {
+                    fprintf(stderr, "错误: CSV第%lld行时间戳未递增\n", line_num);
+                    ret = -1;
+                    break;
+                }
+            } else {
+                double expected = header.start_time_s + (double)samples * header.step_s;
+                if (fabs(time_s - expected) > 0.01 * header.step_s) {
+                    fprintf(stderr, "错误: CSV第%lld行时间戳%.3f与采样间隔不符(应为%.3f)，录波中有缺失或重复\n",
+                            line_num, time_s, expected);
+                    ret = -1;
+                    break;
+                }
+            }
+            group_time = time_s;
+            group_areas = 0;
+            data_seen = 1;
+        } else if (!data_seen || area != group_areas || (areas != 0 && area >= areas) || time_s != group_time) {
+            fprintf(stderr, "错误: CSV第%lld行应为时刻%.3f的第%u个台区\n", line_num, group_time, group_areas);
+            ret = -1;
+            break;
+        }
+
+        fwrite(&sample, sizeof(sample), 1, out);
+        group_areas++;
+    }
+
+    if (ret == 0 && data_seen) {
+        ret = Trace_FinishGroup(&areas, group_areas, &samples, line_num + 1);
+    }
+    if (ret == 0 && samples < 2) {
+        fprintf(stderr, "错误: CSV文件 %s 至少需要两个采样时刻\n", csv_filename);
+        ret = -1;
+    }
+    if (ret == 0 && ferror(in)) {
+        fprintf(stderr, "错误: 读取CSV文件 %s 失败\n", csv_filename);
+        ret = -1;
+    }
+    if (ret == 0) {
+        header.area_count = areas;
+        header.sample_count = samples;
+        if (fseek(out, 0, SEEK_SET) != 0 || fwrite(&header, sizeof(header), 1, out) != 1) {
+            ret = -1;
+        }
+    }
+    fclose(in);
+    if (ferror(out)) {
+        ret = -1;
+    }
+    if (fclose(out) != 0 || ret != 0) {
+        fprintf(stderr, "错误: 生成轨迹文件 %s 失败\n", trace_filename);
+        remove(trace_filename);
+        return -1;
+    }
+    printf("已转换: %u个台区 x %llu个采样时刻, 采样间隔=%gs\n", areas, (unsigned long long)samples, header.step_s);
+    return 0;
+}
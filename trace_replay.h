@@ -0,0 +1,116 @@
+/*
+ * 文件：trace_replay.h
+ * 功能：现场录波数据(电表/BMS/PCS)的内存映射回放
+ *
+ * 功能描述：
+ * 1. 二进制轨迹文件由64字节文件头和按时间顺序排列的样本组成，
+ *    每个采样时刻依次存放全部台区的(V_meas, SOC, P_meas)，小端序
+ * 2. 回放时整个文件以只读方式映射到内存，按页由操作系统换入换出，
+ *    数GB、长达一年的轨迹也不占用堆内存，取样本只是一次内存读取
+ * 3. 台区数据源挂接轨迹后，Simulate_RealTimeData改为逐周期读取录波样本，
+ *    逐台区控制器、批量引擎、采集线程与超实时仿真无需任何修改即可回放
+ * 4. CSV录波只需转换一次：按行流式读取、流式写出，不在内存中保存整条轨迹
+ */
+
+#ifndef VOLTAGE_CONTROL_TRACE_REPLAY_H
+#define VOLTAGE_CONTROL_TRACE_REPLAY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include "mapped_file.h"
+#include "voltage_control.h"
+
+#define TRACE_FILE_MAGIC "VCTRACE1"
+#define TRACE_FILE_VERSION 1
+
+/* ---------- 轨迹文件头(64字节) ---------- */
+typedef struct {
+    char magic[8];              // TRACE_FILE_MAGIC，不含结尾'\0'
+    uint32_t version;           // TRACE_FILE_VERSION
+    uint32_t area_count;        // 台区(通道)数量
+    uint64_t sample_count;      // 每个台区的采样时刻数
+    double step_s;              // 采样间隔 (s)
+    double start_time_s;        // 第一个采样时刻(录波中的原始时间戳, s)
+    uint8_t reserved[24];       // 保留，写0
+} TraceFileHeader;
+
+/* ---------- 单个台区一个采样时刻的样本(12字节) ---------- */
+typedef struct {
+    float V_meas;               // 电压 (V)
+    float SOC;                  // SOC
+    float P_meas;               // PCS功率 (kW)，正为充电
+} TraceSample;
+
+static_assert(sizeof(TraceFileHeader) == 64, "TraceFileHeader必须为64字节");
+static_assert(sizeof(TraceSample) == 12, "TraceSample必须为12字节");
+
+/* ---------- 已映射的轨迹文件 ---------- */
+struct TraceFile {
+    const TraceFileHeader *header;  // 文件头(指向映射区起始)
+    const TraceSample *samples;     // 样本区，下标为 采样时刻 * area_count + 台区
+    MappedFile file;                // 只读映射的整个文件
+};
+
+/**
+ * @brief 以只读方式映射轨迹文件并校验文件头与长度
+ * @param trace 轨迹文件
+ * @param filename 文件名
+ * @return int 成功返回0，失败返回-1
+ */
+int TraceFile_Open(TraceFile *trace, const char *filename);
+
+/**
+ * @brief 解除映射并关闭文件
+ * @param trace 轨迹文件
+ */
+void TraceFile_Close(TraceFile *trace);
+
+/**
+ * @brief 输出轨迹文件概要
+ * @param trace 轨迹文件
+ * @param fp 输出流
+ */
+void TraceFile_Print(const TraceFile *trace, FILE *fp);
+
+/**
+ * @brief 把CSV录波转换为二进制轨迹文件
+ *
+ * 每行为 time_s,area,V_meas,SOC,P_meas；行按时间排序，同一时刻内台区编号依次为0~N-1。
+ * 台区数由第一个采样时刻确定，采样间隔由前两个采样时刻确定，之后的时间戳必须与之一致
+ * (允许1%抖动)。空行、'#'开头的行和首行表头被跳过。
+ * @param csv_filename CSV文件名
+ * @param trace_filename 输出的轨迹文件名
+ * @return int 成功返回0，格式错误或读写失败返回-1
+ */
+int TraceFile_ConvertCsv(const char *csv_filename, const char *trace_filename);
+
+/**
+ * @brief 把台区数据源挂接到轨迹文件的指定通道，从第一个样本开始回放
+ *
+ * 轨迹文件必须在回放期间保持打开；回放到末尾后从头循环。
+ * @param sim 数据源状态
+ * @param trace 轨迹文件
+ * @param area 通道编号，必须小于area_count
+ * @return int 成功返回0，通道不存在返回-1
+ */
+int TraceReplay_Attach(SimulationState *sim, const TraceFile *trace, uint32_t area);
+
+/**
+ * @brief 读取挂接通道的下一个样本(由Simulate_RealTimeData调用)
+ * @param sim 已挂接轨迹的数据源状态
+ * @param status [输出] 电压、SOC、功率测量值
+ */
+inline void TraceReplay_Next(SimulationState *sim, SystemStatus_RealTime *status) {
+    const TraceFile *trace = sim->trace;
+    if (sim->trace_pos >= trace->header->sample_count) {
+        sim->trace_pos = 0;
+    }
+    const TraceSample *sample = &trace->samples[sim->trace_pos * trace->header->area_count + sim->trace_area];
+    sim->trace_pos++;
+    status->V_meas = sample->V_meas;
+    status->SOC = sample->SOC;
+    status->P_meas = sample->P_meas;
+}
+
+#endif // VOLTAGE_CONTROL_TRACE_REPLAY_H
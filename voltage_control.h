@@ -0,0 +1,301 @@
+/*
+ * 文件：voltage_control.h
+ * 功能：台区储能系统双向PI电压调节控制器 —— 数据类型与控制器接口
+ *
+ * 功能描述：
+ * 1. 定义系统配置、实时状态、控制器内部状态等数据结构
+ * 2. 控制器上下文VoltageController独立持有配置、状态与模拟数据源，
+ *    各函数不再依赖全局变量，同一进程内可同时驱动多个台区
+ */
+
+#ifndef VOLTAGE_CONTROL_H
+#define VOLTAGE_CONTROL_H
+
+#include <cstddef>
+#include <cstdio>
+#include "soc_limits.h"
+#include "prng.h"
+#include "battery_model.h"
+
+#define SIMULATION_DEFAULT_SEED 20250919ULL    // 未指定种子时模拟数据源使用的种子
+
+struct TraceFile;   // 录波轨迹文件，见trace_replay.h
+struct GridModel;   // 电网电压模型，见grid_model.h
+
+/* ---------- 系统配置参数(从json文件读取) ---------- */
+typedef struct {
+    // 电压相关参数
+    float V_ref_upper;      // 电压上限设定值，如241.0
+    float V_ref_lower;      // 电压下限设定值，如198.0
+    float Deadband_upper;   // 上限控制死区，如2.0
+    float Deadband_lower;   // 下限控制死区，如2.0
+    float V_enter_lower;    // 电压进入门槛，如160.0
+
+    // PI控制器参数
+    float Kp_upper;         // 过压控制比例系数
+    float Ki_upper;         // 过压控制积分系数
+    float Kp_lower;         // 欠压控制比例系数
+    float Ki_lower;         // 欠压控制积分系数
+
+    // 功率限制参数
+    float P_step_max;       // 功率需求最大步长，如10.0 (kW)
+    float P_charge_max;     // PCS最大充电功率，如125.0 (kW)
+    float P_discharge_max;  // PCS最大放电功率，如125.0 (kW)
+    float SOC_max;          // SOC安全上限，如0.95 (95%)
+    float SOC_min;          // SOC安全下限，如0.15 (15%)
+} SystemConfig_Cfg;
+
+
+/* ---------- 编译后的配置(控制热路径只读取此形式) ---------- */
+// 加载配置时由CompiledConfig_Build一次算好，之后只读；模式判断、PI计算与SOC限值
+// 不再重复计算死区边界与平台区拐点。过渡宽度的倒数已在降额曲线中(charge_scale/discharge_scale)
+typedef struct {
+    // 模式判断
+    float V_upper_edge;         // 过压动作边界 V_ref_upper + Deadband_upper
+    float V_lower_edge;         // 欠压动作边界 V_ref_lower - Deadband_lower
+    float V_enter_lower;        // 电压进入门槛
+
+    // PI控制器
+    float Kp_upper;
+    float Ki_upper;
+    float Kp_lower;
+    float Ki_lower;
+    float P_step_max;
+
+    // 功率限制：SOC功率限值在计算时即与PCS额定功率取小(合成限值)，PI计算只需与合成限值比较
+    float P_charge_max;
+    float P_discharge_max;
+    float SOC_max;
+    float SOC_min;
+    float SOC_charge_knee;      // SOC_max - 充电过渡宽度，SOC不高于此值时充电不降额
+    float SOC_discharge_knee;   // SOC_min + 放电过渡宽度，SOC不低于此值时放电不降额
+
+    SystemConfig_Cfg params;    // 编译前的原始参数，供显示、统计与热加载比较使用
+} CompiledConfig;
+
+
+/* ---------- 系统实时状态 ---------- */
+typedef struct {
+    float V_meas;           // 实时电压测量值 (来自智能电表)
+    float SOC;              // 储能当前SOC (来自BMS)
+    float P_meas;           // PCS当前功率 (来自PCS) 正为充电，负为放电
+    float P_soc_charge_limit;   // SOC计算出的当前最大允许充电功率 (基于SOC)
+    float P_soc_discharge_limit;// SOC计算出的当前最大允许放电功率 (基于SOC)
+} SystemStatus_RealTime;
+
+
+/* ---------- 控制器内部状态 ---------- */
+typedef struct {
+    int Ctrl_Mode;          // 控制模式状态: 0-正常, 1-过压, 2-欠压
+    float integral_upper;   // 过压PI控制器的积分项累积值
+    float integral_lower;   // 欠压PI控制器的积分项累积值
+} ControllerState;
+
+
+/* ---------- 模拟数据源状态 ---------- */
+typedef struct {
+    int simulation_step;    // 模拟步数
+    float simulated_soc;    // 模拟SOC
+    float step_s;           // 每步对应的模拟时长 (s)，默认1
+    Prng rng;               // 本实例独立的随机流，结果只取决于种子与流编号
+
+    // 场景参数，Simulation_Init设为默认值，可在初始化后修改
+    float V_base;           // 电压基准 (V)，默认220
+    float V_amplitude;      // 电压正弦波动幅值 (V)，默认30
+    float V_period_s;       // 电压波动周期 (s)，默认30
+    float perturbation_scale; // SOC随机扰动幅度倍数，默认1(每步扰动范围±0.05*sqrt(step_s))
+
+    // 录波回放，由TraceReplay_Attach设置；trace非NULL时不再生成模拟数据
+    const TraceFile *trace; // 回放的轨迹文件，默认NULL
+    uint32_t trace_area;    // 回放的通道编号
+    uint64_t trace_pos;     // 下一个样本的采样时刻下标
+
+    // 电池模型，由Simulation_EnableBattery启用；启用后SOC由PCS实际功率积分得到，
+    // 不再按电压阈值模拟，P_meas为PCS实际功率
+    int battery_enabled;    // 是否启用电池模型，默认0
+    BatteryModel battery;   // 电池模型系数
+    double battery_soc;     // 电池模型的SOC状态(双精度积分)，simulated_soc为其单精度副本
+    float P_actual;         // PCS实际功率 (kW)；未启用电池模型时为上一周期的功率指令
+
+    // 电网模型，由GridModel_Attach挂接；挂接后电压取自电网模型的求解结果
+    const GridModel *grid;  // 电网模型，NULL表示使用正弦电压曲线
+    uint32_t grid_node;     // 对应电网模型中的台区下标
+} SimulationState;
+
+
+/* ---------- 台区控制器上下文 ---------- */
+typedef struct {
+    int area_id;                    // 台区编号
+    CompiledConfig cfg;             // 本台区编译后的配置
+    SOC_DeratingCurve curve;        // 本台区预编译的SOC降额曲线
+    SystemStatus_RealTime status;   // 本台区实时状态
+    ControllerState state;          // 本台区控制器内部状态
+    SimulationState sim;            // 本台区模拟数据源状态
+    float P_cmd;                    // 最近一次输出的有功功率指令 (kW)
+    int has_measurement;            // 本周期是否有新鲜测量值，为0时不更新限值、模式与PI (样本过期时保持P_cmd，尚无样本时P_cmd为0)
+} VoltageController;
+
+
+/* ---------- 配置编译 ---------- */
+
+/**
+ * @brief 由配置参数与降额曲线编译出控制热路径使用的配置
+ * @param compiled [输出] 编译后的配置
+ * @param cfg 配置参数
+ * @param curve 降额曲线(取其过渡宽度)，传NULL时按默认余弦曲线计算
+ */
+void CompiledConfig_Build(CompiledConfig *compiled, const SystemConfig_Cfg *cfg, const SOC_DeratingCurve *curve);
+
+/* ---------- 控制算法 ---------- */
+
+// 模式判断函数
+int Determine_CtrlMode(float V_meas, const CompiledConfig *cfg);
+
+// 过压控制计算函数，status中的SOC功率限值须为合成限值(见Calculate_SOC_Power_Limits)
+float Calculate_OverVoltage_Control(const CompiledConfig *cfg,
+                                    const SystemStatus_RealTime *status,
+                                    ControllerState *state);
+
+// 欠压控制计算函数，status中的SOC功率限值须为合成限值(见Calculate_SOC_Power_Limits)
+float Calculate_UnderVoltage_Control(const CompiledConfig *cfg,
+                                     const SystemStatus_RealTime *status,
+                                     ControllerState *state);
+
+// 基于SOC的充放电功率限制，结果已与PCS额定功率取小
+void Calculate_SOC_Power_Limits(float soc, const CompiledConfig *cfg, const SOC_DeratingCurve *curve,
+                                float* charge_limit, float* discharge_limit);
+
+/* ---------- 模拟数据源 ---------- */
+
+/**
+ * @brief 初始化模拟数据源状态
+ *
+ * 同一(seed, stream)得到的模拟数据序列完全相同，与线程数及其他实例无关；
+ * 通常以台区编号作为stream，使各台区的随机扰动互不相关。
+ * @param sim 模拟数据源状态
+ * @param seed 随机种子
+ * @param stream 随机流编号
+ */
+void Simulation_Init(SimulationState *sim, uint64_t seed, uint64_t stream);
+
+/**
+ * @brief 启用电池模型，SOC从当前simulated_soc开始按功率指令积分
+ * @param sim 模拟数据源状态
+ * @param params 电池参数
+ * @return int 成功返回0，参数非法返回-1
+ */
+int Simulation_EnableBattery(SimulationState *sim, const BatteryParams *params);
+
+/**
+ * @brief 把本周期的功率指令作用到电池模型(未启用电池模型时视为PCS理想跟踪指令)
+ *
+ * 在控制计算之后调用，结果体现在下一次Simulate_RealTimeData的SOC与P_meas中。
+ * @param sim 模拟数据源状态
+ * @param P_cmd 有功功率指令 (kW)
+ */
+void Simulation_ApplyCommand(SimulationState *sim, float P_cmd);
+
+/**
+ * @brief 生成一步模拟实时数据；已挂接录波轨迹时改为读取下一个录波样本
+ * @param sim 模拟数据源状态
+ * @param status [输出] 电压、SOC、功率测量值
+ */
+void Simulate_RealTimeData(SimulationState *sim, SystemStatus_RealTime *status);
+
+/* ---------- 控制器上下文 ---------- */
+
+/**
+ * @brief 初始化控制器上下文
+ * @param ctrl 控制器上下文
+ * @param area_id 台区编号
+ * @param cfg 编译后的配置（复制到上下文中），须由同一条降额曲线编译得到
+ * @param curve SOC降额曲线（复制到上下文中），传NULL时使用默认余弦曲线
+ *
+ * 模拟数据源以SIMULATION_DEFAULT_SEED为种子、area_id为流编号初始化，
+ * 需要其他种子时随后调用Simulation_Init重新设定。
+ */
+void VoltageController_Init(VoltageController *ctrl, int area_id, const CompiledConfig *cfg,
+                            const SOC_DeratingCurve *curve);
+
+/**
+ * @brief 基于ctrl->status中已有的测量值执行一次控制计算
+ *
+ * 计算SOC功率限制、判断控制模式并执行PI计算，结果写入ctrl->P_cmd。
+ * @param ctrl 控制器上下文
+ * @return float 有功功率指令 (kW)
+ */
+float VoltageController_Compute(VoltageController *ctrl);
+
+/*
+ * 以下三个函数依次组成VoltageController_Compute，供需要分阶段计时的调用者使用；
+ * 必须按顺序调用，各台区之间互不依赖，可以按阶段对全部台区批量执行
+ */
+
+/**
+ * @brief 控制计算第1步：根据SOC计算充放电功率限值，写入ctrl->status
+ * @param ctrl 控制器上下文
+ */
+void VoltageController_UpdateLimits(VoltageController *ctrl);
+
+/**
+ * @brief 控制计算第2步：判断控制模式，写入ctrl->state.Ctrl_Mode
+ * @param ctrl 控制器上下文
+ */
+void VoltageController_UpdateMode(VoltageController *ctrl);
+
+/**
+ * @brief 控制计算第3步：按当前模式执行PI计算，写入ctrl->P_cmd
+ * @param ctrl 控制器上下文
+ * @return float 有功功率指令 (kW)
+ */
+float VoltageController_UpdateCommand(VoltageController *ctrl);
+
+/**
+ * @brief 执行一个完整控制周期：读取模拟实时数据后执行控制计算，并把指令作用到电池模型
+ * @param ctrl 控制器上下文
+ * @return float 有功功率指令 (kW)
+ */
+float VoltageController_Step(VoltageController *ctrl);
+
+/**
+ * @brief 依次对多个台区执行一个控制周期
+ * @param ctrls 控制器上下文数组
+ * @param count 台区数量
+ */
+void VoltageController_StepMany(VoltageController *ctrls, size_t count);
+
+/**
+ * @brief 输出控制器本周期的测量值与控制结果
+ * @param ctrl 控制器上下文
+ * @param fp 输出流
+ */
+void VoltageController_Print(const VoltageController *ctrl, FILE *fp);
+
+/* ---------- 配置加载 ---------- */
+
+/**
+ * @brief 从指定的配置文件中加载配置，扩展名为.csv时按CSV格式读取，否则按JSON读取
+ * @param filename 配置文件名（"config.json"）
+ * @param cfg [输出] 配置参数
+ * @param curve [输出] 由power_limits中的曲线参数编译出的SOC降额曲线(CSV配置使用默认曲线)，可传NULL
+ * @return int 成功返回0，失败返回-1
+ */
+int load_configuration(const char *filename, SystemConfig_Cfg *cfg, SOC_DeratingCurve *curve);
+
+/**
+ * @brief 读入整个文本文件(JSON配置、电网模型、结果文件等)
+ * @param filename 文件名
+ * @param description 错误信息中的文件类别，如"配置文件"
+ * @return char* 以'\0'结尾的文件内容(调用者free)，打开、定位或读取失败返回NULL(已输出错误信息)
+ */
+char *Read_TextFile(const char *filename, const char *description);
+
+/**
+ * @brief 从CSV文件中加载配置，每行一个"键,值"
+ * @param filename CSV文件名
+ * @param cfg [输出] 配置参数
+ * @return int 成功返回0，失败返回-1
+ */
+int load_configuration_from_csv(const char *filename, SystemConfig_Cfg *cfg);
+
+#endif // VOLTAGE_CONTROL_H